@@ -0,0 +1,42 @@
+#pragma once
+
+/**
+ * @file bench_config.hpp
+ * @brief Detection benchmark settings
+ *
+ * Detection itself uses the sentinel's config (app_config.hpp), so the
+ * benchmark measures exactly what a PIR wake runs.
+ */
+
+#include <cstdint>
+#include <cstddef>
+
+namespace config {
+
+namespace bench {
+    // Test frames on the SD card (<mount point>/<directory>/*.jpg); frames
+    // built into the image (benchmark/frames/*.jpg) are used when the
+    // card or the directory is missing
+    constexpr const char* SD_DIRECTORY = "bench";
+
+    // Golden results file next to the frames
+    constexpr const char* GOLDEN_FILE = "golden.txt";
+
+    // Untimed passes over the set (model load, cache warm-up)
+    constexpr int WARMUP_PASSES = 1;
+
+    // Timed passes over the set
+    constexpr int TIMED_PASSES = 20;
+
+    // Frames loaded at most (sorted by name)
+    constexpr size_t MAX_FRAMES = 32;
+
+    // Largest test frame read from SD (bytes)
+    constexpr size_t MAX_FRAME_BYTES = 512 * 1024;
+
+    // Best-box overlap that counts as agreeing with the golden box
+    constexpr float GOLDEN_MIN_IOU = 0.5f;
+
+} // namespace bench
+
+} // namespace config
@@ -0,0 +1,364 @@
+/**
+ * @file bench_main.cpp
+ * @brief Detection pipeline benchmark
+ *
+ * Runs every test frame through detection::Detector::detect() for
+ * config::bench::TIMED_PASSES passes and reports:
+ * - Per-stage latency (min / median / p99): JPEG decode, inference
+ *   (ESP-DL preprocess + model + postprocess), other (zone crops, box
+ *   mapping, cross-zone NMS) and the whole detect() call
+ * - Model load time and resident size
+ * - Peak internal-RAM and PSRAM use over the run
+ * - Agreement of each frame's result with its golden result
+ * - Zone mapping onto frames other than the 320x240 detection stream
+ *
+ * The closing "BENCH" line holds the same numbers on one line for
+ * comparing builds, targets and settings.
+ */
+
+#include "bench_config.hpp"
+#include "frame_set.hpp"
+#include "latency_stats.hpp"
+
+#include "app_config.hpp"
+#include "detector.hpp"
+#include "model_slots.hpp"
+#include "psram_arena.hpp"
+#include "hw_jpeg_decoder.hpp"
+#include "sdcard_driver.hpp"
+#include "stage_profiler.hpp"
+
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_app_desc.h"
+#include "esp_private/esp_clk.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static const char* TAG = "Bench";
+
+using diagnostics::Stage;
+using diagnostics::StageProfiler;
+
+namespace {
+
+/**
+ * @brief Stages reported by the benchmark
+ */
+enum BenchStage : size_t {
+    DECODE,
+    INFER,
+    OTHER,
+    TOTAL,
+    BENCH_STAGE_COUNT
+};
+
+const char* const BENCH_STAGE_NAMES[BENCH_STAGE_COUNT] = {"decode", "infer", "other", "total"};
+
+/**
+ * @brief Outcome of one frame across the timed passes
+ */
+struct FrameOutcome {
+    detection::DetectionResult first;   // Result of the first timed pass
+    bool stable;                        // Every pass returned the same boxes
+    bench::LatencyStats totalUs;
+
+    explicit FrameOutcome(size_t passes) : first{}, stable(true), totalUs(passes) {}
+};
+
+float boxIou(int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh) {
+    int x1 = std::max(ax, bx);
+    int y1 = std::max(ay, by);
+    int x2 = std::min(ax + aw, bx + bw);
+    int y2 = std::min(ay + ah, by + bh);
+    if (x2 <= x1 || y2 <= y1) {
+        return 0.0f;
+    }
+    float inter = static_cast<float>(x2 - x1) * static_cast<float>(y2 - y1);
+    float uni = static_cast<float>(aw) * ah + static_cast<float>(bw) * bh - inter;
+    return (uni > 0.0f) ? inter / uni : 0.0f;
+}
+
+bool sameResult(const detection::DetectionResult& a, const detection::DetectionResult& b) {
+    return a.count == b.count &&
+           (a.count == 0 || (a.x == b.x && a.y == b.y &&
+                             a.width == b.width && a.height == b.height));
+}
+
+bool agreesWithGolden(const detection::DetectionResult& result, const bench::GoldenResult& golden) {
+    if ((result.count > 0) != (golden.count > 0)) {
+        return false;
+    }
+    return golden.count == 0 ||
+           boxIou(result.x, result.y, result.width, result.height,
+                  golden.x, golden.y, golden.width, golden.height) >= config::bench::GOLDEN_MIN_IOU;
+}
+
+size_t usedKb(size_t before, size_t after) {
+    return (before > after) ? (before - after) / 1024 : 0;
+}
+
+void quietDetectionLogs() {
+    // Per-frame INFO lines would put UART time into every sample
+    static const char* const TAGS[] = {"Detector", "JpegDecoder", "HwJpegDecoder", "ModelSlots",
+                                       "detect", "dl"};
+    for (const char* tag : TAGS) {
+        esp_log_level_set(tag, ESP_LOG_WARN);
+    }
+}
+
+/**
+ * @brief Zone crop bounds on frames of other sizes than the zone reference
+ *
+ * Covers the alert-resolution fallback (SXGA) and full-size decodes
+ * (shift 0), where unscaled zone coordinates would cover only the
+ * top-left corner of the image.
+ */
+bool checkZoneMapping() {
+    struct Case {
+        config::detection::Zone zone;
+        int frameWidth;
+        int frameHeight;
+        int scaleShift;
+        detection::ZoneRect expected;
+    };
+    static const Case CASES[] = {
+        {{"full", 0, 0, 320, 240, 0.0f, false}, 1280, 1024, 2, {0, 0, 320, 256}},
+        {{"right", 160, 0, 160, 240, 0.0f, false}, 1280, 1024, 0, {640, 0, 1280, 1024}},
+        {{"corner", 160, 120, 160, 120, 0.0f, false}, 640, 480, 1, {160, 120, 320, 240}},
+        {{"inset", 40, 30, 100, 80, 0.0f, false}, 320, 240, 0, {40, 30, 140, 110}},
+        {{"edge", 300, 200, 100, 100, 0.0f, false}, 640, 480, 0, {600, 400, 640, 480}},
+    };
+    bool ok = true;
+    for (const Case& c : CASES) {
+        const detection::ZoneRect rect =
+            detection::mapZone(c.zone, c.frameWidth, c.frameHeight, c.scaleShift);
+        if (rect.x0 != c.expected.x0 || rect.y0 != c.expected.y0 ||
+            rect.x1 != c.expected.x1 || rect.y1 != c.expected.y1) {
+            ESP_LOGE(TAG, "Zone %s on %dx%d (1/%d): x [%d,%d) y [%d,%d), "
+                     "expected x [%d,%d) y [%d,%d)",
+                     c.zone.name, c.frameWidth, c.frameHeight, 1 << c.scaleShift,
+                     rect.x0, rect.x1, rect.y0, rect.y1,
+                     c.expected.x0, c.expected.x1, c.expected.y0, c.expected.y1);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Load the test frames: SD card first, then the app image
+ */
+void loadFrames(drivers::SdCardDriver& sdCard, bench::FrameSet& frames) {
+    if (sdCard.mount() == ESP_OK &&
+        frames.loadFromSd(sdCard.getMountPoint()) == ESP_OK) {
+        return;
+    }
+    frames.loadEmbedded();
+}
+
+} // namespace
+
+extern "C" void app_main(void) {
+    quietDetectionLogs();
+
+    const esp_app_desc_t* app = esp_app_get_description();
+    uint32_t buildId = 0;
+    std::memcpy(&buildId, app->app_elf_sha256, sizeof(buildId));
+
+    ESP_LOGI(TAG, "╔═══════════════════════════════════════════════════════════╗");
+    ESP_LOGI(TAG, "║  ESP32 Autonomous Sentinel - Detection Benchmark         ║");
+    ESP_LOGI(TAG, "╚═══════════════════════════════════════════════════════════╝");
+    ESP_LOGI(TAG, "Target %s, CPU %d MHz, build %08lx", CONFIG_IDF_TARGET,
+             esp_clk_cpu_freq() / 1000000, static_cast<unsigned long>(buildId));
+
+    detection::ModelSlots::refresh();
+
+    const bool zonesOk = checkZoneMapping();
+    ESP_LOGI(TAG, "Zone mapping: %s", zonesOk ? "ok" : "FAILED");
+
+    drivers::SdCardDriver sdCard;
+    bench::FrameSet frames;
+    loadFrames(sdCard, frames);
+    if (frames.size() == 0) {
+        ESP_LOGE(TAG, "No test frames: put JPEGs in %s/%s or benchmark/frames/",
+                 sdCard.getMountPoint(), config::bench::SD_DIRECTORY);
+        sdCard.shutdown();
+        return;
+    }
+    ESP_LOGI(TAG, "%u frame(s) from %s, model %s, %d warm-up + %d timed pass(es)",
+             static_cast<unsigned>(frames.size()), frames.source(),
+             detection::ModelSlots::activeLabel(),
+             config::bench::WARMUP_PASSES, config::bench::TIMED_PASSES);
+    ESP_LOGI(TAG, "JPEG decode: %s", detection::HwJpegDecoder::isSupported()
+             ? "hardware codec + PPA (software fallback)" : "software (esp_new_jpeg)");
+
+    // Peaks below are measured from here; the loaded frames are the baseline
+    heap_caps_monitor_local_minimum_free_size_start();
+    const size_t internalBefore = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    const size_t psramBefore = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+
+    // Arena, as in the firmware, ahead of the model
+    if (detection::PsramArena::reserve() != ESP_OK) {
+        ESP_LOGW(TAG, "No PSRAM arena; decode buffers come from the heap");
+    }
+
+    detection::Detector detector;
+    int64_t loadStart = esp_timer_get_time();
+    esp_err_t err = detector.loadModel();
+    uint32_t loadUs = static_cast<uint32_t>(esp_timer_get_time() - loadStart);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Model load failed: %s", esp_err_to_name(err));
+        heap_caps_monitor_local_minimum_free_size_stop();
+        sdCard.shutdown();
+        return;
+    }
+    const size_t modelInternalKb = usedKb(internalBefore,
+                                          heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    const size_t modelPsramKb = usedKb(psramBefore, heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+
+    const size_t passes = static_cast<size_t>(config::bench::TIMED_PASSES);
+    std::vector<FrameOutcome> outcomes;
+    outcomes.reserve(frames.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        outcomes.emplace_back(passes);
+    }
+    std::vector<bench::LatencyStats> stats;
+    for (size_t s = 0; s < BENCH_STAGE_COUNT; s++) {
+        stats.emplace_back(frames.size() * passes);
+    }
+
+    StageProfiler& profiler = StageProfiler::instance();
+    uint32_t sequence = 0;
+    for (int pass = -config::bench::WARMUP_PASSES; pass < config::bench::TIMED_PASSES; pass++) {
+        for (size_t i = 0; i < frames.size(); i++) {
+            camera_fb_t fb = frames.cameraFrame(i);
+            profiler.begin(++sequence, 0);
+            int64_t start = esp_timer_get_time();
+            detection::DetectionResult result = detector.detect(&fb);
+            uint32_t totalUs = static_cast<uint32_t>(esp_timer_get_time() - start);
+            if (pass < 0) {
+                continue;
+            }
+
+            const diagnostics::WakeRecord& record = profiler.current();
+            uint32_t decodeUs = record.stageUs[static_cast<size_t>(Stage::JPEG_DECODE)];
+            uint32_t inferUs = record.stageUs[static_cast<size_t>(Stage::INFERENCE)];
+            stats[DECODE].add(decodeUs);
+            stats[INFER].add(inferUs);
+            stats[OTHER].add((totalUs > decodeUs + inferUs) ? totalUs - decodeUs - inferUs : 0);
+            stats[TOTAL].add(totalUs);
+
+            FrameOutcome& outcome = outcomes[i];
+            outcome.totalUs.add(totalUs);
+            if (pass == 0) {
+                outcome.first = result;
+            } else if (!sameResult(outcome.first, result)) {
+                outcome.stable = false;
+            }
+        }
+        // Let the idle task run (task watchdog) between passes
+        vTaskDelay(1);
+    }
+
+    const size_t internalPeakKb = usedKb(internalBefore,
+                                         heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+    const size_t psramPeakKb = usedKb(psramBefore,
+                                      heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+    heap_caps_monitor_local_minimum_free_size_stop();
+
+    // ------------------------------------------------------------------------
+    // Per-frame results
+    // ------------------------------------------------------------------------
+    ESP_LOGI(TAG, "");
+    ESP_LOGI(TAG, "%-24s %9s %7s %5s %s", "frame", "size", "med ms", "boxes", "golden");
+    size_t goldenCount = 0;
+    size_t agreeCount = 0;
+    for (size_t i = 0; i < frames.size(); i++) {
+        const bench::BenchFrame& frame = frames.frame(i);
+        const FrameOutcome& outcome = outcomes[i];
+        const char* verdict = "-";
+        if (frame.hasGolden) {
+            goldenCount++;
+            bool agree = agreesWithGolden(outcome.first, frame.golden);
+            agreeCount += agree ? 1 : 0;
+            verdict = agree ? "agree" : "DIFFERS";
+        }
+        ESP_LOGI(TAG, "%-24s %4dx%-4d %7.1f %5u %s%s", frame.name, frame.width, frame.height,
+                 outcome.totalUs.percentile(50) / 1000.0f,
+                 static_cast<unsigned>(outcome.first.count), verdict,
+                 outcome.stable ? "" : " (unstable)");
+    }
+
+    // Golden lines for frames that have none yet (copy into golden.txt)
+    for (size_t i = 0; i < frames.size(); i++) {
+        const bench::BenchFrame& frame = frames.frame(i);
+        const detection::DetectionResult& first = outcomes[i].first;
+        if (frame.hasGolden) {
+            continue;
+        }
+        if (first.count > 0) {
+            std::printf("golden: %s %u %d %d %d %d\n", frame.name,
+                        static_cast<unsigned>(first.count),
+                        first.x, first.y, first.width, first.height);
+        } else {
+            std::printf("golden: %s 0\n", frame.name);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Summary
+    // ------------------------------------------------------------------------
+    ESP_LOGI(TAG, "");
+    ESP_LOGI(TAG, "%-8s %9s %9s %9s   (ms, %u samples)", "stage", "min", "median", "p99",
+             static_cast<unsigned>(stats[TOTAL].count()));
+    for (size_t s = 0; s < BENCH_STAGE_COUNT; s++) {
+        ESP_LOGI(TAG, "%-8s %9.2f %9.2f %9.2f", BENCH_STAGE_NAMES[s],
+                 stats[s].min() / 1000.0f, stats[s].percentile(50) / 1000.0f,
+                 stats[s].percentile(99) / 1000.0f);
+    }
+    ESP_LOGI(TAG, "Model load %.1f ms, resident %u KB internal + %u KB PSRAM",
+             loadUs / 1000.0f, static_cast<unsigned>(modelInternalKb),
+             static_cast<unsigned>(modelPsramKb));
+    ESP_LOGI(TAG, "Peak use %u KB internal, %u KB PSRAM (model and %u KB arena included)",
+             static_cast<unsigned>(internalPeakKb), static_cast<unsigned>(psramPeakKb),
+             static_cast<unsigned>(detection::PsramArena::totalSize() / 1024));
+    if (detection::PsramArena::fallbackCount() > 0) {
+        ESP_LOGW(TAG, "%lu buffer(s) fell back to the heap: frames larger than config::arena",
+                 static_cast<unsigned long>(detection::PsramArena::fallbackCount()));
+    }
+    ESP_LOGI(TAG, "Golden agreement %u/%u (%u frame(s) without golden)",
+             static_cast<unsigned>(agreeCount), static_cast<unsigned>(goldenCount),
+             static_cast<unsigned>(frames.size() - goldenCount));
+
+    char line[256];
+    int len = std::snprintf(line, sizeof(line), "BENCH target=%s build=%08lx frames=%u passes=%u",
+                            CONFIG_IDF_TARGET, static_cast<unsigned long>(buildId),
+                            static_cast<unsigned>(frames.size()),
+                            static_cast<unsigned>(passes));
+    for (size_t s = 0; s < BENCH_STAGE_COUNT && len > 0 &&
+                       static_cast<size_t>(len) < sizeof(line); s++) {
+        len += std::snprintf(line + len, sizeof(line) - len, " %s=%lu/%lu/%lu",
+                             BENCH_STAGE_NAMES[s],
+                             static_cast<unsigned long>(stats[s].min()),
+                             static_cast<unsigned long>(stats[s].percentile(50)),
+                             static_cast<unsigned long>(stats[s].percentile(99)));
+    }
+    if (len > 0 && static_cast<size_t>(len) < sizeof(line)) {
+        std::snprintf(line + len, sizeof(line) - len,
+                      " int_kb=%u psram_kb=%u agree=%u/%u zones=%s",
+                      static_cast<unsigned>(internalPeakKb), static_cast<unsigned>(psramPeakKb),
+                      static_cast<unsigned>(agreeCount), static_cast<unsigned>(goldenCount),
+                      zonesOk ? "ok" : "FAIL");
+    }
+    std::printf("%s\n", line);
+
+    sdCard.shutdown();
+    ESP_LOGI(TAG, "Benchmark done");
+}
@@ -0,0 +1,243 @@
+/**
+ * @file frame_set.cpp
+ * @brief Test frame set implementation
+ */
+
+#include "frame_set.hpp"
+
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+static const char* TAG = "FrameSet";
+
+namespace bench {
+
+namespace {
+
+constexpr size_t GOLDEN_MAX_LEN = 8 * 1024;
+
+bool hasJpegExtension(const char* name) {
+    const char* dot = std::strrchr(name, '.');
+    return dot && (strcasecmp(dot, ".jpg") == 0 || strcasecmp(dot, ".jpeg") == 0);
+}
+
+} // namespace
+
+FrameSet::FrameSet()
+    : m_frames{}
+    , m_owned{}
+    , m_count(0)
+    , m_source("none")
+{
+}
+
+FrameSet::~FrameSet() {
+    clear();
+}
+
+void FrameSet::clear() {
+    for (size_t i = 0; i < m_count; i++) {
+        heap_caps_free(m_owned[i]);
+        m_owned[i] = nullptr;
+    }
+    m_count = 0;
+    m_source = "none";
+}
+
+bool FrameSet::jpegSize(const uint8_t* data, size_t len, int& width, int& height) {
+    if (len < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        return false;
+    }
+    size_t i = 2;
+    while (i + 9 < len) {
+        if (data[i] != 0xFF) {
+            return false;
+        }
+        uint8_t marker = data[i + 1];
+        if (marker == 0xFF) {
+            i++;                                    // Fill byte
+            continue;
+        }
+        size_t segmentLen = (static_cast<size_t>(data[i + 2]) << 8) | data[i + 3];
+        // SOF0-SOF15, except DHT (C4), JPG (C8) and DAC (CC)
+        if (marker >= 0xC0 && marker <= 0xCF &&
+            marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            height = (data[i + 5] << 8) | data[i + 6];
+            width = (data[i + 7] << 8) | data[i + 8];
+            return width > 0 && height > 0;
+        }
+        if (marker == 0xDA) {
+            return false;                           // Start of scan before any SOF
+        }
+        i += 2 + segmentLen;
+    }
+    return false;
+}
+
+bool FrameSet::addFrame(const char* name, const uint8_t* data, size_t len, uint8_t* owned) {
+    if (m_count >= config::bench::MAX_FRAMES) {
+        return false;
+    }
+    BenchFrame& frame = m_frames[m_count];
+    frame = {};
+    if (!jpegSize(data, len, frame.width, frame.height)) {
+        ESP_LOGW(TAG, "Skipping %s: not a baseline JPEG", name);
+        return false;
+    }
+    std::snprintf(frame.name, sizeof(frame.name), "%s", name);
+    frame.data = data;
+    frame.len = len;
+    m_owned[m_count] = owned;
+    m_count++;
+    return true;
+}
+
+esp_err_t FrameSet::loadFromSd(const char* mountPoint) {
+    clear();
+
+    char dirPath[64];
+    std::snprintf(dirPath, sizeof(dirPath), "%s/%s", mountPoint, config::bench::SD_DIRECTORY);
+    DIR* dir = opendir(dirPath);
+    if (!dir) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // Sorted names so every run sees the same order
+    char nameStore[config::bench::MAX_FRAMES][sizeof(BenchFrame::name)];
+    const char* names[config::bench::MAX_FRAMES];
+    size_t nameCount = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr && nameCount < config::bench::MAX_FRAMES) {
+        if (hasJpegExtension(entry->d_name) && std::strlen(entry->d_name) < sizeof(nameStore[0])) {
+            std::strcpy(nameStore[nameCount], entry->d_name);
+            names[nameCount] = nameStore[nameCount];
+            nameCount++;
+        }
+    }
+    closedir(dir);
+    std::sort(names, names + nameCount, [](const char* a, const char* b) {
+        return std::strcmp(a, b) < 0;
+    });
+
+    esp_err_t err = ESP_OK;
+    char path[128];
+    for (size_t i = 0; i < nameCount && err == ESP_OK; i++) {
+        std::snprintf(path, sizeof(path), "%s/%s", dirPath, names[i]);
+        struct stat st = {};
+        if (stat(path, &st) != 0 || st.st_size <= 0 ||
+            static_cast<size_t>(st.st_size) > config::bench::MAX_FRAME_BYTES) {
+            ESP_LOGW(TAG, "Skipping %s: missing, empty or larger than %u bytes", names[i],
+                     static_cast<unsigned>(config::bench::MAX_FRAME_BYTES));
+            continue;
+        }
+        size_t len = static_cast<size_t>(st.st_size);
+        uint8_t* data = static_cast<uint8_t*>(heap_caps_malloc(len, MALLOC_CAP_SPIRAM));
+        if (!data) {
+            err = ESP_ERR_NO_MEM;
+            break;
+        }
+        FILE* file = std::fopen(path, "rb");
+        size_t read = file ? std::fread(data, 1, len, file) : 0;
+        if (file) {
+            std::fclose(file);
+        }
+        if (read != len || !addFrame(names[i], data, len, data)) {
+            heap_caps_free(data);
+        }
+    }
+    if (err != ESP_OK) {
+        clear();
+        return err;
+    }
+    if (m_count == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    m_source = "sd";
+
+    std::snprintf(path, sizeof(path), "%s/%s", dirPath, config::bench::GOLDEN_FILE);
+    FILE* golden = std::fopen(path, "r");
+    if (golden) {
+        char* text = static_cast<char*>(heap_caps_malloc(GOLDEN_MAX_LEN + 1, MALLOC_CAP_DEFAULT));
+        if (text) {
+            size_t len = std::fread(text, 1, GOLDEN_MAX_LEN, golden);
+            text[len] = '\0';
+            parseGolden(text);
+            heap_caps_free(text);
+        }
+        std::fclose(golden);
+    }
+    return ESP_OK;
+}
+
+esp_err_t FrameSet::loadEmbedded() {
+    clear();
+    for (size_t i = 0; i < EMBEDDED_FRAME_COUNT; i++) {
+        const EmbeddedFrame& embedded = EMBEDDED_FRAMES[i];
+        addFrame(embedded.name, embedded.start,
+                 static_cast<size_t>(embedded.end - embedded.start), nullptr);
+    }
+    if (m_count == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    m_source = "flash";
+    if (EMBEDDED_GOLDEN) {
+        parseGolden(EMBEDDED_GOLDEN);
+    }
+    return ESP_OK;
+}
+
+void FrameSet::parseGolden(const char* text) {
+    const char* line = text;
+    while (*line) {
+        const char* next = std::strchr(line, '\n');
+        size_t lineLen = next ? static_cast<size_t>(next - line) : std::strlen(line);
+
+        char buffer[128];
+        size_t copyLen = std::min(lineLen, sizeof(buffer) - 1);
+        std::memcpy(buffer, line, copyLen);
+        buffer[copyLen] = '\0';
+
+        char name[sizeof(BenchFrame::name)];
+        unsigned count = 0;
+        GoldenResult golden = {};
+        int fields = (buffer[0] == '#') ? 0
+            : std::sscanf(buffer, "%31s %u %d %d %d %d", name, &count,
+                          &golden.x, &golden.y, &golden.width, &golden.height);
+        if (fields == 2 || fields == 6) {
+            golden.count = count;
+            for (size_t i = 0; i < m_count; i++) {
+                if (std::strcmp(m_frames[i].name, name) == 0) {
+                    m_frames[i].golden = golden;
+                    m_frames[i].hasGolden = (count == 0 || fields == 6);
+                    break;
+                }
+            }
+        }
+
+        if (!next) {
+            break;
+        }
+        line = next + 1;
+    }
+}
+
+camera_fb_t FrameSet::cameraFrame(size_t index) const {
+    const BenchFrame& frame = m_frames[index];
+    camera_fb_t fb = {};
+    fb.buf = const_cast<uint8_t*>(frame.data);
+    fb.len = frame.len;
+    fb.width = static_cast<size_t>(frame.width);
+    fb.height = static_cast<size_t>(frame.height);
+    fb.format = PIXFORMAT_JPEG;
+    return fb;
+}
+
+} // namespace bench
@@ -0,0 +1,137 @@
+#pragma once
+
+/**
+ * @file frame_set.hpp
+ * @brief Fixed set of JPEG test frames with their golden results
+ *
+ * Frames come from the SD card (config::bench::SD_DIRECTORY) or from
+ * the app image (JPEGs in benchmark/frames/, embedded at build time). Each
+ * source may carry a golden file with one line per frame:
+ *
+ *   # name      boxes  best box (x y width height, frame coordinates)
+ *   porch.jpg   1      412 230 96 210
+ *   empty.jpg   0
+ */
+
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "bench_config.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace bench {
+
+/**
+ * @brief Expected detection outcome of one frame
+ */
+struct GoldenResult {
+    size_t count;       // Boxes expected (0 = no detection)
+    int x;              // Best box
+    int y;
+    int width;
+    int height;
+};
+
+/**
+ * @brief One test frame
+ */
+struct BenchFrame {
+    char name[32];
+    const uint8_t* data;
+    size_t len;
+    int width;          // From the JPEG SOF header
+    int height;
+    bool hasGolden;
+    GoldenResult golden;
+};
+
+/**
+ * @brief Frame built into the app image
+ */
+struct EmbeddedFrame {
+    const char* name;
+    const uint8_t* start;
+    const uint8_t* end;
+};
+
+// Generated from benchmark/frames/ at build time (embedded_frames.cpp.in)
+extern const EmbeddedFrame EMBEDDED_FRAMES[];
+extern const size_t EMBEDDED_FRAME_COUNT;
+extern const char* const EMBEDDED_GOLDEN;      // nullptr if no golden.txt
+
+/**
+ * @brief Test frame set, sorted by name
+ *
+ * @code
+ *   FrameSet frames;
+ *   if (frames.loadFromSd("/sdcard") != ESP_OK) {
+ *       frames.loadEmbedded();
+ *   }
+ *   camera_fb_t fb = frames.cameraFrame(0);
+ *   detector.detect(&fb);
+ * @endcode
+ */
+class FrameSet {
+public:
+    FrameSet();
+    ~FrameSet();
+
+    // Disable copy operations
+    FrameSet(const FrameSet&) = delete;
+    FrameSet& operator=(const FrameSet&) = delete;
+
+    /**
+     * @brief Load the JPEGs in <mountPoint>/<SD_DIRECTORY> into PSRAM
+     *
+     * @return esp_err_t
+     *         - ESP_OK if at least one frame was loaded
+     *         - ESP_ERR_NOT_FOUND if the directory holds no usable frame
+     *         - ESP_ERR_NO_MEM if a frame does not fit in PSRAM
+     */
+    esp_err_t loadFromSd(const char* mountPoint);
+
+    /**
+     * @brief Use the frames built into the app image
+     *
+     * @return esp_err_t ESP_ERR_NOT_FOUND if none were embedded
+     */
+    esp_err_t loadEmbedded();
+
+    size_t size() const { return m_count; }
+    const BenchFrame& frame(size_t index) const { return m_frames[index]; }
+
+    /**
+     * @brief Where the frames came from ("sd", "flash" or "none")
+     */
+    const char* source() const { return m_source; }
+
+    /**
+     * @brief Wrap a frame as a JPEG camera frame buffer (no copy)
+     */
+    camera_fb_t cameraFrame(size_t index) const;
+
+private:
+    BenchFrame m_frames[config::bench::MAX_FRAMES];
+    uint8_t* m_owned[config::bench::MAX_FRAMES];    // PSRAM copies (SD frames)
+    size_t m_count;
+    const char* m_source;
+
+    /**
+     * @brief Append a frame if its JPEG header is readable
+     */
+    bool addFrame(const char* name, const uint8_t* data, size_t len, uint8_t* owned);
+
+    /**
+     * @brief Attach golden results to the loaded frames
+     */
+    void parseGolden(const char* text);
+
+    void clear();
+
+    /**
+     * @brief Read width and height from the JPEG SOF segment
+     */
+    static bool jpegSize(const uint8_t* data, size_t len, int& width, int& height);
+};
+
+} // namespace bench
@@ -0,0 +1,42 @@
+/**
+ * @file latency_stats.cpp
+ * @brief Latency statistics implementation
+ */
+
+#include "latency_stats.hpp"
+
+#include <algorithm>
+
+namespace bench {
+
+LatencyStats::LatencyStats(size_t capacity)
+    : m_sorted(false)
+{
+    m_samples.reserve(capacity);
+}
+
+void LatencyStats::add(uint32_t us) {
+    m_samples.push_back(us);
+    m_sorted = false;
+}
+
+uint32_t LatencyStats::min() const {
+    return percentile(0);
+}
+
+uint32_t LatencyStats::percentile(int pct) const {
+    if (m_samples.empty()) {
+        return 0;
+    }
+    if (!m_sorted) {
+        m_order = m_samples;
+        std::sort(m_order.begin(), m_order.end());
+        m_sorted = true;
+    }
+    pct = std::clamp(pct, 0, 100);
+    // Nearest rank: ceil(pct / 100 * n), 1-based
+    size_t rank = (static_cast<size_t>(pct) * m_order.size() + 99) / 100;
+    return m_order[(rank > 0) ? rank - 1 : 0];
+}
+
+} // namespace bench
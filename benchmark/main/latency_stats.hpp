@@ -0,0 +1,44 @@
+#pragma once
+
+/**
+ * @file latency_stats.hpp
+ * @brief Latency samples with min / median / p99
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace bench {
+
+/**
+ * @brief Collected durations of one stage
+ *
+ * @code
+ *   LatencyStats decode(frames * passes);
+ *   decode.add(stageUs);
+ *   uint32_t p99 = decode.percentile(99);
+ * @endcode
+ */
+class LatencyStats {
+public:
+    explicit LatencyStats(size_t capacity);
+
+    void add(uint32_t us);
+
+    size_t count() const { return m_samples.size(); }
+
+    uint32_t min() const;
+
+    /**
+     * @brief Nearest-rank percentile (50 = median)
+     */
+    uint32_t percentile(int pct) const;
+
+private:
+    std::vector<uint32_t> m_samples;
+    mutable bool m_sorted;
+    mutable std::vector<uint32_t> m_order;
+};
+
+} // namespace bench
@@ -5,18 +5,34 @@
 extern const uint8_t detect_espdl[] asm("_binary_detect_espdl_start");
 static const char *path = (const char *)detect_espdl;
 #elif CONFIG_DETECT_MODEL_IN_FLASH_PARTITION
-static const char *path = "detect";
+static const char *path = "detect_a";
 #else
 #if !defined(CONFIG_BSP_SD_MOUNT_POINT)
 #define CONFIG_BSP_SD_MOUNT_POINT "/sdcard"
 #endif
 #endif
+#if CONFIG_DETECT_MODEL_PARAM_COPY
+static constexpr bool param_copy = true;
+#else
+// Weights stay in the memory-mapped flash image
+static constexpr bool param_copy = false;
+#endif
 namespace detect {
-Pico::Pico(const char *model_name, float score_thr, float nms_thr)
+Pico::Pico(const char *model_name, float score_thr, float nms_thr, const char *partition_label)
 {
+#if CONFIG_DETECT_MODEL_IN_FLASH_PARTITION
+    const char *model_path = partition_label ? partition_label : path;
+#elif !CONFIG_DETECT_MODEL_IN_SDCARD
+    const char *model_path = path;
+#endif
 #if !CONFIG_DETECT_MODEL_IN_SDCARD
-    m_model = new dl::Model(
-        path, model_name, static_cast<fbs::model_location_type_t>(CONFIG_DETECT_MODEL_LOCATION));
+    m_model = new dl::Model(model_path,
+                            model_name,
+                            static_cast<fbs::model_location_type_t>(CONFIG_DETECT_MODEL_LOCATION),
+                            0,
+                            dl::MEMORY_MANAGER_GREEDY,
+                            nullptr,
+                            param_copy);
 #else
     auto sd_path =
         std::filesystem::path(CONFIG_BSP_SD_MOUNT_POINT) / CONFIG_DETECT_MODEL_SDCARD_DIR / model_name;
@@ -34,7 +50,8 @@ Pico::Pico(const char *model_name, float score_thr, float nms_thr)
 }
 } // namespace detect
 
-Detect::Detect(model_type_t model_type, bool lazy_load) : m_model_type(model_type)
+Detect::Detect(model_type_t model_type, bool lazy_load, const char *partition_label) :
+    m_model_type(model_type), m_partition_label(partition_label)
 {
     switch (model_type) {
     case model_type_t::PICO_S8_V1:
@@ -54,7 +71,7 @@ void Detect::load_model()
     switch (m_model_type) {
     case model_type_t::PICO_S8_V1:
 #if CONFIG_FLASH_DETECT_PICO_S8_V1 || CONFIG_DETECT_MODEL_IN_SDCARD
-        m_model = new detect::Pico("detect_pico_s8_v1.espdl", m_score_thr[0], m_nms_thr[0]);
+        m_model = new detect::Pico("detect_pico_s8_v1.espdl", m_score_thr[0], m_nms_thr[0], m_partition_label);
 #else
         ESP_LOGE("detect", "detect_pico_s8_v1 is not selected in menuconfig.");
 #endif
@@ -8,18 +8,24 @@ class Pico : public dl::detect::DetectImpl {
 public:
     static inline constexpr float default_score_thr = 0.7;
     static inline constexpr float default_nms_thr = 0.5;
-    Pico(const char *model_name, float score_thr, float nms_thr);
+    Pico(const char *model_name, float score_thr, float nms_thr, const char *partition_label = nullptr);
 };
 } // namespace detect
 
 class Detect : public dl::detect::DetectWrapper {
 public:
     typedef enum { PICO_S8_V1 } model_type_t;
+    /**
+     * @param partition_label Model partition to load from (flash_partition
+     *                        location only); nullptr for the default slot
+     */
     Detect(model_type_t model_type = static_cast<model_type_t>(CONFIG_DEFAULT_DETECT_MODEL),
-           bool lazy_load = true);
+           bool lazy_load = true,
+           const char *partition_label = nullptr);
 
 private:
     void load_model() override;
 
     model_type_t m_model_type;
+    const char *m_partition_label;
 };
@@ -46,47 +46,82 @@
  *    - board_config.hpp: Hardware pin definitions
  *    - app_config.hpp: Application parameters
  *    - credentials.hpp: Network credentials (WiFi, Telegram)
+ *    - runtime_config: Per-device setting overrides (NVS, cached in RTC)
  * 
  * 2. Driver Layer (drivers/)
  *    - camera_driver: OV2640 camera interface
  *    - sdcard_driver: SD card FAT filesystem
+ *    - event_log: Pre-allocated SD event log with a seekable index
+ *    - soil_sensor: Capacitive soil-moisture probe (ADC)
  * 
  * 3. Network Layer (network/)
  *    - wifi_manager: WiFi STA connection management
+ *    - https_session: Keep-alive HTTPS with TLS session resumption
  *    - telegram_client: Telegram Bot API client
+ *    - json_tokenizer: Streaming JSON tokenizer for API responses
+ *    - command_poller: Bot commands fetched on timer wakes
+ *    - alert_outbox: SD-backed queue of undelivered alerts
+ *    - model_updater: OTA model download into the inactive A/B slot
  * 
  * 4. Power Management (power/)
- *    - sleep_manager: Deep sleep and wake-up control
+ *    - sleep_manager: Deep sleep, watch-mode light sleep, wake-up control and
+ *      the wake task queue (one timer wake for every task due close together)
+ *    - wake_stub: RTC wake stub for cooldown wakes (no firmware boot)
  * 
  * 5. Detection Layer (detection/)
  *    - detector: ESP-DL AI model wrapper
+ *    - temporal_confirmer: Multi-frame k-of-n confirmation
+ *    - motion_gate: Thumbnail difference pre-filter
+ *    - model_slots: Active A/B model partition (NVS, cached in RTC)
+ *    - psram_arena: Fixed PSRAM regions for decode and crop buffers
  * 
- * 6. Application Layer (app_main.cpp)
+ * 6. Diagnostics (diagnostics/)
+ *    - stage_profiler: Per-wake stage timing kept in RTC memory
+ *    - energy_meter: Charge per wake class and the Telegram health report
+ * 
+ * 7. Scheduling (scheduling/)
+ *    - boot_scheduler: Background boot jobs on the second core
+ * 
+ * 8. Application Layer (app_main.cpp)
  *    - Main control flow and state machine
  * 
  * State Machine:
  * -------------
  * POWER_ON -> PIR_WARMUP -> DEEP_SLEEP (armed)
  * 
- * PIR_TRIGGER -> MOUNT_SD -> INIT_CAMERA -> WARMUP -> CAPTURE 
- *             -> AI_DETECT -> [PERSON?] -> WIFI_CONNECT -> TELEGRAM_SEND 
- *             -> COOLDOWN -> DEEP_SLEEP (timer)
+ * PIR_TRIGGER -> INIT_CAMERA -> WARMUP -> CAPTURE (low-res)
+ *             -> MOTION_GATE -> [CHANGED?] -> AI_DETECT -> [PERSON?]
+ *             -> CAPTURE (high-res) -> MOUNT_SD -> OUTBOX_QUEUE -> WIFI_CONNECT
+ *             -> TELEGRAM_SEND (+ outbox drain) -> COOLDOWN -> DEEP_SLEEP (timer)
+ *             -> [NO PERSON, BUSY SITE?] -> WATCH (light sleep, camera standby)
+ *             -> GPIO_TRIGGER -> CAPTURE ... (until alert or idle timeout)
  * 
- * TIMER_WAKEUP -> DEEP_SLEEP (re-arm PIR)
+ * TIMER_WAKEUP -> TAKE DUE TASKS (due within COALESCE_WINDOW_SECONDS)
+ *              -> [SOIL SAMPLE?] -> READ PROBE
+ *              -> [ANY WIFI TASK?] -> WIFI_CONNECT (one session for all)
+ *              -> [OUTBOX PENDING?] -> DRAIN
+ *              -> POLL (/arm /disarm /cooldown /status /capture /config /set /unset)
+ *              -> [CROP PHOTO?] -> CAPTURE (camera shared with /capture) -> SEND
+ *              -> [HEALTH REPORT?] -> REPORT -> [MODEL CHECK?] -> UPDATE
+ *              -> SCHEDULE NEXT TASKS -> DEEP_SLEEP (re-arm PIR)
+ * 
+ * Wake stub (no boot): COOLDOWN_END -> re-arm PIR -> DEEP_SLEEP
+ *                      PIR during cooldown -> wait for release -> DEEP_SLEEP
+ *                      PIR pulse shorter than PIR_MIN_PULSE_MS -> DEEP_SLEEP
  * 
  * Power Consumption:
  * -----------------
  * - Deep Sleep (PIR armed): ~10-20mA (ESP32-S3 + PIR sensor)
  * - Deep Sleep (cooldown): ~5-10µA (ESP32-S3 only, PIR disabled)
  * - Active (detection): ~200-300mA for 5-10 seconds
+ * - Per wake class: see the health report (config::energy current model)
  * 
  * Planned Features:
  * -----------------
  * - Smart Irrigation: Soil moisture-based adaptive watering
  * - Crop Monitoring: AI-powered image segmentation for growth tracking
  * - Weather Integration: API-based irrigation scheduling
- * - OTA Updates: Remote firmware and model updates
- * - Command Interface: Telegram bot commands for control
+ * - OTA Updates: Remote firmware updates
  * - Web Dashboard: Configuration and monitoring interface
  * - Multi-zone Detection: Different thresholds per area
  * - Scheduling: Time-based arming/disarming and irrigation
@@ -97,40 +132,533 @@
  * @version 1.0.0
  */
 
+#include <algorithm>
 #include <memory>
 #include <cstdio>
+#include <cstring>
 
 // ESP-IDF core
 #include "esp_log.h"
 #include "esp_err.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_timer.h"
 
 // Configuration
 #include "board_config.hpp"
 #include "app_config.hpp"
 #include "credentials.hpp"
+#include "runtime_config.hpp"
 
 // Drivers
 #include "camera_driver.hpp"
 #include "sdcard_driver.hpp"
+#include "event_log.hpp"
+#include "soil_sensor.hpp"
 
 // Network
 #include "wifi_manager.hpp"
 #include "telegram_client.hpp"
+#include "alert_outbox.hpp"
+#include "model_updater.hpp"
+#include "command_poller.hpp"
+#include "uplink_planner.hpp"
 
 // Power Management
 #include "sleep_manager.hpp"
 
 // Detection
 #include "detector.hpp"
+#include "temporal_confirmer.hpp"
+#include "motion_gate.hpp"
+#include "model_slots.hpp"
+#include "psram_arena.hpp"
+#include "jpeg_cropper.hpp"
+
+// Diagnostics
+#include "stage_profiler.hpp"
+#include "energy_meter.hpp"
+#include "log_buffer.hpp"
+
+// Scheduling
+#include "boot_scheduler.hpp"
 
 static const char* TAG = "SENTINEL";
 
+using diagnostics::Stage;
+using diagnostics::StageProfiler;
+
 // ============================================================================
 // HELPER FUNCTIONS
 // ============================================================================
 
+/**
+ * @brief Boot job: build the detection model (tensor arena, pre/postprocessor)
+ */
+static esp_err_t loadModelJob(void* context) {
+    return static_cast<detection::Detector*>(context)->loadModel();
+}
+
+/**
+ * @brief Boot job: bring up NVS, netif and the WiFi driver (radio off)
+ */
+static esp_err_t initWifiJob(void* context) {
+    return static_cast<network::WifiManager*>(context)->init();
+}
+
+/**
+ * @brief Boot job: full speculative WiFi association
+ */
+static esp_err_t connectWifiJob(void* context) {
+    StageProfiler::instance().start(Stage::WIFI_CONNECT);
+    esp_err_t err = static_cast<network::WifiManager*>(context)->connect();
+    StageProfiler::instance().stop(Stage::WIFI_CONNECT);
+    return err;
+}
+
+/**
+ * @brief Bring WiFi up, joining the background WiFi job first
+ * 
+ * Speculative mode only joins the association already running since wake;
+ * otherwise the driver-init job must finish before connect() so the two
+ * never race.
+ */
+static esp_err_t bringUpWifi(network::WifiManager& wifi,
+                             scheduling::BootScheduler& scheduler,
+                             scheduling::JobId wifiJob, int joinTimeoutMs) {
+    if (wifi.isConnected()) {
+        return ESP_OK;
+    }
+    esp_err_t err;
+    if (config::network::SPECULATIVE_WIFI && wifiJob != scheduling::INVALID_JOB) {
+        err = scheduler.join(wifiJob, joinTimeoutMs);
+    } else {
+        if (wifiJob != scheduling::INVALID_JOB) {
+            scheduler.join(wifiJob, joinTimeoutMs);
+        }
+        StageProfiler::instance().start(Stage::WIFI_CONNECT);
+        err = wifi.connect();
+        StageProfiler::instance().stop(Stage::WIFI_CONNECT);
+    }
+    
+    // Link estimate for the next alert's encoding
+    if (err == ESP_OK) {
+        network::UplinkPlanner::recordRssi(wifi.getRssi());
+    }
+    return err;
+}
+
+/**
+ * @brief Mount the SD card on first use
+ * 
+ * Only the SD model deployment, the outbox and the event log touch the
+ * card, so most wakes never power up the SDMMC slot.
+ */
+static bool ensureSdMounted(drivers::SdCardDriver& sdCard) {
+    if (sdCard.isMounted()) {
+        return true;
+    }
+    StageProfiler::instance().start(Stage::SD_MOUNT);
+    esp_err_t err = sdCard.mount();
+    StageProfiler::instance().stop(Stage::SD_MOUNT);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "❌ SD Card mount failed: %s", esp_err_to_name(err));
+        return false;
+    }
+    ESP_LOGI(TAG, "✓ SD Card mounted at %s", sdCard.getMountPoint());
+    return true;
+}
+
+/**
+ * @brief Append a caption and/or frames to the SD event log
+ * 
+ * @param caption Alert caption (nullptr = frames only)
+ */
+static void logEvents(drivers::SdCardDriver& sdCard, const char* caption,
+                      const network::MediaItem* frames, size_t frameCount,
+                      drivers::EventType frameType) {
+    if (!config::eventlog::ENABLED || !ensureSdMounted(sdCard)) {
+        return;
+    }
+    StageProfiler& profiler = StageProfiler::instance();
+    profiler.start(Stage::EVENT_LOG);
+    drivers::EventLog eventLog(sdCard.getMountPoint());
+    esp_err_t err = eventLog.open();
+    if (err == ESP_OK && caption) {
+        err = eventLog.append(drivers::EventType::ALERT, caption, std::strlen(caption));
+    }
+    for (size_t i = 0; i < frameCount && err == ESP_OK; i++) {
+        err = eventLog.append(frameType, frames[i].data, frames[i].len);
+    }
+    eventLog.close();
+    profiler.stop(Stage::EVENT_LOG);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Event log write failed: %s", esp_err_to_name(err));
+    }
+}
+
+/**
+ * @brief Alert to be logged by the event log job
+ * 
+ * Static storage: a job that outlives its join must not read a returned
+ * stack frame. The photos stay with the camera until the job is done.
+ */
+struct AlertLogJob {
+    drivers::SdCardDriver* sdCard;
+    char caption[config::outbox::MAX_CAPTION_LEN + 1];
+    network::MediaItem frames[config::camera::ALERT_BURST_FRAMES];
+    size_t frameCount;
+};
+
+/**
+ * @brief Background job: write an alert and its photos to the event log
+ */
+static esp_err_t logAlertJob(void* context) {
+    AlertLogJob* job = static_cast<AlertLogJob*>(context);
+    logEvents(*job->sdCard, job->caption, job->frames, job->frameCount,
+              drivers::EventType::ALERT_FRAME);
+    return ESP_OK;
+}
+
+/**
+ * @brief Create and pre-allocate the event log files (power-on)
+ * 
+ * Keeps the 64 MB allocation and index fill out of the first alert wake.
+ */
+static void prepareEventLog() {
+    if (!config::eventlog::ENABLED) {
+        return;
+    }
+    drivers::SdCardDriver sdCard;
+    if (sdCard.mount() == ESP_OK) {
+        drivers::EventLog eventLog(sdCard.getMountPoint());
+        esp_err_t err = eventLog.open();
+        eventLog.close();
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Event log not prepared: %s", esp_err_to_name(err));
+        }
+    } else {
+        ESP_LOGW(TAG, "No SD card: event log created on first use");
+    }
+    sdCard.shutdown();
+}
+
+/**
+ * @brief Send the energy health report, starting a new window once delivered
+ */
+static void sendHealthReport(network::TelegramClient& telegram) {
+    char text[512];
+    diagnostics::EnergyMeter::formatReport(text, sizeof(text));
+    if (telegram.sendMessage(text) == ESP_OK) {
+        ESP_LOGI(TAG, "✓ Health report sent");
+        diagnostics::EnergyMeter::markReported();
+    } else {
+        ESP_LOGW(TAG, "Health report not sent; retrying in %lld s",
+                 static_cast<long long>(config::energy::REPORT_RETRY_SECONDS));
+        diagnostics::EnergyMeter::markReportFailed();
+    }
+}
+
+/**
+ * @brief Camera shared by the photo tasks of a timer wake
+ * 
+ * Initialized and warmed up on the first capture, shut down by the
+ * caller once the wake's photos are sent.
+ */
+struct StillCamera {
+    drivers::CameraDriver driver;
+    bool started = false;
+    bool ready = false;
+};
+
+/**
+ * @brief Take one alert-resolution photo (nullptr on camera failure)
+ */
+static camera_fb_t* captureStill(StillCamera& camera) {
+    StageProfiler& profiler = StageProfiler::instance();
+    if (!camera.started) {
+        camera.started = true;
+        profiler.start(Stage::CAMERA_INIT);
+        esp_err_t err = camera.driver.init();
+        profiler.stop(Stage::CAMERA_INIT);
+        if (err == ESP_OK) {
+            profiler.start(Stage::CAMERA_WARMUP);
+            bool warm = camera.driver.warmup();
+            profiler.stop(Stage::CAMERA_WARMUP);
+            camera.ready = warm &&
+                camera.driver.setCaptureMode(drivers::CaptureMode::ALERT) == ESP_OK;
+        }
+    }
+    if (!camera.ready) {
+        return nullptr;
+    }
+    
+    profiler.start(Stage::ALERT_CAPTURE);
+    camera_fb_t* frame = camera.driver.capture();
+    profiler.stop(Stage::ALERT_CAPTURE);
+    return frame;
+}
+
+/**
+ * @brief Take one alert-resolution photo and send it as a document
+ */
+static void sendStill(network::TelegramClient& telegram, StillCamera& camera,
+                      const char* caption, const char* filename) {
+    StageProfiler& profiler = StageProfiler::instance();
+    camera_fb_t* frame = captureStill(camera);
+    if (frame) {
+        profiler.start(Stage::TELEGRAM_SEND);
+        telegram.sendDocument(frame->buf, frame->len, caption, filename);
+        profiler.stop(Stage::TELEGRAM_SEND);
+        camera.driver.returnFrame(frame);
+    } else {
+        ESP_LOGE(TAG, "❌ Photo capture failed");
+        telegram.sendMessage("❌ Photo failed: camera error");
+    }
+}
+
+/**
+ * @brief Scheduled crop photo, captioned with the last soil reading
+ */
+static void sendCropPhoto(network::TelegramClient& telegram, StillCamera& camera) {
+    char caption[64] = "🌱 Crop photo";
+    const int soil = drivers::SoilSensor::lastPercent();
+    if (soil >= 0) {
+        snprintf(caption, sizeof(caption), "🌱 Crop photo, soil moisture %d %%", soil);
+    }
+    sendStill(telegram, camera, caption, "crop.jpg");
+}
+
+/**
+ * @brief /status: arm state, cooldown, queue, model slot, last wake, battery
+ */
+static void sendStatus(power::SleepManager& sleepMgr, network::TelegramClient& telegram,
+                       drivers::SdCardDriver& sdCard) {
+    char text[512];
+    size_t len = 0;
+    auto append = [&](const char* format, auto... args) {
+        if (len < sizeof(text)) {
+            int n = snprintf(text + len, sizeof(text) - len, format, args...);
+            if (n > 0) {
+                len += static_cast<size_t>(n);
+            }
+        }
+    };
+    
+    append("📋 Status\nPIR: %s", sleepMgr.isArmed() ? "armed" : "disarmed");
+    if (sleepMgr.isInCooldown()) {
+        append(" (cooldown, %lld min left)",
+               static_cast<long long>(sleepMgr.getCooldownRemaining() / 60));
+    }
+    append("\nCooldown after alert: %lld min",
+           static_cast<long long>(sleepMgr.getCooldownDuration() / 60));
+    if (sdCard.isMounted()) {
+        append("\nQueued alerts: %u", static_cast<unsigned>(
+            network::AlertOutbox(sdCard.getMountPoint()).pendingCount()));
+    }
+    append("\nModel: slot %s", detection::ModelSlots::activeLabel());
+    
+    const diagnostics::WakeRecord* lastWake = sleepMgr.getWakeHistoryEntry(0);
+    if (lastWake) {
+        char summary[160];
+        StageProfiler::formatSummary(*lastWake, summary, sizeof(summary));
+        append("\nLast wake: %s", summary);
+    }
+    const int soil = drivers::SoilSensor::lastPercent();
+    if (soil >= 0) {
+        append("\nSoil moisture: %d %% (%lld min ago)", soil,
+               static_cast<long long>(drivers::SoilSensor::lastReadingAge() / 60));
+    }
+    int batteryMv = diagnostics::EnergyMeter::readBatteryMv();
+    if (batteryMv >= 0) {
+        append("\nBattery: %.2f V", batteryMv / 1000.0f);
+    }
+    telegram.sendMessage(text);
+}
+
+/**
+ * @brief /logs: the newest buffered log lines (production logging only)
+ */
+static void sendLogs(network::TelegramClient& telegram) {
+    if (!diagnostics::LogBuffer::isBuffering()) {
+        telegram.sendMessage("📜 Console logging is on (VERBOSE_LOGGING); nothing is buffered");
+        return;
+    }
+    static char text[config::debug::LOG_BUFFER_SIZE + 1];
+    if (diagnostics::LogBuffer::read(text, sizeof(text)) == 0) {
+        telegram.sendMessage("📜 Log buffer is empty");
+        return;
+    }
+    telegram.sendMessage(text);
+}
+
+/**
+ * @brief /set and /unset: change a runtime setting and echo the result
+ */
+static void updateSetting(network::TelegramClient& telegram, const network::BotCommand& command) {
+    char name[config::RuntimeConfig::NAME_MAX] = {};
+    char value[16] = {};
+    const int fields = sscanf(command.args, "%15s %15s", name, value);
+    const bool isSet = (command.type == network::CommandType::SET);
+    if (fields < (isSet ? 2 : 1)) {
+        telegram.sendMessage(isSet ? "Usage: /set <name> <value> (see /config)"
+                                   : "Usage: /unset <name> (see /config)");
+        return;
+    }
+    
+    esp_err_t err = isSet ? config::RuntimeConfig::set(name, value)
+                          : config::RuntimeConfig::clear(name);
+    char reply[128];
+    config::Setting setting;
+    if (err == ESP_ERR_NOT_FOUND || !config::RuntimeConfig::find(name, setting)) {
+        snprintf(reply, sizeof(reply), "❌ Unknown setting %s (see /config)", name);
+    } else {
+        int len = snprintf(reply, sizeof(reply), "%s ", (err == ESP_OK) ? "✅" : "❌");
+        config::RuntimeConfig::format(setting, reply + len, sizeof(reply) - len);
+    }
+    telegram.sendMessage(reply);
+}
+
+/**
+ * @brief Fetch bot commands and apply them, replying to each
+ */
+static void runCommands(power::SleepManager& sleepMgr, network::TelegramClient& telegram,
+                        drivers::SdCardDriver& sdCard, StillCamera& camera) {
+    network::BotCommand commands[config::commands::MAX_UPDATES];
+    size_t count = 0;
+    esp_err_t err = network::CommandPoller::poll(telegram, commands, count);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Command poll failed: %s", esp_err_to_name(err));
+    }
+    
+    char reply[96];
+    for (size_t i = 0; i < count; i++) {
+        const network::BotCommand& command = commands[i];
+        switch (command.type) {
+            case network::CommandType::ARM:
+                if (config::RuntimeConfig::set(config::Setting::ARMED, 1) == ESP_OK) {
+                    sleepMgr.clearCooldown();
+                    telegram.sendMessage("✅ Armed: PIR alerts on");
+                } else {
+                    telegram.sendMessage("❌ Arm failed: settings not stored");
+                }
+                break;
+                
+            case network::CommandType::DISARM:
+                if (config::RuntimeConfig::set(config::Setting::ARMED, 0) == ESP_OK) {
+                    telegram.sendMessage("⏸ Disarmed: PIR alerts off until /arm");
+                } else {
+                    telegram.sendMessage("❌ Disarm failed: settings not stored");
+                }
+                break;
+                
+            case network::CommandType::COOLDOWN:
+                if (command.argument >= 0) {
+                    config::RuntimeConfig::set(config::Setting::COOLDOWN_SECONDS,
+                                               static_cast<int32_t>(std::clamp<int64_t>(
+                        command.argument, config::commands::MIN_COOLDOWN_SECONDS,
+                        config::commands::MAX_COOLDOWN_SECONDS)));
+                }
+                snprintf(reply, sizeof(reply), "⏱ Cooldown after an alert: %lld min",
+                         static_cast<long long>(sleepMgr.getCooldownDuration() / 60));
+                telegram.sendMessage(reply);
+                break;
+                
+            case network::CommandType::STATUS:
+                sendStatus(sleepMgr, telegram, sdCard);
+                break;
+                
+            case network::CommandType::CAPTURE:
+                sendStill(telegram, camera, "📷 Snapshot (/capture)", "snapshot.jpg");
+                break;
+                
+            case network::CommandType::CONFIG: {
+                char text[640];
+                int len = snprintf(text, sizeof(text), "⚙️ Settings (* = set on this device)\n");
+                config::RuntimeConfig::formatAll(text + len, sizeof(text) - len);
+                telegram.sendMessage(text);
+                break;
+            }
+                
+            case network::CommandType::SET:
+            case network::CommandType::UNSET:
+                updateSetting(telegram, command);
+                break;
+                
+            case network::CommandType::LOGS:
+                sendLogs(telegram);
+                break;
+                
+            case network::CommandType::HELP:
+            default:
+                telegram.sendMessage(network::CommandPoller::helpText());
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Queue the next timer wake tasks: queued alerts, model update check,
+ *        command poll, health report, crop photo and soil sample
+ * 
+ * The module-owned due times are taken from their modules on every call;
+ * the crop photo and soil sample are queued one interval after they ran
+ * (takeDueTasks() removes them).
+ */
+static void scheduleWakeTasks(power::SleepManager& sleepMgr) {
+    using power::WakeTask;
+    
+    if (config::outbox::ENABLED && network::AlertOutbox::mayHavePending()) {
+        sleepMgr.scheduleTask(WakeTask::OUTBOX_DRAIN, network::AlertOutbox::retryIntervalSeconds());
+    } else {
+        sleepMgr.cancelTask(WakeTask::OUTBOX_DRAIN);
+    }
+    sleepMgr.scheduleTask(WakeTask::MODEL_CHECK, network::ModelUpdater::secondsUntilCheck());
+    sleepMgr.scheduleTask(WakeTask::COMMAND_POLL, network::CommandPoller::secondsUntilPoll());
+    sleepMgr.scheduleTask(WakeTask::HEALTH_REPORT,
+                          diagnostics::EnergyMeter::secondsUntilReport());
+    
+    auto schedulePeriodic = [&](WakeTask task, bool enabled, int64_t interval) {
+        if (!enabled) {
+            sleepMgr.cancelTask(task);
+        } else if (sleepMgr.getTaskRemaining(task) < 0) {
+            sleepMgr.scheduleTask(task, interval);
+        }
+    };
+    schedulePeriodic(WakeTask::CROP_PHOTO, config::farm::CROP_PHOTO_INTERVAL_SECONDS > 0,
+                     config::farm::CROP_PHOTO_INTERVAL_SECONDS);
+    schedulePeriodic(WakeTask::SOIL_SAMPLE,
+                     drivers::SoilSensor::isFitted() &&
+                         config::farm::SOIL_SAMPLE_INTERVAL_SECONDS > 0,
+                     config::farm::SOIL_SAMPLE_INTERVAL_SECONDS);
+}
+
+/**
+ * @brief High-resolution alert photos held until they are uploaded
+ *
+ * The whole burst is captured (and queued in the outbox) before WiFi is
+ * used, so every frame is held until the upload starts; only the release
+ * after each frame is sent overlaps with the upload. The event log is
+ * written from the same frames while WiFi comes up, and a frame is only
+ * released once that write is done.
+ */
+struct AlertBurst {
+    drivers::CameraDriver* camera;
+    camera_fb_t* frames[config::camera::ALERT_BURST_FRAMES];
+    size_t count;
+};
+
+/**
+ * @brief Media upload callback: hand a sent burst frame back to the camera
+ */
+static void releaseBurstFrame(size_t index, void* context) {
+    AlertBurst* burst = static_cast<AlertBurst*>(context);
+    if (index < burst->count && burst->frames[index]) {
+        burst->camera->returnFrame(burst->frames[index]);
+        burst->frames[index] = nullptr;
+    }
+}
+
 /**
  * @brief Handle initial power-on boot
  * 
@@ -146,35 +674,596 @@ static void handlePowerOnBoot(power::SleepManager& sleepMgr) {
     ESP_LOGI(TAG, "PIR sensor warmup: %d ms", config::pir::WARMUP_MS);
     vTaskDelay(pdMS_TO_TICKS(config::pir::WARMUP_MS));
     
+    // Later wakes take the model slot and settings from RTC memory
+    detection::ModelSlots::refresh();
+    config::RuntimeConfig::refresh();
+    prepareEventLog();
+    scheduleWakeTasks(sleepMgr);
+    
     ESP_LOGI(TAG, "Warmup complete. System will arm on next wake.");
     sleepMgr.enterDeepSleep();
 }
 
 /**
- * @brief Handle timer wake-up (cooldown ended)
+ * @brief Handle timer wake-up (cooldown ended or wake tasks due)
  * 
- * Simply re-arms the PIR sensor and goes back to sleep.
+ * Runs every queued task due within the coalescing window in this one
+ * boot: the soil sample, then queued alerts, bot commands, the crop
+ * photo, the health report and the model update check in one WiFi
+ * association, with one camera init shared by the crop photo and
+ * /capture. Then re-arms the PIR sensor (unless disarmed) and goes back
+ * to sleep. Commands are polled on every uplink, not only when the poll
+ * is due, since the connection is already paid for.
  */
 static void handleTimerWakeup(power::SleepManager& sleepMgr) {
+    using power::WakeTask;
+    using power::wakeTaskBit;
+    
     ESP_LOGI(TAG, "═══════════════════════════════════════════════════════════");
-    ESP_LOGI(TAG, "TIMER WAKEUP - Cooldown period ended");
+    ESP_LOGI(TAG, "TIMER WAKEUP - %s",
+             sleepMgr.isInCooldown() ? "Maintenance" : "Cooldown period ended");
     ESP_LOGI(TAG, "═══════════════════════════════════════════════════════════");
     
-    ESP_LOGI(TAG, "Re-arming PIR sensor...");
+    const power::WakeTaskSet tasks = sleepMgr.takeDueTasks();
+    auto due = [tasks](WakeTask task) { return (tasks & wakeTaskBit(task)) != 0; };
+    
+    if (due(WakeTask::SOIL_SAMPLE)) {
+        int percent = 0;
+        drivers::SoilSensor::sample(percent);
+    }
+    
+    drivers::SdCardDriver sdCard;
+    size_t pending = 0;
+    if (config::outbox::ENABLED && network::AlertOutbox::mayHavePending() &&
+        sdCard.mount() == ESP_OK) {
+        pending = network::AlertOutbox(sdCard.getMountPoint()).pendingCount();
+    }
+    
+    StillCamera camera;
+    if (pending > 0 || power::SleepManager::needsWifi(tasks)) {
+        if (due(WakeTask::COMMAND_POLL)) {
+            network::CommandPoller::markAttempt();
+        }
+        if (due(WakeTask::MODEL_CHECK)) {
+            network::ModelUpdater::markAttempt();
+        }
+        network::WifiManager wifi;
+        const bool online = (wifi.connect() == ESP_OK);
+        sleepMgr.recordUplinkResult(tasks, online);
+        if (online) {
+            network::UplinkPlanner::recordRssi(wifi.getRssi());
+            network::TelegramClient telegram;
+            if (pending > 0) {
+                network::AlertOutbox outbox(sdCard.getMountPoint());
+                outbox.drain(telegram, config::outbox::DRAIN_MAX_ALERTS);
+            }
+            if (config::commands::ENABLED) {
+                runCommands(sleepMgr, telegram, sdCard, camera);
+            }
+            if (due(WakeTask::CROP_PHOTO)) {
+                sendCropPhoto(telegram, camera);
+            }
+            if (due(WakeTask::HEALTH_REPORT)) {
+                sendHealthReport(telegram);
+            }
+            telegram.close();
+            if (due(WakeTask::MODEL_CHECK)) {
+                network::ModelUpdater updater;
+                updater.checkAndUpdate();
+            }
+        } else if (due(WakeTask::HEALTH_REPORT)) {
+            diagnostics::EnergyMeter::markReportFailed();
+        }
+        wifi.disconnect();
+    }
+    if (camera.started) {
+        camera.driver.shutdown();
+    }
+    sdCard.shutdown();
+    scheduleWakeTasks(sleepMgr);
+    
+    if (sleepMgr.isArmed()) {
+        ESP_LOGI(TAG, "Re-arming PIR sensor...");
+    } else {
+        ESP_LOGI(TAG, "Disarmed: PIR stays off until /arm");
+    }
     sleepMgr.enterDeepSleep();
 }
 
+/**
+ * @brief Outcome of one capture-and-decide cycle
+ */
+enum class CycleOutcome {
+    ALERT,              // Alert sent or queued, cooldown started
+    QUIET,              // Nothing detected
+    FAILED              // Capture failed
+};
+
+/**
+ * @brief Hardware and background jobs shared by the cycles of a PIR wake
+ */
+struct PirWake {
+    power::SleepManager& sleepMgr;
+    detection::Detector& detector;
+    drivers::CameraDriver& camera;
+    drivers::SdCardDriver& sdCard;
+    network::WifiManager& wifi;
+    scheduling::BootScheduler& scheduler;
+    scheduling::JobId modelJob;         // INVALID_JOB once joined
+    scheduling::JobId wifiJob;          // INVALID_JOB once joined and torn down
+    int wifiJoinTimeoutMs;
+};
+
+/**
+ * @brief Capture, detect and act on the result (steps 4-6)
+ * 
+ * Runs once per PIR wake, and again on every trigger in watch mode with
+ * the camera warm and the model resident.
+ */
+static CycleOutcome runDetectionCycle(PirWake& wake) {
+    power::SleepManager& sleepMgr = wake.sleepMgr;
+    detection::Detector& detector = wake.detector;
+    drivers::CameraDriver& camera = wake.camera;
+    drivers::SdCardDriver& sdCard = wake.sdCard;
+    network::WifiManager& wifi = wake.wifi;
+    scheduling::BootScheduler& scheduler = wake.scheduler;
+    StageProfiler& profiler = StageProfiler::instance();
+    
+    // ========================================================================
+    // STEP 4: Capture Frame
+    // ========================================================================
+    ESP_LOGI(TAG, "");
+    ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
+    ESP_LOGI(TAG, "STEP 4: Capturing Frame...");
+    ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
+    
+    profiler.start(Stage::CAPTURE);
+    camera_fb_t* frame = camera.capture();
+    profiler.stop(Stage::CAPTURE);
+    if (!frame) {
+        ESP_LOGE(TAG, "❌ Frame capture failed!");
+        return CycleOutcome::FAILED;
+    }
+    ESP_LOGI(TAG, "✓ Frame captured: %zu bytes, %dx%d", 
+             frame->len, frame->width, frame->height);
+    
+    // ========================================================================
+    // STEP 5: AI Object Detection
+    // ========================================================================
+    ESP_LOGI(TAG, "");
+    ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
+    ESP_LOGI(TAG, "STEP 5: Running AI Detection...");
+    ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
+    
+    // Join the model job before inference (detect() loads inline on failure)
+    if (wake.modelJob != scheduling::INVALID_JOB) {
+        scheduler.join(wake.modelJob, config::scheduling::JOIN_TIMEOUT_MS);
+        wake.modelJob = scheduling::INVALID_JOB;
+    }
+    
+    detection::DetectionResult result = {};
+    detection::MotionGate gate;
+    detection::GateDecision gateDecision = config::motion::ENABLED
+        ? gate.evaluate(frame) : detection::GateDecision::NOT_RUN;
+    
+    if (gateDecision == detection::GateDecision::STILL) {
+        // Heat or wind: nothing changed in view, skip the network
+        ESP_LOGI(TAG, "No visual change since last quiet wake - inference skipped");
+    } else if (config::detection::TEMPORAL_CONFIRMATION) {
+        // k-of-n over a short burst; frame becomes the one behind the box
+        detection::TemporalConfirmer confirmer(detector, camera);
+        result = confirmer.confirm(frame);
+    } else {
+        result = detector.detect(frame);
+    }
+    
+    if (config::debug::SAVE_DEBUG_IMAGES && frame) {
+        const network::MediaItem debugFrame = {frame->buf, frame->len};
+        logEvents(sdCard, nullptr, &debugFrame, 1, drivers::EventType::DEBUG_FRAME);
+    }
+    
+    // ========================================================================
+    // STEP 6: Action Based on Detection Result
+    // ========================================================================
+    ESP_LOGI(TAG, "");
+    ESP_LOGI(TAG, "═════════════════════════════════════════════════════════════");
+    
+    bool framesInUse = false;   // Event log job still reading the photos
+    if (result.detected) {
+        ESP_LOGI(TAG, "✓ OBJECT DETECTED! Confidence: %.2f%%", result.confidence * 100.0f);
+        ESP_LOGI(TAG, "═════════════════════════════════════════════════════════════");
+        ESP_LOGI(TAG, "");
+        ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
+        ESP_LOGI(TAG, "STEP 6: Sending Telegram Notification...");
+        ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
+        
+        // Size the photos for the uplink before taking them
+        if (wifi.isConnected()) {
+            network::UplinkPlanner::recordRssi(wifi.getRssi());
+        }
+        const int alertWidth = resolution[config::camera::ALERT_FRAME_SIZE].width;
+        const int alertHeight = resolution[config::camera::ALERT_FRAME_SIZE].height;
+        float cropFraction = 0.0f;
+        if (result.width > 0 && result.height > 0) {
+            const detection::CropWindow window = detection::JpegCropper::around(
+                result.x * alertWidth / frame->width, result.y * alertHeight / frame->height,
+                result.width * alertWidth / frame->width, result.height * alertHeight / frame->height,
+                alertWidth, alertHeight);
+            cropFraction = static_cast<float>(window.width * window.height) /
+                           static_cast<float>(alertWidth * alertHeight);
+        }
+        const network::AlertPlan plan = network::UplinkPlanner::plan(cropFraction);
+        camera.setAlertEncoding(plan.frameSize, plan.jpegQuality);
+        
+        // Grab the high-resolution photos only for confirmed detections
+        AlertBurst burst = {&camera, {}, 0};
+        profiler.start(Stage::ALERT_CAPTURE);
+        if (camera.setCaptureMode(drivers::CaptureMode::ALERT) == ESP_OK) {
+            burst.frames[0] = camera.capture();
+            if (burst.frames[0]) {
+                burst.count = 1;
+                camera_fb_t* first = burst.frames[0];
+                
+                // Map bounding boxes from detection to alert frame coordinates
+                result.x = result.x * first->width / frame->width;
+                result.y = result.y * first->height / frame->height;
+                result.width = result.width * first->width / frame->width;
+                result.height = result.height * first->height / frame->height;
+                for (size_t i = 0; i < result.count; i++) {
+                    detection::Detection& box = result.boxes[i];
+                    box.x = box.x * first->width / frame->width;
+                    box.y = box.y * first->height / frame->height;
+                    box.width = box.width * first->width / frame->width;
+                    box.height = box.height * first->height / frame->height;
+                }
+                
+                network::UplinkPlanner::recordCapture(plan.rung, first->len,
+                                                      first->width * first->height);
+                
+                // Free its buffer for the rest of the burst (a preview keeps it)
+                if (!plan.preview) {
+                    camera.returnFrame(frame);
+                    frame = nullptr;
+                }
+            }
+            while (burst.count > 0 && burst.count < plan.frames) {
+                vTaskDelay(pdMS_TO_TICKS(config::camera::ALERT_BURST_INTERVAL_MS));
+                camera_fb_t* fb = camera.capture();
+                if (!fb) {
+                    break;
+                }
+                burst.frames[burst.count++] = fb;
+            }
+        }
+        profiler.stop(Stage::ALERT_CAPTURE);
+        
+        if (burst.count > 0) {
+            ESP_LOGI(TAG, "✓ Alert burst captured: %u frame(s), %dx%d",
+                     static_cast<unsigned>(burst.count),
+                     burst.frames[0]->width, burst.frames[0]->height);
+        } else {
+            ESP_LOGW(TAG, "High-res capture failed, sending detection frame");
+        }
+        
+        // Prepare caption with detection details
+        char caption[config::outbox::MAX_CAPTION_LEN + 1];
+        int captionLen = std::snprintf(caption, sizeof(caption),
+                     "⚠️ INTRUDER ALERT!\n"
+                     "Confidence: %.1f%%\n"
+                     "Persons: %u\n"
+                     "Time: %lld sec",
+                     result.confidence * 100.0f,
+                     static_cast<unsigned>(detection::countCategory(
+                         result, config::detection::PERSON_CATEGORY)),
+                     sleepMgr.getCurrentTimeSec());
+        
+        // One line per box, best first, as long as they fit
+        for (size_t i = 0; i < result.count && captionLen > 0 &&
+                           static_cast<size_t>(captionLen) < sizeof(caption); i++) {
+            const detection::Detection& box = result.boxes[i];
+            captionLen += std::snprintf(caption + captionLen, sizeof(caption) - captionLen,
+                                        "\n%s %.0f%% (%d,%d) %dx%d %s",
+                                        detection::categoryName(box.category),
+                                        box.score * 100.0f, box.x, box.y,
+                                        box.width, box.height,
+                                        detection::zoneName(box.zone));
+        }
+        if (captionLen > 0 && static_cast<size_t>(captionLen) >= sizeof(caption)) {
+            captionLen = static_cast<int>(sizeof(caption) - 1);
+        }
+        
+        // Append previous wake timing for regression tracking
+        const diagnostics::WakeRecord* lastWake = sleepMgr.getWakeHistoryEntry(0);
+        if (config::profiling::REPORT_IN_TELEGRAM && lastWake &&
+            captionLen > 0 && static_cast<size_t>(captionLen) < sizeof(caption) - 16) {
+            captionLen += std::snprintf(caption + captionLen, sizeof(caption) - captionLen,
+                                        "\nLast wake: ");
+            StageProfiler::formatSummary(*lastWake, caption + captionLen,
+                                         sizeof(caption) - captionLen);
+        }
+        
+        // Photos taken: the burst, or the detection frame as fallback
+        network::MediaItem captured[config::camera::ALERT_BURST_FRAMES];
+        size_t capturedCount = 0;
+        if (burst.count > 0) {
+            for (size_t i = 0; i < burst.count; i++) {
+                captured[capturedCount++] = {burst.frames[i]->buf, burst.frames[i]->len};
+            }
+        } else {
+            captured[capturedCount++] = {frame->buf, frame->len};
+        }
+        
+        // Photos to send: as taken, or the full-resolution crop around the best box
+        network::MediaItem items[config::camera::ALERT_BURST_FRAMES];
+        size_t itemCount = capturedCount;
+        std::copy(captured, captured + capturedCount, items);
+        uint8_t* cropJpeg = nullptr;
+        if (plan.crop && burst.count > 0) {
+            camera_fb_t* first = burst.frames[0];
+            const detection::CropWindow window = detection::JpegCropper::around(
+                result.x, result.y, result.width, result.height, first->width, first->height);
+            size_t cropLen = 0;
+            if (detection::JpegCropper::crop(first->buf, first->len, window,
+                                             config::uplink::CROP_JPEG_QUALITY,
+                                             cropJpeg, cropLen) == ESP_OK) {
+                items[0] = {cropJpeg, cropLen};
+                itemCount = 1;
+            } else {
+                ESP_LOGW(TAG, "Crop failed, sending the whole frame");
+            }
+        }
+        const bool sendPreview = plan.preview && burst.count > 0 && frame;
+        
+        // Persist before touching the network so the alert survives a failed uplink
+        network::AlertOutbox outbox(sdCard.getMountPoint());
+        uint32_t alertId = 0;
+        bool queued = config::outbox::ENABLED && ensureSdMounted(sdCard) &&
+                      outbox.enqueue(items, itemCount, caption, &alertId) == ESP_OK;
+        
+        // Event log on the second core while this one brings WiFi up
+        static AlertLogJob alertLog;
+        scheduling::JobId logJob = scheduling::INVALID_JOB;
+        if (config::eventlog::ENABLED) {
+            alertLog.sdCard = &sdCard;
+            std::snprintf(alertLog.caption, sizeof(alertLog.caption), "%s", caption);
+            std::copy(captured, captured + capturedCount, alertLog.frames);
+            alertLog.frameCount = capturedCount;
+            logJob = scheduler.submit("event_log", &logAlertJob, &alertLog,
+                                      config::scheduling::WORKER_CORE);
+            if (logJob == scheduling::INVALID_JOB) {
+                logAlertJob(&alertLog);
+            }
+        }
+        
+        esp_err_t wifiErr = bringUpWifi(wifi, scheduler, wake.wifiJob, wake.wifiJoinTimeoutMs);
+        if (logJob != scheduling::INVALID_JOB) {
+            framesInUse = scheduler.join(logJob, config::scheduling::JOIN_TIMEOUT_MS) ==
+                          ESP_ERR_TIMEOUT;
+        }
+        if (wifiErr == ESP_OK && wifi.isConnected()) {
+            ESP_LOGI(TAG, "✓ WiFi connected");
+            
+            // Send notification (album for a burst, single photo otherwise)
+            network::TelegramClient telegram;
+            profiler.start(Stage::TELEGRAM_SEND);
+            esp_err_t sendErr = ESP_OK;
+            if (sendPreview) {
+                // Slow link: the small detection frame carries the alert, the photo follows
+                sendErr = telegram.sendDocument(frame->buf, frame->len, caption,
+                                                "intruder_preview.jpg");
+                if (sendErr == ESP_OK) {
+                    ESP_LOGI(TAG, "✓ Preview sent, uploading the photo (~%lu ms)",
+                             static_cast<unsigned long>(plan.estimatedMs));
+                }
+            }
+            size_t sentBytes = 0;
+            for (size_t i = 0; i < itemCount; i++) {
+                sentBytes += items[i].len;
+            }
+            const int64_t uploadStartUs = esp_timer_get_time();
+            if (sendErr != ESP_OK) {
+                // Preview already failed; the photo stays queued
+            } else if (itemCount >= network::TelegramClient::MEDIA_GROUP_MIN) {
+                // Frames go back to the camera as they are sent (already logged)
+                sendErr = telegram.sendMediaGroup(items, itemCount, caption,
+                                                  framesInUse ? nullptr : &releaseBurstFrame,
+                                                  &burst);
+            } else {
+                sendErr = telegram.sendDocument(items[0].data, items[0].len,
+                                                sendPreview ? "📷 Full photo" : caption,
+                                                "intruder_detection.jpg");
+            }
+            if (sendErr == ESP_OK) {
+                network::UplinkPlanner::recordUpload(sentBytes,
+                                                     esp_timer_get_time() - uploadStartUs);
+            }
+            profiler.stop(Stage::TELEGRAM_SEND);
+            if (sendErr == ESP_OK) {
+                ESP_LOGI(TAG, "✓ Telegram notification sent successfully!");
+                if (queued) {
+                    outbox.remove(alertId);
+                }
+                
+                // Same session carries any alerts left from earlier wakes
+                if (config::outbox::ENABLED && sdCard.isMounted()) {
+                    outbox.drain(telegram, config::outbox::DRAIN_MAX_ALERTS);
+                }
+                if (diagnostics::EnergyMeter::isReportDue()) {
+                    sendHealthReport(telegram);
+                }
+            } else {
+                ESP_LOGE(TAG, "❌ Failed to send Telegram notification");
+            }
+            
+            // close_notify needs the link; the TLS session stays in RTC
+            telegram.close();
+            wifi.disconnect();
+        } else {
+            ESP_LOGE(TAG, "❌ WiFi connection failed - notification not sent");
+        }
+        
+        scheduleWakeTasks(sleepMgr);
+        
+        if (framesInUse) {
+            // Slow card: the log job gets the send time on top of its join
+            framesInUse = scheduler.join(logJob, config::scheduling::JOIN_TIMEOUT_MS) ==
+                          ESP_ERR_TIMEOUT;
+        }
+        if (framesInUse) {
+            ESP_LOGE(TAG, "Event log still writing, photos kept until sleep");
+        } else {
+            // Frames not already released by the upload
+            for (size_t i = 0; i < burst.count; i++) {
+                releaseBurstFrame(i, &burst);
+            }
+        }
+        detection::JpegCropper::release(cropJpeg);
+        
+        // Start cooldown period
+        ESP_LOGI(TAG, "");
+        const int64_t cooldown = sleepMgr.getCooldownDuration();
+        ESP_LOGI(TAG, "Starting cooldown period: %lld seconds (%.1f hours)",
+                 cooldown, cooldown / 3600.0f);
+        sleepMgr.startCooldown(cooldown);
+        
+    } else {
+        ESP_LOGI(TAG, "✗ No person detected (confidence: %.2f%%)", 
+                 result.confidence * 100.0f);
+        ESP_LOGI(TAG, "═════════════════════════════════════════════════════════════");
+        ESP_LOGI(TAG, "False alarm - re-arming immediately");
+        
+        // Quiet wake: this view becomes the motion reference
+        gate.updateReference();
+        
+        if (config::outbox::ENABLED && network::AlertOutbox::mayHavePending() &&
+            ensureSdMounted(sdCard)) {
+            // Use this wake to deliver alerts queued by earlier ones
+            network::AlertOutbox outbox(sdCard.getMountPoint());
+            if (outbox.pendingCount() > 0 &&
+                bringUpWifi(wifi, scheduler, wake.wifiJob, wake.wifiJoinTimeoutMs) == ESP_OK) {
+                network::TelegramClient telegram;
+                outbox.drain(telegram, config::outbox::DRAIN_MAX_ALERTS);
+                telegram.close();
+            }
+            scheduleWakeTasks(sleepMgr);
+        }
+        
+        if (config::network::SPECULATIVE_WIFI && wake.wifiJob != scheduling::INVALID_JOB) {
+            // Drop the speculative association right away
+            wifi.abort();
+            scheduler.join(wake.wifiJob, wake.wifiJoinTimeoutMs);
+            wake.wifiJob = scheduling::INVALID_JOB;
+            wifi.disconnect();
+        }
+    }
+    
+    if (!framesInUse) {
+        camera.returnFrame(frame);
+    }
+    return result.detected ? CycleOutcome::ALERT : CycleOutcome::QUIET;
+}
+
+/**
+ * @brief Keep the WiFi association in DTIM power save between triggers
+ */
+static void parkWifi(PirWake& wake) {
+    if (bringUpWifi(wake.wifi, wake.scheduler, wake.wifiJob, wake.wifiJoinTimeoutMs) == ESP_OK) {
+        wake.wifi.setPowerSave(true);
+    }
+}
+
+/**
+ * @brief Watch mode: light-sleep between triggers and rerun the cycle
+ * 
+ * The camera sits in standby and the model stays resident in PSRAM, so a
+ * trigger reaches a decision without camera init, warmup or model load.
+ * Returns on an alert, a capture failure, a due maintenance wake or
+ * "watch_idle_s" without a trigger; the caller then deep-sleeps.
+ */
+static void runWatchMode(PirWake& wake) {
+    power::SleepManager& sleepMgr = wake.sleepMgr;
+    
+    ESP_LOGI(TAG, "");
+    ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
+    ESP_LOGI(TAG, "WATCH MODE: High trigger rate - staying in light sleep");
+    ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
+    
+    // Boot jobs are finished with; later cycles connect WiFi directly
+    wake.scheduler.joinAll(wake.wifiJoinTimeoutMs);
+    wake.modelJob = scheduling::INVALID_JOB;
+    wake.wifiJob = scheduling::INVALID_JOB;
+    
+    if (sleepMgr.beginWatch() != ESP_OK) {
+        return;
+    }
+    if (config::watch::KEEP_WIFI) {
+        parkWifi(wake);
+    }
+    
+    while (true) {
+        // A due wake task needs the timer wake path
+        int64_t timeoutSec = config::RuntimeConfig::get(config::Setting::WATCH_IDLE_SECONDS);
+        int64_t taskRemaining = sleepMgr.getNextBootRemaining();
+        if (taskRemaining >= 0 && taskRemaining < timeoutSec) {
+            timeoutSec = taskRemaining;
+        }
+        
+        // Card only needed again for an alert or a drain
+        wake.sdCard.shutdown();
+        
+        if (timeoutSec <= 0 || wake.camera.standby() != ESP_OK ||
+            !sleepMgr.waitForTrigger(timeoutSec * 1000)) {
+            break;
+        }
+        
+        ESP_LOGI(TAG, "🚨 Watch trigger");
+        if (wake.camera.resume() != ESP_OK) {
+            break;
+        }
+        if (wake.wifi.isConnected()) {
+            // Full throughput in case this one is an alert
+            wake.wifi.setPowerSave(false);
+        }
+        
+        if (runDetectionCycle(wake) != CycleOutcome::QUIET) {
+            break;
+        }
+        if (config::watch::KEEP_WIFI) {
+            parkWifi(wake);
+        }
+    }
+    
+    ESP_LOGI(TAG, "Leaving watch mode");
+    sleepMgr.endWatch();
+}
+
+/**
+ * @brief Stop the core-1 jobs before powering down
+ * 
+ * Aborts a WiFi association in progress and waits for the WiFi and model
+ * jobs, so deep sleep never cuts a job off mid-flash-read or mid-connect
+ * and the drivers are torn down only once nothing uses them.
+ */
+static void stopBackgroundJobs(network::WifiManager& wifi,
+                               scheduling::BootScheduler& scheduler, int wifiJoinTimeoutMs) {
+    wifi.abort();
+    scheduler.joinAll(wifiJoinTimeoutMs);
+    wifi.disconnect();
+}
+
 /**
  * @brief Handle PIR trigger detection workflow
  * 
  * Complete detection pipeline:
- * 1. Mount SD card (for AI model)
+ * 1. Mount SD card (only when the model is stored on it)
  * 2. Initialize camera
  * 3. Warmup camera (exposure stabilization)
  * 4. Capture frame
- * 5. Run AI detection
- * 6. If person detected: send Telegram notification
+ * 5. Motion gate, then AI detection (k-of-n over a pipelined burst)
+ * 6. If person detected: capture a high-res burst, send Telegram album
  * 7. Cleanup and enter deep sleep
+ * 
+ * Steps 4-6 repeat in watch mode while the recent trigger rate is high.
  */
 static void handlePirTrigger(power::SleepManager& sleepMgr) {
     ESP_LOGI(TAG, "╔════════════════════════════════════════════════════════════╗");
@@ -189,22 +1278,64 @@ static void handlePirTrigger(power::SleepManager& sleepMgr) {
         sleepMgr.enterDeepSleep();
     }
     
+    // Disarmed sleep has no PIR wake source; ignore a stray trigger
+    if (!sleepMgr.isArmed()) {
+        ESP_LOGW(TAG, "System disarmed. This trigger will be ignored.");
+        sleepMgr.enterDeepSleep();
+    }
+    
+    if (config::profiling::DUMP_HISTORY_ON_WAKE) {
+        sleepMgr.dumpWakeHistory();
+    }
+    
+    StageProfiler& profiler = StageProfiler::instance();
+    
+    // Per-frame detection buffers, reserved before the model and camera
+    // allocations so they never fragment the heap between triggers
+    detection::PsramArena::reserve();
+    
+    // Background jobs: WiFi (driver init, or full association when
+    // speculative) and model construction run on core 1
+    detection::Detector detector;
+    network::WifiManager wifi;
+    scheduling::BootScheduler scheduler;
+    
+    const bool speculativeWifi = config::network::SPECULATIVE_WIFI;
+    scheduling::JobId wifiJob = scheduling::INVALID_JOB;
+    if (speculativeWifi) {
+        wifiJob = scheduler.submit(
+            "wifi_connect", &connectWifiJob, &wifi, config::scheduling::WORKER_CORE);
+    } else if (config::scheduling::PREINIT_WIFI_DRIVER) {
+        wifiJob = scheduler.submit(
+            "wifi_init", &initWifiJob, &wifi, config::scheduling::WORKER_CORE);
+    }
+    const int wifiJoinTimeoutMs = speculativeWifi
+        ? config::RuntimeConfig::get(config::Setting::WIFI_TIMEOUT_MS) +
+          config::scheduling::JOIN_TIMEOUT_MS
+        : config::scheduling::JOIN_TIMEOUT_MS;
+    
     // ========================================================================
-    // STEP 1: Mount SD Card
+    // STEP 1: Mount SD Card (SD model deployment only)
     // ========================================================================
+    // With the model in its flash partition the card is mounted lazily,
+    // only when an alert has to be queued or drained
+    drivers::SdCardDriver sdCard;
+#if CONFIG_DETECT_MODEL_IN_SDCARD
     ESP_LOGI(TAG, "");
     ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
     ESP_LOGI(TAG, "STEP 1: Mounting SD Card...");
     ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
     
-    drivers::SdCardDriver sdCard;
-    if (sdCard.mount() != ESP_OK) {
-        ESP_LOGE(TAG, "❌ SD Card mount failed!");
+    if (!ensureSdMounted(sdCard)) {
         ESP_LOGE(TAG, "Cannot proceed without AI model storage.");
-        sdCard.shutdown();
+        stopBackgroundJobs(wifi, scheduler, wifiJoinTimeoutMs);
         sleepMgr.enterDeepSleep();
     }
-    ESP_LOGI(TAG, "✓ SD Card mounted at %s", sdCard.getMountPoint());
+#endif
+    
+    // Model construction on core 1 while core 0 runs the camera
+    scheduling::JobId modelJob = scheduler.submit(
+        "model_load", &loadModelJob, &detector, config::scheduling::WORKER_CORE);
     
     // ========================================================================
     // STEP 2: Initialize Camera
@@ -215,13 +1346,17 @@ static void handlePirTrigger(power::SleepManager& sleepMgr) {
     ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
     
     drivers::CameraDriver camera;
-    if (camera.init() != ESP_OK) {
+    profiler.start(Stage::CAMERA_INIT);
+    esp_err_t camErr = camera.init();
+    profiler.stop(Stage::CAMERA_INIT);
+    if (camErr != ESP_OK) {
         ESP_LOGE(TAG, "❌ Camera initialization failed!");
+        stopBackgroundJobs(wifi, scheduler, wifiJoinTimeoutMs);
         camera.shutdown();
         sdCard.shutdown();
         sleepMgr.enterDeepSleep();
     }
-    ESP_LOGI(TAG, "✓ Camera initialized: OV2640, SXGA (1280x1024), JPEG");
+    ESP_LOGI(TAG, "✓ Camera initialized: OV2640, JPEG (QVGA detection / SXGA alert)");
     
     // ========================================================================
     // STEP 3: Camera Warmup (Exposure Stabilization)
@@ -231,100 +1366,28 @@ static void handlePirTrigger(power::SleepManager& sleepMgr) {
     ESP_LOGI(TAG, "STEP 3: Camera Warmup & Exposure Stabilization...");
     ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
     
-    if (!camera.warmup()) {
+    profiler.start(Stage::CAMERA_WARMUP);
+    bool warmedUp = camera.warmup();
+    profiler.stop(Stage::CAMERA_WARMUP);
+    if (!warmedUp) {
         ESP_LOGE(TAG, "❌ Camera warmup failed!");
         ESP_LOGE(TAG, "Insufficient valid frames captured.");
+        stopBackgroundJobs(wifi, scheduler, wifiJoinTimeoutMs);
         camera.shutdown();
         sdCard.shutdown();
         sleepMgr.enterDeepSleep();
     }
     ESP_LOGI(TAG, "✓ Camera ready for capture");
     
-    // ========================================================================
-    // STEP 4: Capture Frame
-    // ========================================================================
-    ESP_LOGI(TAG, "");
-    ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
-    ESP_LOGI(TAG, "STEP 4: Capturing Frame...");
-    ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
-    
-    camera_fb_t* frame = camera.capture();
-    if (!frame) {
-        ESP_LOGE(TAG, "❌ Frame capture failed!");
-        camera.shutdown();
-        sdCard.shutdown();
-        sleepMgr.enterDeepSleep();
-    }
-    ESP_LOGI(TAG, "✓ Frame captured: %zu bytes, %dx%d", 
-             frame->len, frame->width, frame->height);
-    
-    // ========================================================================
-    // STEP 5: AI Object Detection
-    // ========================================================================
-    ESP_LOGI(TAG, "");
-    ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
-    ESP_LOGI(TAG, "STEP 5: Running AI Detection...");
-    ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
-    
-    detection::Detector detector;
-    detection::DetectionResult result = detector.detect(frame);
+    PirWake wake = {sleepMgr, detector, camera, sdCard, wifi, scheduler,
+                    modelJob, wifiJob, wifiJoinTimeoutMs};
+    CycleOutcome outcome = runDetectionCycle(wake);
     
     // ========================================================================
-    // STEP 6: Action Based on Detection Result
+    // Watch Mode (busy sites): light sleep between triggers
     // ========================================================================
-    ESP_LOGI(TAG, "");
-    ESP_LOGI(TAG, "═════════════════════════════════════════════════════════════");
-    
-    if (result.detected && result.confidence >= config::detection::MIN_CONFIDENCE) {
-        ESP_LOGI(TAG, "✓ OBJECT DETECTED! Confidence: %.2f%%", result.confidence * 100.0f);
-        ESP_LOGI(TAG, "═════════════════════════════════════════════════════════════");
-        ESP_LOGI(TAG, "");
-        ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
-        ESP_LOGI(TAG, "STEP 6: Sending Telegram Notification...");
-        ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
-        
-        // Connect to WiFi
-        network::WifiManager wifi;
-        if (wifi.connect() == ESP_OK && wifi.isConnected()) {
-            ESP_LOGI(TAG, "✓ WiFi connected");
-            
-            // Prepare caption with detection details
-            char caption[128];
-            std::snprintf(caption, sizeof(caption),
-                         "⚠️ INTRUDER ALERT!\n"
-                         "Confidence: %.1f%%\n"
-                         "Time: %lld sec\n"
-                         "Location: (%d,%d) %dx%d",
-                         result.confidence * 100.0f,
-                         sleepMgr.getCurrentTimeSec(),
-                         result.x, result.y, result.width, result.height);
-            
-            // Send notification
-            network::TelegramClient telegram;
-            if (telegram.sendDocument(frame->buf, frame->len, caption, 
-                                     "intruder_detection.jpg") == ESP_OK) {
-                ESP_LOGI(TAG, "✓ Telegram notification sent successfully!");
-            } else {
-                ESP_LOGE(TAG, "❌ Failed to send Telegram notification");
-            }
-            
-            wifi.disconnect();
-        } else {
-            ESP_LOGE(TAG, "❌ WiFi connection failed - notification not sent");
-        }
-        
-        // Start cooldown period
-        ESP_LOGI(TAG, "");
-        ESP_LOGI(TAG, "Starting cooldown period: %lld seconds (%.1f hours)",
-                 config::timing::COOLDOWN_SECONDS,
-                 config::timing::COOLDOWN_SECONDS / 3600.0f);
-        sleepMgr.startCooldown(config::timing::COOLDOWN_SECONDS);
-        
-    } else {
-        ESP_LOGI(TAG, "✗ No person detected (confidence: %.2f%%)", 
-                 result.confidence * 100.0f);
-        ESP_LOGI(TAG, "═════════════════════════════════════════════════════════════");
-        ESP_LOGI(TAG, "False alarm - re-arming immediately");
+    if (outcome == CycleOutcome::QUIET && sleepMgr.shouldWatch()) {
+        runWatchMode(wake);
     }
     
     // ========================================================================
@@ -335,9 +1398,11 @@ static void handlePirTrigger(power::SleepManager& sleepMgr) {
     ESP_LOGI(TAG, "STEP 7: Cleanup & Power Down...");
     ESP_LOGI(TAG, "─────────────────────────────────────────────────────────────");
     
-    camera.returnFrame(frame);
+    profiler.start(Stage::SHUTDOWN);
+    stopBackgroundJobs(wifi, scheduler, wifiJoinTimeoutMs);
     camera.shutdown();
     sdCard.shutdown();
+    profiler.stop(Stage::SHUTDOWN);
     
     ESP_LOGI(TAG, "✓ All hardware shut down");
     ESP_LOGI(TAG, "");
@@ -355,6 +1420,9 @@ static void handlePirTrigger(power::SleepManager& sleepMgr) {
  * It determines the wake reason and dispatches to the appropriate handler.
  */
 extern "C" void app_main(void) {
+    // Production builds: logs to the RTC ring, off the wake-to-sleep path
+    diagnostics::LogBuffer::install();
+    
     // Initialize sleep manager (determines wake reason)
     power::SleepManager sleepMgr;
     power::WakeReason wakeReason = sleepMgr.getWakeReason();
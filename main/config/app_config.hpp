@@ -7,10 +7,15 @@
  * Contains timing, thresholds, and behavioral settings for the
  * autonomous detection security system.
  * 
+ * Constants marked "runtime" are defaults: config::RuntimeConfig reads
+ * them through per-device NVS overrides (runtime_config.hpp).
+ * 
  * @note For production, consider moving sensitive data to NVS or Kconfig
  */
 
 #include <cstdint>
+#include <cstddef>
+#include "sensor.h"
 
 namespace config {
 
@@ -18,60 +23,617 @@ namespace config {
 // Timing Configuration
 // =============================================================================
 namespace timing {
-    // Cooldown period after detection (seconds)
+    // Cooldown period after detection (seconds; runtime "cooldown_s")
     constexpr int64_t COOLDOWN_SECONDS = 3600;  // 1 hour
     
-    // WiFi connection timeout (milliseconds)
+    // WiFi connection timeout (milliseconds; runtime "wifi_timeout_ms")
     constexpr int WIFI_TIMEOUT_MS = 20000;      // 20 seconds
     
-    // HTTP request timeout (milliseconds)
+    // HTTP request timeout (milliseconds; runtime "http_timeout_ms")
     constexpr int HTTP_TIMEOUT_MS = 30000;      // 30 seconds
     
-    // Camera warmup frame count
+    // Camera warmup frame count (hard upper bound; runtime "warmup_frames")
     constexpr int CAMERA_WARMUP_FRAMES = 25;
     
     // Delay between warmup frames (milliseconds)
     constexpr int CAMERA_WARMUP_DELAY_MS = 35;
     
-    // Minimum valid warmup frames required
+    // Minimum valid warmup frames required (when exposure never converged)
     constexpr int CAMERA_MIN_VALID_FRAMES = 20;
     
+    // Consecutive stable frames that count as AEC/AGC convergence
+    // (runtime "stable_frames")
+    constexpr int CAMERA_WARMUP_STABLE_FRAMES = 3;
+    
+    // JPEG size change tolerated between stable frames (percent)
+    constexpr int CAMERA_WARMUP_SIZE_TOLERANCE_PCT = 5;
+    
+    // Exposure (AEC line count) change tolerated between stable frames
+    constexpr int CAMERA_WARMUP_AEC_TOLERANCE = 8;
+    
+    // Gain change tolerated between stable frames
+    constexpr int CAMERA_WARMUP_GAIN_TOLERANCE = 2;
+    
 } // namespace timing
 
 // =============================================================================
 // Camera Configuration
 // =============================================================================
 namespace camera {
-    // JPEG quality (0-63, lower = better quality)
+    // JPEG quality (0-63, lower = better quality; runtime "jpeg_quality")
     constexpr int JPEG_QUALITY = 10;
     
-    // Frame buffer count (use 3 for better frame selection)
+    // Frame buffer count (use 3 for better frame selection; runtime "fb_count")
     constexpr int FB_COUNT = 3;
     
     // Minimum valid frame size (bytes)
     constexpr size_t MIN_FRAME_SIZE = 1024;
     
+    // Low-resolution stream used for warmup and inference
+    constexpr framesize_t DETECTION_FRAME_SIZE = FRAMESIZE_QVGA;   // 320x240
+    
+    // High-resolution stream used only for the alert photo
+    constexpr framesize_t ALERT_FRAME_SIZE = FRAMESIZE_SXGA;       // 1280x1024
+    
+    // Frames discarded after a resolution switch (stale buffers)
+    constexpr int MODE_SWITCH_DISCARD_FRAMES = 2;
+    
+    // Frames discarded when the sensor leaves standby (watch mode)
+    constexpr int STANDBY_DISCARD_FRAMES = 2;
+    
+    // High-resolution photos per alert (>= 2 sends a Telegram album).
+    // All of them are held at once, so this cannot exceed FB_COUNT.
+    constexpr int ALERT_BURST_FRAMES = 3;
+    static_assert(ALERT_BURST_FRAMES >= 1 && ALERT_BURST_FRAMES <= FB_COUNT,
+                  "Alert burst must fit in the frame buffers");
+    
+    // Delay between burst photos (milliseconds)
+    constexpr int ALERT_BURST_INTERVAL_MS = 150;
+    
 } // namespace camera
 
 // =============================================================================
 // Detection Configuration
 // =============================================================================
 namespace detection {
-    // Minimum confidence score for positive detection
+    // Default minimum confidence score for positive detection
+    // (runtime "min_conf")
     constexpr float MIN_CONFIDENCE = 0.5f;
     
+    // Reference frame of the zone coordinates: the detection stream.
+    // Frames of another size (alert-resolution fallback, full-size
+    // decodes) get the zones scaled to them.
+    constexpr int ZONE_FRAME_WIDTH = 320;
+    constexpr int ZONE_FRAME_HEIGHT = 240;
+    
+    /**
+     * @brief Region of interest in detection frame coordinates
+     *        (ZONE_FRAME_WIDTH x ZONE_FRAME_HEIGHT)
+     */
+    struct Zone {
+        const char* name;
+        int x;
+        int y;
+        int width;
+        int height;
+        float minConfidence;    // Threshold for boxes centred here (0 = runtime "min_conf")
+        bool ignore;            // Boxes centred here are discarded
+    };
+    
+    // Inference runs on a crop of each watched zone (the id reported in
+    // DetectionResult is the index here). Ignore zones are never cropped;
+    // with no watched zone the whole frame is inferred at "min_conf".
+    constexpr Zone ZONES[] = {
+        {"frame", 0, 0, 320, 240, 0.0f, false},
+    };
+    constexpr size_t ZONE_COUNT = sizeof(ZONES) / sizeof(ZONES[0]);
+    
+    // Boxes kept per frame (matches the Pico postprocessor top_k)
+    constexpr size_t MAX_DETECTIONS = 10;
+    
+    // Model class ids and their caption names
+    constexpr int PERSON_CATEGORY = 0;
+    constexpr const char* CATEGORY_NAMES[] = {"person"};
+    
+    // Model input resolution (JPEG is decoded at the smallest 1/2^n
+    // scale that still covers this size)
+    constexpr int MODEL_INPUT_WIDTH = 224;
+    constexpr int MODEL_INPUT_HEIGHT = 224;
+    
+    // Fuse several detection frames before deciding (pipelined capture)
+    constexpr bool TEMPORAL_CONFIRMATION = true;
+    
+    // Frames inferred at most, and tracked positives required (k-of-n)
+    constexpr int CONFIRM_FRAMES = 4;
+    constexpr int CONFIRM_REQUIRED = 2;
+    static_assert(CONFIRM_REQUIRED >= 1 && CONFIRM_REQUIRED <= CONFIRM_FRAMES,
+                  "k-of-n needs 1 <= k <= n");
+    
+    // Minimum box overlap for a detection to count toward the same track
+    constexpr float CONFIRM_TRACK_IOU = 0.3f;
+    
+    // Single-frame score that confirms immediately
+    constexpr float ACCEPT_CONFIDENCE = 0.85f;
+    
+    // Scores below this on every frame so far reject early...
+    constexpr float REJECT_CONFIDENCE = 0.2f;
+    
+    // ...once at least this many frames have been seen
+    constexpr int CONFIRM_MIN_REJECT_FRAMES = 2;
+    
+    // Maximum wait for the next pipelined frame (milliseconds)
+    constexpr int CONFIRM_FRAME_TIMEOUT_MS = 1000;
+    
+    // ESP32-P4: decode on the JPEG codec + PPA instead of esp_new_jpeg.
+    // Off until validated on the board: the RGB565 channel order is
+    // untested, so run the benchmark with it on and check golden agreement
+    // (and the colours of a decoded frame) before enabling.
+    constexpr bool HW_JPEG_DECODE = false;
+    
 } // namespace detection
 
+// =============================================================================
+// Detection Memory Arena
+// =============================================================================
+// One PSRAM block reserved at boot (detection::PsramArena) holds the
+// per-frame buffers, so repeated detections do not touch the heap.
+namespace arena {
+    // Largest decoded image: the detection stream at full scale (RGB565)
+    constexpr int IMAGE_MAX_WIDTH = 320;
+    constexpr int IMAGE_MAX_HEIGHT = 240;
+    constexpr size_t IMAGE_BYTES =
+        static_cast<size_t>(IMAGE_MAX_WIDTH) * IMAGE_MAX_HEIGHT * 2;
+    
+    // Zone crops and postprocessing scratch (a crop never exceeds the image)
+    constexpr size_t SCRATCH_BYTES = IMAGE_BYTES;
+    
+    // Budget for the resident model (dl::Model tensor arena, weights copy,
+    // pre/postprocessor); a load above it is logged
+    constexpr size_t MODEL_BUDGET_BYTES = 1024 * 1024;
+    
+} // namespace arena
+
+// =============================================================================
+// Motion Gate Configuration
+// =============================================================================
+namespace motion {
+    // Skip inference when the frame matches the last quiet wake
+    constexpr bool ENABLED = true;
+    
+    // Grayscale thumbnail compared against the RTC reference
+    constexpr int THUMB_WIDTH = 40;
+    constexpr int THUMB_HEIGHT = 30;
+    
+    // Comparison block edge (thumbnail pixels)
+    constexpr int BLOCK_SIZE = 5;
+    
+    // Mean absolute luma difference that marks a block as changed (0-255)
+    constexpr int BLOCK_DIFF_THRESHOLD = 12;
+    
+    // Changed blocks needed to count as motion
+    constexpr int MIN_CHANGED_BLOCKS = 2;
+    
+    // Reference older than this is not trusted (lighting changes)
+    constexpr int64_t MAX_REFERENCE_AGE_SECONDS = 1800;    // 30 minutes
+    
+} // namespace motion
+
+// =============================================================================
+// Boot Scheduler Configuration
+// =============================================================================
+namespace scheduling {
+    // Core for background boot jobs (core 0 runs the camera pipeline)
+    constexpr int WORKER_CORE = 1;
+    
+    // Background job task stack size (bytes) and priority
+    constexpr uint32_t WORKER_STACK_SIZE = 8192;
+    constexpr int WORKER_PRIORITY = 5;
+    
+    // Maximum time to wait when joining background jobs (milliseconds)
+    constexpr int JOIN_TIMEOUT_MS = 10000;
+    
+    // Initialize NVS and the WiFi driver on every PIR wake (radio stays off)
+    constexpr bool PREINIT_WIFI_DRIVER = true;
+    
+} // namespace scheduling
+
+// =============================================================================
+// Network Configuration
+// =============================================================================
+namespace network {
+    // Start WiFi association right after a PIR wake, in parallel with
+    // capture and detection. Cuts alert latency by the association time at
+    // the cost of radio-on energy on false alarms (torn down on negatives).
+    constexpr bool SPECULATIVE_WIFI = false;
+    
+    // Reuse BSSID, channel and IP lease from the last wake (RTC memory)
+    // for a directed connect with static IP; falls back to scan + DHCP
+    constexpr bool FAST_RECONNECT = true;
+    
+    // Time allowed for the directed connect before falling back (ms)
+    constexpr int FAST_RECONNECT_TIMEOUT_MS = 1500;
+    
+    // Wakes a cached lease is reused before a DHCP refresh is forced
+    constexpr int FAST_RECONNECT_MAX_REUSE = 24;
+    
+    // Keep one TLS connection to api.telegram.org open for all requests
+    // of a wake (closed explicitly before WiFi goes down)
+    constexpr bool TELEGRAM_KEEP_ALIVE = true;
+    
+    // Save the TLS session in RTC memory and resume it on the next wake
+    constexpr bool TLS_SESSION_RESUMPTION = true;
+    
+    // RTC buffer for the serialized TLS session (ticket + metadata)
+    constexpr size_t TLS_SESSION_CACHE_SIZE = 768;
+    
+} // namespace network
+
+// =============================================================================
+// Alert Uplink Configuration
+// =============================================================================
+// The alert encoding is planned before capture from the RSSI and upload
+// throughput of earlier wakes (network::UplinkPlanner)
+namespace uplink {
+    // Pick the alert encoding from the link estimate (false: always the
+    // full-resolution burst)
+    constexpr bool ADAPTIVE = true;
+    
+    // The first notification should arrive within this upload time
+    // (milliseconds, after WiFi is up)
+    constexpr int FIRST_NOTIFICATION_BUDGET_MS = 4000;
+    
+    // Upload time allowed for the full image that follows a preview (ms)
+    constexpr int FULL_IMAGE_BUDGET_MS = 20000;
+    
+    // Fixed cost of one upload request (TLS resume, headers, reply; ms)
+    constexpr int REQUEST_OVERHEAD_MS = 600;
+    
+    // Effective upload throughput assumed until the first measurement (bytes/s)
+    constexpr uint32_t DEFAULT_THROUGHPUT_BPS = 256 * 1024;
+    
+    // Weight of a new sample in the throughput and bytes-per-pixel averages
+    constexpr float SAMPLE_WEIGHT = 0.3f;
+    
+    // Signal drop that halves the expected throughput (dB), applied when
+    // the current RSSI is below the one the throughput was measured at
+    constexpr int RSSI_HALVING_DB = 6;
+    
+    /**
+     * @brief Alert photo encoding, in order of preference
+     */
+    struct Encoding {
+        framesize_t frameSize;
+        int jpegQuality;            // Sensor scale (0-63, lower = better)
+        float bytesPerPixel;        // Initial size estimate (learned per wake)
+    };
+    
+    // Qualities below the runtime "jpeg_quality" are raised to it (the
+    // frame buffers are sized for it at init); 0 = "jpeg_quality"
+    constexpr Encoding LADDER[] = {
+        {camera::ALERT_FRAME_SIZE, 0, 0.12f},
+        {FRAMESIZE_SXGA, 20, 0.07f},
+        {FRAMESIZE_XGA, 20, 0.07f},
+        {FRAMESIZE_SVGA, 24, 0.06f},
+        {FRAMESIZE_VGA, 30, 0.05f},
+    };
+    constexpr size_t LADDER_SIZE = sizeof(LADDER) / sizeof(LADDER[0]);
+    static_assert(LADDER[0].frameSize == camera::ALERT_FRAME_SIZE,
+                  "First rung is the full alert resolution");
+    
+    // Before lowering the resolution, try a full-resolution crop around
+    // the best detection (software decode and re-encode)
+    constexpr bool CROP_TO_DETECTION = true;
+    
+    // Crop window: box grown by this much on each side (percent of the
+    // box size), at least CROP_MIN_SIZE pixels square
+    constexpr int CROP_MARGIN_PCT = 25;
+    constexpr int CROP_MIN_SIZE = 320;
+    
+    // Encoder quality of the crop (esp_new_jpeg scale 1-100)
+    constexpr int CROP_JPEG_QUALITY = 80;
+    
+    // Decode + crop + encode time budgeted for a crop (milliseconds)
+    constexpr int CROP_CPU_MS = 400;
+    
+} // namespace uplink
+
+// =============================================================================
+// Alert Outbox Configuration
+// =============================================================================
+namespace outbox {
+    // Persist every alert on the SD card before sending; undelivered
+    // alerts are retried on later wakes
+    constexpr bool ENABLED = true;
+    
+    // Outbox directory under the SD mount point
+    constexpr const char* DIRECTORY = "outbox";
+    
+    // Maximum queued alerts (oldest are dropped beyond this)
+    constexpr size_t MAX_ALERTS = 32;
+    
+    // Maximum queued alerts delivered in one wake
+    constexpr size_t DRAIN_MAX_ALERTS = 8;
+    
+    // Longest caption stored with an alert
+    constexpr size_t MAX_CAPTION_LEN = 255;
+    
+    // Timer wake for a retry while alerts are queued (seconds); doubles
+    // after each failed drain up to the maximum, back to this on delivery
+    constexpr int64_t RETRY_INTERVAL_SECONDS = 600;    // 10 minutes
+    constexpr int64_t RETRY_MAX_INTERVAL_SECONDS = 4 * 3600;
+    static_assert(RETRY_MAX_INTERVAL_SECONDS >= RETRY_INTERVAL_SECONDS,
+                  "Retry cap below the base interval");
+    
+} // namespace outbox
+
+// =============================================================================
+// Telegram Command Configuration
+// =============================================================================
+// /arm, /disarm, /cooldown <minutes>, /status, /capture from CHAT_ID
+namespace commands {
+    // Poll the bot for commands on timer wakes
+    constexpr bool ENABLED = true;
+    
+    // Timer wake for a command poll (seconds; runtime "poll_s"); timer
+    // wakes that connect for another reason poll as well
+    constexpr int64_t POLL_INTERVAL_SECONDS = 1800;    // 30 minutes
+    
+    // Long-poll wait when no command is queued (seconds). Keeps the
+    // radio-on cost of an idle poll to about one round trip.
+    constexpr int POLL_TIMEOUT_SECONDS = 1;
+    
+    // Extra read time on top of the long-poll wait (milliseconds)
+    constexpr int POLL_READ_MARGIN_MS = 2000;
+    static_assert(POLL_TIMEOUT_SECONDS * 1000 + POLL_READ_MARGIN_MS <= timing::HTTP_TIMEOUT_MS,
+                  "Command poll must not outlast the HTTP timeout");
+    
+    // Updates fetched (and commands run) per poll
+    constexpr size_t MAX_UPDATES = 5;
+    
+    // /cooldown limits (seconds)
+    constexpr int64_t MIN_COOLDOWN_SECONDS = 60;
+    constexpr int64_t MAX_COOLDOWN_SECONDS = 24 * 3600;
+    
+} // namespace commands
+
+// =============================================================================
+// SD Event Log Configuration
+// =============================================================================
+namespace eventlog {
+    // Append alerts (and SAVE_DEBUG_IMAGES frames) to a pre-allocated
+    // log on the SD card
+    constexpr bool ENABLED = true;
+    
+    // Log directory under the SD mount point
+    constexpr const char* DIRECTORY = "events";
+    
+    // Contiguous data file, reused as a ring once full (bytes)
+    constexpr uint32_t DATA_FILE_SIZE = 64UL * 1024 * 1024;    // 64 MB
+    
+    // Index slots (slot = sequence % INDEX_SLOTS; oldest overwritten)
+    constexpr size_t INDEX_SLOTS = 2048;
+    
+    // DMA-capable staging buffer; records go out in writes of this size
+    // (a multiple of the 512-byte sector)
+    constexpr size_t WRITE_CHUNK_SIZE = 16 * 1024;
+    
+    // When appended records are flushed to the card
+    enum class SyncPolicy {
+        EVERY_RECORD,       // fsync() after each record (survives power loss)
+        ON_CLOSE,           // fsync() once when the log is closed (fastest)
+    };
+    constexpr SyncPolicy SYNC_POLICY = SyncPolicy::ON_CLOSE;
+    
+} // namespace eventlog
+
+// =============================================================================
+// Model Update Configuration
+// =============================================================================
+namespace model {
+    // A/B model partitions (partitions.csv); idf.py flash writes slot 0
+    constexpr const char* SLOT_LABELS[] = {"detect_a", "detect_b"};
+    constexpr size_t SLOT_COUNT = sizeof(SLOT_LABELS) / sizeof(SLOT_LABELS[0]);
+    static_assert(SLOT_COUNT == 2, "Model updates alternate between two slots");
+    
+    // NVS namespace holding the active slot and per-slot hashes
+    constexpr const char* NVS_NAMESPACE = "model";
+    
+    // Update server (empty host disables model updates)
+    constexpr const char* UPDATE_HOST = "";
+    constexpr uint16_t UPDATE_PORT = 443;
+    
+    // Manifest ("<sha256 hex> <size>") and model file on the server
+    constexpr const char* MANIFEST_PATH = "/sentinel/detect.espdl.sha256";
+    constexpr const char* MODEL_PATH = "/sentinel/detect.espdl";
+    
+    // Download and flash write unit (one flash sector)
+    constexpr size_t CHUNK_SIZE = 4096;
+    
+    // Timer wake for an update check (seconds)
+    constexpr int64_t CHECK_INTERVAL_SECONDS = 86400;  // 24 hours
+    
+    // An updated slot is on trial until a model load from it succeeds.
+    // Load attempts it gets (a crash during the load counts) before the
+    // previous slot is restored and the image is rejected.
+    constexpr uint8_t TRIAL_LOADS = 2;
+    
+} // namespace model
+
+// =============================================================================
+// Runtime Settings Configuration
+// =============================================================================
+namespace settings {
+    // NVS namespace of the per-device overrides (config::RuntimeConfig)
+    constexpr const char* NVS_NAMESPACE = "settings";
+    
+} // namespace settings
+
+// =============================================================================
+// Watch Mode Configuration
+// =============================================================================
+namespace watch {
+    // Stay up in automatic light sleep between PIR triggers at busy sites:
+    // camera in standby, model resident in PSRAM, GPIO wake
+    constexpr bool ENABLED = true;
+    
+    // Enter watch mode once this many PIR wakes fall within the window
+    constexpr size_t ENTER_TRIGGERS = 4;
+    constexpr int64_t ENTER_WINDOW_SECONDS = 900;      // 15 minutes
+    
+    // Back to deep sleep after this long without a trigger (runtime "watch_idle_s")
+    constexpr int64_t IDLE_TIMEOUT_SECONDS = 300;      // 5 minutes
+    
+    // Keep WiFi associated in DTIM power save while watching (alerts skip
+    // the association, at the cost of the modem sleep current)
+    constexpr bool KEEP_WIFI = false;
+    
+    // DTIM periods between beacon wakes in that power save mode
+    constexpr uint8_t WIFI_LISTEN_INTERVAL = 3;
+    
+    // CPU frequency range for dynamic frequency scaling (MHz)
+    constexpr int MAX_CPU_FREQ_MHZ = 240;
+    constexpr int MIN_CPU_FREQ_MHZ = 40;
+    
+    // PIR output polled at this interval until it drops after a trigger (ms)
+    constexpr int PIR_RELEASE_POLL_MS = 50;
+    
+} // namespace watch
+
+// =============================================================================
+// Wake Stub Configuration
+// =============================================================================
+namespace wake_stub {
+    // Handle cooldown end and PIR wakes during cooldown in an RTC wake
+    // stub instead of a full boot (ESP32-S3). The PIR wake source then
+    // stays armed through the cooldown and the stub filters it.
+    constexpr bool ENABLED = true;
+    
+    // PIR pulse filter: a trigger boots the firmware once the output has
+    // stayed high this long (0 = boot on the rising edge)...
+    constexpr int PIR_MIN_PULSE_MS = 80;
+    
+    // ...or when a new pulse starts this soon after a rejected short one
+    constexpr int PIR_PULSE_PAIR_WINDOW_MS = 3000;
+    
+} // namespace wake_stub
+
+// =============================================================================
+// Wake Scheduler Configuration
+// =============================================================================
+namespace wake {
+    // Timer wake tasks due within this long of a boot run in that boot
+    // instead of their own (power::SleepManager::takeDueTasks). Each
+    // full boot costs far more than running a task a little early.
+    // Without the wake stub, tasks due this long before a cooldown end
+    // wait for the boot at its end; the cooldown itself is never cut short.
+    constexpr int64_t COALESCE_WINDOW_SECONDS = 300;
+    
+    // Shortest delay a task is queued at, so a task left due cannot turn
+    // into back-to-back boots
+    constexpr int64_t MIN_TASK_DELAY_SECONDS = 60;
+    
+    // After a failed run (uplink down) a task waits this long, doubled per
+    // further failure up to the cap; a successful run resets it
+    constexpr int64_t FAILURE_BACKOFF_SECONDS = 300;
+    constexpr int64_t FAILURE_BACKOFF_MAX_SECONDS = 6 * 3600;
+    
+} // namespace wake
+
+// =============================================================================
+// Crop Monitoring Configuration
+// =============================================================================
+namespace farm {
+    // Scheduled crop photo to Telegram (0 = off)
+    constexpr int64_t CROP_PHOTO_INTERVAL_SECONDS = 0;
+    
+    // Capacitive soil-moisture probe on an ADC1 pin (-1 = not fitted)
+    constexpr int SOIL_ADC_GPIO = -1;
+    constexpr int64_t SOIL_SAMPLE_INTERVAL_SECONDS = 3600;
+    constexpr int SOIL_SAMPLES = 8;
+    
+    // Probe calibration: raw reading in air (0 %) and in water (100 %)
+    constexpr int SOIL_RAW_DRY = 3000;
+    constexpr int SOIL_RAW_WET = 1300;
+    
+    // Power the probe from a GPIO only while sampling (-1 = always on)
+    constexpr int SOIL_POWER_GPIO = -1;
+    constexpr int SOIL_SETTLE_MS = 20;
+    
+} // namespace farm
+
 // =============================================================================
 // Debug Configuration
 // =============================================================================
 namespace debug {
-    // Enable verbose logging
+    // Console logging on every wake. false (production): log lines go to
+    // an RTC ring buffer instead, written out before an error line, after
+    // a crash reset, or on /logs (diagnostics::LogBuffer); errors and
+    // warnings still reach the console. Also drops the pre-sleep flush delay.
     constexpr bool VERBOSE_LOGGING = true;
     
+    // Ring buffer for buffered logging (bytes of RTC memory; oldest
+    // lines are overwritten)
+    constexpr size_t LOG_BUFFER_SIZE = 2048;
+    static_assert(LOG_BUFFER_SIZE <= 4096, "/logs sends the buffer as one Telegram message");
+    
     // Save debug images to SD card
     constexpr bool SAVE_DEBUG_IMAGES = false;
-    
+
 } // namespace debug
 
+// =============================================================================
+// Profiling Configuration
+// =============================================================================
+namespace profiling {
+    // Number of wake records kept in RTC memory (ring buffer)
+    constexpr size_t HISTORY_DEPTH = 8;
+
+    // Dump the wake history to serial at the start of each PIR wake
+    constexpr bool DUMP_HISTORY_ON_WAKE = true;
+
+    // Append the previous wake's timing summary to Telegram alerts
+    constexpr bool REPORT_IN_TELEGRAM = true;
+
+} // namespace profiling
+
+// =============================================================================
+// Energy Accounting Configuration
+// =============================================================================
+// Current model for diagnostics::EnergyMeter. The defaults are estimates
+// for the Freenove ESP32-S3 board with an HC-SR501; measure the board
+// once (USB power meter or shunt) and replace them.
+namespace energy {
+    // ROM + bootloader until app_main() (mA)
+    constexpr float BOOT_MA = 40.0f;
+    
+    // Awake baseline: CPU at 240 MHz, PSRAM, regulators (mA)
+    constexpr float ACTIVE_BASE_MA = 60.0f;
+    
+    // Added to the baseline while the part is in use (mA)
+    constexpr float CAMERA_MA = 45.0f;          // From camera init to shutdown
+    constexpr float SD_MA = 35.0f;              // SD mount and event log writes
+    constexpr float SECOND_CORE_MA = 25.0f;     // Model load on core 1
+    constexpr float WIFI_MA = 120.0f;           // Association and uploads
+    
+    // Each wake the RTC wake stub sends back to sleep (µA·s, ~1 ms at 20 mA)
+    constexpr float STUB_WAKE_UAS = 20.0f;
+    
+    // Sleep currents (mA)
+    constexpr float DEEP_SLEEP_ARMED_MA = 0.20f;    // RTC IO wake + PIR module
+    constexpr float DEEP_SLEEP_TIMER_MA = 0.05f;    // Timer only (cooldown without stub)
+    constexpr float LIGHT_SLEEP_MA = 2.5f;          // Watch mode, camera standby, WiFi parked
+    
+    // Telegram health message period (0 = never)
+    constexpr int64_t REPORT_INTERVAL_SECONDS = 86400;  // 24 hours
+    
+    // Next attempt after a report that was not delivered (window kept open)
+    constexpr int64_t REPORT_RETRY_SECONDS = 3600;
+    
+    // Battery voltage divider on an ADC1 pin (-1 = not fitted)
+    constexpr int BATTERY_ADC_GPIO = -1;
+    constexpr float BATTERY_DIVIDER_RATIO = 2.0f;   // Battery mV per ADC mV
+    constexpr int BATTERY_SAMPLES = 8;
+    
+} // namespace energy
+
 } // namespace config
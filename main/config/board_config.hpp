@@ -69,21 +69,35 @@ namespace camera {
 } // namespace camera
 
 // =============================================================================
-// SD Card Pin Configuration (1-bit SDMMC Mode)
+// SD Card Pin Configuration (SDMMC, 1-bit or 4-bit)
 // =============================================================================
 namespace sdcard {
     constexpr int PIN_CLK    = 39;   // SD Clock
     constexpr int PIN_CMD    = 38;   // SD Command
     constexpr int PIN_D0     = 40;   // SD Data 0
     
+    // D1-D3 are not routed on the Freenove board (-1). Boards that wire
+    // them get the 4-bit bus automatically.
+    constexpr int PIN_D1     = -1;   // SD Data 1
+    constexpr int PIN_D2     = -1;   // SD Data 2
+    constexpr int PIN_D3     = -1;   // SD Data 3 / CD
+    
+    constexpr int BUS_WIDTH = (PIN_D1 >= 0 && PIN_D2 >= 0 && PIN_D3 >= 0) ? 4 : 1;
+    
+    // 40 MHz high-speed clock (falls back to 20 MHz if the card refuses)
+    constexpr bool HIGH_SPEED = true;
+    
     // Mount point in VFS
     constexpr const char* MOUNT_POINT = "/sdcard";
     
-    // Array of all SD pins for bulk operations
+    // Array of all SD pins for bulk operations (unrouted pins are GPIO_NUM_NC)
     constexpr gpio_num_t PINS[] = {
         static_cast<gpio_num_t>(PIN_CLK),
         static_cast<gpio_num_t>(PIN_CMD),
-        static_cast<gpio_num_t>(PIN_D0)
+        static_cast<gpio_num_t>(PIN_D0),
+        static_cast<gpio_num_t>(PIN_D1),
+        static_cast<gpio_num_t>(PIN_D2),
+        static_cast<gpio_num_t>(PIN_D3)
     };
     constexpr size_t PINS_COUNT = sizeof(PINS) / sizeof(PINS[0]);
     
@@ -0,0 +1,312 @@
+/**
+ * @file runtime_config.cpp
+ * @brief Per-device settings store implementation
+ */
+
+#include "runtime_config.hpp"
+#include "app_config.hpp"
+
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+static const char* TAG = "RuntimeConfig";
+
+// Current values and override mask, cached across deep sleep
+RTC_DATA_ATTR static int32_t s_values[config::SETTING_COUNT];
+RTC_DATA_ATTR static uint32_t s_overrides = 0;
+RTC_DATA_ATTR static bool s_loaded = false;
+
+namespace config {
+
+namespace {
+
+enum class ValueType : uint8_t {
+    INT,
+    BOOL,
+    MILLI               // Fraction stored in thousandths
+};
+
+struct SettingInfo {
+    const char* name;   // NVS key (< RuntimeConfig::NAME_MAX)
+    ValueType type;
+    int32_t defaultValue;
+    int32_t minValue;
+    int32_t maxValue;
+};
+
+constexpr int32_t toMilli(float value) {
+    return static_cast<int32_t>(value * 1000.0f + 0.5f);
+}
+
+// Indexed by Setting
+constexpr SettingInfo SETTINGS[SETTING_COUNT] = {
+    {"armed", ValueType::BOOL, 1, 0, 1},
+    {"cooldown_s", ValueType::INT, static_cast<int32_t>(timing::COOLDOWN_SECONDS),
+     static_cast<int32_t>(commands::MIN_COOLDOWN_SECONDS),
+     static_cast<int32_t>(commands::MAX_COOLDOWN_SECONDS)},
+    {"warmup_frames", ValueType::INT, timing::CAMERA_WARMUP_FRAMES, 3, 60},
+    {"stable_frames", ValueType::INT, timing::CAMERA_WARMUP_STABLE_FRAMES, 1, 10},
+    {"jpeg_quality", ValueType::INT, camera::JPEG_QUALITY, 4, 63},
+    {"fb_count", ValueType::INT, camera::FB_COUNT, camera::ALERT_BURST_FRAMES, 4},
+    {"min_conf", ValueType::MILLI, toMilli(detection::MIN_CONFIDENCE), 50, 990},
+    {"wifi_timeout_ms", ValueType::INT, timing::WIFI_TIMEOUT_MS, 3000, 60000},
+    {"http_timeout_ms", ValueType::INT, timing::HTTP_TIMEOUT_MS,
+     commands::POLL_TIMEOUT_SECONDS * 1000 + commands::POLL_READ_MARGIN_MS, 120000},
+    {"watch_idle_s", ValueType::INT, static_cast<int32_t>(watch::IDLE_TIMEOUT_SECONDS), 30, 3600},
+    {"poll_s", ValueType::INT, static_cast<int32_t>(commands::POLL_INTERVAL_SECONDS), 300, 86400},
+};
+
+static_assert(SETTING_COUNT <= 32, "Override mask is 32 bits");
+
+constexpr bool defaultsInRange(size_t index = 0) {
+    return index == SETTING_COUNT ||
+           (SETTINGS[index].defaultValue >= SETTINGS[index].minValue &&
+            SETTINGS[index].defaultValue <= SETTINGS[index].maxValue &&
+            defaultsInRange(index + 1));
+}
+static_assert(defaultsInRange(), "app_config.hpp default outside its runtime range");
+
+const SettingInfo& info(Setting setting) {
+    size_t index = static_cast<size_t>(setting);
+    return SETTINGS[(index < SETTING_COUNT) ? index : 0];
+}
+
+bool inRange(const SettingInfo& entry, int32_t value) {
+    return value >= entry.minValue && value <= entry.maxValue;
+}
+
+esp_err_t openNvs(nvs_open_mode_t mode, nvs_handle_t& handle) {
+    // No-op once WifiManager (or an earlier call) has initialized NVS
+    esp_err_t err = nvs_flash_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+    return nvs_open(settings::NVS_NAMESPACE, mode, &handle);
+}
+
+void ensureLoaded() {
+    if (!s_loaded) {
+        RuntimeConfig::refresh();
+    }
+}
+
+bool parseValue(const SettingInfo& entry, const char* text, int32_t& value) {
+    if (entry.type == ValueType::BOOL) {
+        if (strcasecmp(text, "on") == 0 || strcasecmp(text, "true") == 0 ||
+            std::strcmp(text, "1") == 0) {
+            value = 1;
+            return true;
+        }
+        if (strcasecmp(text, "off") == 0 || strcasecmp(text, "false") == 0 ||
+            std::strcmp(text, "0") == 0) {
+            value = 0;
+            return true;
+        }
+        return false;
+    }
+
+    char* end = nullptr;
+    if (entry.type == ValueType::MILLI) {
+        float number = std::strtof(text, &end);
+        value = static_cast<int32_t>(std::lround(number * 1000.0f));
+    } else {
+        value = static_cast<int32_t>(std::strtol(text, &end, 10));
+    }
+    return end != text && *end == '\0';
+}
+
+size_t formatValue(const SettingInfo& entry, int32_t value, char* buffer, size_t bufferLen) {
+    int n = 0;
+    switch (entry.type) {
+        case ValueType::BOOL:
+            n = std::snprintf(buffer, bufferLen, "%s", value ? "on" : "off");
+            break;
+        case ValueType::MILLI:
+            n = std::snprintf(buffer, bufferLen, "%.3f", value / 1000.0f);
+            break;
+        case ValueType::INT:
+        default:
+            n = std::snprintf(buffer, bufferLen, "%ld", static_cast<long>(value));
+            break;
+    }
+    return (n > 0) ? static_cast<size_t>(n) : 0;
+}
+
+} // namespace
+
+void RuntimeConfig::refresh() {
+    for (size_t i = 0; i < SETTING_COUNT; i++) {
+        s_values[i] = SETTINGS[i].defaultValue;
+    }
+    s_overrides = 0;
+
+    nvs_handle_t handle;
+    if (openNvs(NVS_READONLY, handle) == ESP_OK) {
+        for (size_t i = 0; i < SETTING_COUNT; i++) {
+            int32_t value = 0;
+            if (nvs_get_i32(handle, SETTINGS[i].name, &value) != ESP_OK) {
+                continue;
+            }
+            if (!inRange(SETTINGS[i], value)) {
+                ESP_LOGW(TAG, "Ignoring %s = %ld (range %ld..%ld)", SETTINGS[i].name,
+                         static_cast<long>(value), static_cast<long>(SETTINGS[i].minValue),
+                         static_cast<long>(SETTINGS[i].maxValue));
+                continue;
+            }
+            s_values[i] = value;
+            s_overrides |= 1u << i;
+        }
+        nvs_close(handle);
+    }
+    s_loaded = true;
+    ESP_LOGI(TAG, "Settings loaded (%d overridden)", __builtin_popcount(s_overrides));
+}
+
+int32_t RuntimeConfig::get(Setting setting) {
+    ensureLoaded();
+    size_t index = static_cast<size_t>(setting);
+    return (index < SETTING_COUNT) ? s_values[index] : 0;
+}
+
+float RuntimeConfig::getFloat(Setting setting) {
+    int32_t value = get(setting);
+    return (info(setting).type == ValueType::MILLI) ? value / 1000.0f
+                                                     : static_cast<float>(value);
+}
+
+esp_err_t RuntimeConfig::set(Setting setting, int32_t value) {
+    size_t index = static_cast<size_t>(setting);
+    if (index >= SETTING_COUNT || !inRange(SETTINGS[index], value)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ensureLoaded();
+
+    nvs_handle_t handle;
+    esp_err_t err = openNvs(NVS_READWRITE, handle);
+    if (err == ESP_OK) {
+        err = nvs_set_i32(handle, SETTINGS[index].name, value);
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to store %s: %s", SETTINGS[index].name, esp_err_to_name(err));
+        return err;
+    }
+
+    s_values[index] = value;
+    s_overrides |= 1u << index;
+    ESP_LOGI(TAG, "%s = %ld", SETTINGS[index].name, static_cast<long>(value));
+    return ESP_OK;
+}
+
+esp_err_t RuntimeConfig::set(const char* name, const char* value) {
+    Setting setting;
+    if (!find(name, setting)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    int32_t parsed = 0;
+    if (!parseValue(info(setting), value, parsed)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return set(setting, parsed);
+}
+
+esp_err_t RuntimeConfig::clear(const char* name) {
+    Setting setting;
+    if (!find(name, setting)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    ensureLoaded();
+    const size_t index = static_cast<size_t>(setting);
+
+    nvs_handle_t handle;
+    esp_err_t err = openNvs(NVS_READWRITE, handle);
+    if (err == ESP_OK) {
+        err = nvs_erase_key(handle, SETTINGS[index].name);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            err = ESP_OK;
+        }
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to clear %s: %s", SETTINGS[index].name, esp_err_to_name(err));
+        return err;
+    }
+
+    s_values[index] = SETTINGS[index].defaultValue;
+    s_overrides &= ~(1u << index);
+    ESP_LOGI(TAG, "%s back to default", SETTINGS[index].name);
+    return ESP_OK;
+}
+
+bool RuntimeConfig::isOverridden(Setting setting) {
+    ensureLoaded();
+    size_t index = static_cast<size_t>(setting);
+    return index < SETTING_COUNT && (s_overrides & (1u << index)) != 0;
+}
+
+const char* RuntimeConfig::name(Setting setting) {
+    return info(setting).name;
+}
+
+bool RuntimeConfig::find(const char* name, Setting& setting) {
+    for (size_t i = 0; i < SETTING_COUNT; i++) {
+        if (strcasecmp(SETTINGS[i].name, name) == 0) {
+            setting = static_cast<Setting>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t RuntimeConfig::format(Setting setting, char* buffer, size_t bufferLen) {
+    if (!buffer || bufferLen == 0) {
+        return 0;
+    }
+    const SettingInfo& entry = info(setting);
+    char value[16];
+    char minValue[16];
+    char maxValue[16];
+    formatValue(entry, get(setting), value, sizeof(value));
+    formatValue(entry, entry.minValue, minValue, sizeof(minValue));
+    formatValue(entry, entry.maxValue, maxValue, sizeof(maxValue));
+
+    int n = std::snprintf(buffer, bufferLen, "%s = %s%s (%s..%s)", entry.name, value,
+                          isOverridden(setting) ? "*" : "", minValue, maxValue);
+    if (n < 0) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    return (static_cast<size_t>(n) < bufferLen) ? static_cast<size_t>(n) : bufferLen - 1;
+}
+
+size_t RuntimeConfig::formatAll(char* buffer, size_t bufferLen) {
+    if (!buffer || bufferLen == 0) {
+        return 0;
+    }
+    size_t len = 0;
+    buffer[0] = '\0';
+    for (size_t i = 0; i < SETTING_COUNT && len + 1 < bufferLen; i++) {
+        if (i > 0) {
+            buffer[len++] = '\n';
+            buffer[len] = '\0';
+        }
+        len += format(static_cast<Setting>(i), buffer + len, bufferLen - len);
+    }
+    return len;
+}
+
+} // namespace config
@@ -0,0 +1,135 @@
+#pragma once
+
+/**
+ * @file runtime_config.hpp
+ * @brief Per-device settings stored in NVS
+ *
+ * Provides:
+ * - Typed settings whose defaults are the app_config.hpp constants
+ * - Per-device overrides in NVS (config::settings::NVS_NAMESPACE, one i32
+ *   key per setting), cached in RTC memory so a wake reads them for free
+ * - Range-checked updates by name (Telegram /set, /unset)
+ *
+ * Overrides can also be provisioned with an NVS partition image
+ * (nvs_partition_gen.py, type i32, keys as in name()). Values the table
+ * rejects are ignored and the default applies.
+ */
+
+#include "esp_err.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace config {
+
+/**
+ * @brief Runtime settings (NVS key in parentheses)
+ */
+enum class Setting : uint8_t {
+    ARMED,                      // PIR wake-up enabled, 0/1 ("armed")
+    COOLDOWN_SECONDS,           // timing::COOLDOWN_SECONDS ("cooldown_s")
+    WARMUP_FRAMES,              // timing::CAMERA_WARMUP_FRAMES ("warmup_frames")
+    WARMUP_STABLE_FRAMES,       // timing::CAMERA_WARMUP_STABLE_FRAMES ("stable_frames")
+    JPEG_QUALITY,               // camera::JPEG_QUALITY ("jpeg_quality")
+    FB_COUNT,                   // camera::FB_COUNT ("fb_count")
+    MIN_CONFIDENCE,             // detection::MIN_CONFIDENCE ("min_conf")
+    WIFI_TIMEOUT_MS,            // timing::WIFI_TIMEOUT_MS ("wifi_timeout_ms")
+    HTTP_TIMEOUT_MS,            // timing::HTTP_TIMEOUT_MS ("http_timeout_ms")
+    WATCH_IDLE_SECONDS,         // watch::IDLE_TIMEOUT_SECONDS ("watch_idle_s")
+    COMMAND_POLL_SECONDS,       // commands::POLL_INTERVAL_SECONDS ("poll_s")
+    COUNT
+};
+
+constexpr size_t SETTING_COUNT = static_cast<size_t>(Setting::COUNT);
+
+/**
+ * @brief Runtime settings store (static, RTC resident)
+ *
+ * @code
+ *   int quality = RuntimeConfig::get(Setting::JPEG_QUALITY);
+ *   float threshold = RuntimeConfig::getFloat(Setting::MIN_CONFIDENCE);
+ *   RuntimeConfig::set(Setting::COOLDOWN_SECONDS, 1800);   // Persisted
+ * @endcode
+ */
+class RuntimeConfig {
+public:
+    static constexpr size_t NAME_MAX = 16;      // NVS key limit, with terminator
+
+    /**
+     * @brief Re-read the overrides from NVS into the RTC cache
+     *
+     * Called on power-on; later wakes use the cached values.
+     */
+    static void refresh();
+
+    /**
+     * @brief Value of an integer or on/off setting
+     */
+    static int32_t get(Setting setting);
+
+    /**
+     * @brief Value of an on/off setting
+     */
+    static bool getBool(Setting setting) { return get(setting) != 0; }
+
+    /**
+     * @brief Value of a fractional setting (e.g. MIN_CONFIDENCE)
+     */
+    static float getFloat(Setting setting);
+
+    /**
+     * @brief Store an override in NVS and the cache
+     *
+     * @param value Integer value, 0/1, or thousandths for fractional settings
+     *
+     * @return esp_err_t ESP_OK, ESP_ERR_INVALID_ARG if out of range, or the NVS error
+     */
+    static esp_err_t set(Setting setting, int32_t value);
+
+    /**
+     * @brief Parse a value ("12", "0.65", "on") and store it
+     *
+     * @return esp_err_t ESP_OK, ESP_ERR_NOT_FOUND for an unknown name,
+     *         ESP_ERR_INVALID_ARG for a bad or out-of-range value, or the NVS error
+     */
+    static esp_err_t set(const char* name, const char* value);
+
+    /**
+     * @brief Drop an override (the default applies again)
+     *
+     * @return esp_err_t ESP_OK, ESP_ERR_NOT_FOUND for an unknown name, or the NVS error
+     */
+    static esp_err_t clear(const char* name);
+
+    /**
+     * @brief Check whether a setting is overridden on this device
+     */
+    static bool isOverridden(Setting setting);
+
+    /**
+     * @brief Setting name (also its NVS key)
+     */
+    static const char* name(Setting setting);
+
+    /**
+     * @brief Find a setting by name
+     *
+     * @return true if found
+     */
+    static bool find(const char* name, Setting& setting);
+
+    /**
+     * @brief Format one setting ("name = value (range)", '*' marks an override)
+     *
+     * @return size_t Number of characters written (excluding terminator)
+     */
+    static size_t format(Setting setting, char* buffer, size_t bufferLen);
+
+    /**
+     * @brief Format all settings, one per line
+     *
+     * @return size_t Number of characters written (excluding terminator)
+     */
+    static size_t formatAll(char* buffer, size_t bufferLen);
+};
+
+} // namespace config
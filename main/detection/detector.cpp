@@ -5,38 +5,247 @@
 
 #include "detector.hpp"
 #include "app_config.hpp"
+#include "runtime_config.hpp"
+#include "stage_profiler.hpp"
+#include "jpeg_decoder.hpp"
+#include "psram_arena.hpp"
+#include "model_slots.hpp"
 
 #include "esp_log.h"
 #include "esp_heap_caps.h"
 
 // ESP-DL headers
 #include "dl_image_jpeg.hpp"
+#include "dl_model_base.hpp"
 #include "detect.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 
 static const char* TAG = "Detector";
 
 namespace detection {
 
+namespace {
+
+using config::detection::ZONES;
+using config::detection::ZONE_COUNT;
+
+// Smallest crop worth a model pass (decoded pixels)
+constexpr int MIN_CROP_SIZE = 16;
+
+// Overlap at which boxes from overlapping zone crops are the same object
+constexpr float CROSS_ZONE_NMS_IOU = 0.5f;
+
+/**
+ * @brief Check whether a point (frame coordinates) lies in an ignore zone
+ */
+bool inIgnoreZone(int px, int py, int frameWidth, int frameHeight) {
+    if (frameWidth <= 0 || frameHeight <= 0) {
+        return false;
+    }
+    // Zones are in detection-frame coordinates
+    px = px * config::detection::ZONE_FRAME_WIDTH / frameWidth;
+    py = py * config::detection::ZONE_FRAME_HEIGHT / frameHeight;
+    for (size_t i = 0; i < ZONE_COUNT; i++) {
+        const auto& z = ZONES[i];
+        if (z.ignore && px >= z.x && px < z.x + z.width &&
+            py >= z.y && py < z.y + z.height) {
+            return true;
+        }
+    }
+    return false;
+}
+
+float boxIou(const Detection& a, const Detection& b) {
+    int x1 = std::max(a.x, b.x);
+    int y1 = std::max(a.y, b.y);
+    int x2 = std::min(a.x + a.width, b.x + b.width);
+    int y2 = std::min(a.y + a.height, b.y + b.height);
+    if (x2 <= x1 || y2 <= y1) {
+        return 0.0f;
+    }
+    float inter = static_cast<float>(x2 - x1) * static_cast<float>(y2 - y1);
+    float uni = static_cast<float>(a.width) * a.height +
+                static_cast<float>(b.width) * b.height - inter;
+    return (uni > 0.0f) ? inter / uni : 0.0f;
+}
+
+/**
+ * @brief Add a box to the fixed-capacity list
+ *
+ * A box overlapping one of the same class (seen through another zone
+ * crop) keeps the higher score; a full list drops its weakest box.
+ */
+void addBox(DetectionResult& result, const Detection& box) {
+    Detection* slot = nullptr;
+    for (size_t i = 0; i < result.count; i++) {
+        if (result.boxes[i].category == box.category &&
+            boxIou(result.boxes[i], box) >= CROSS_ZONE_NMS_IOU) {
+            slot = &result.boxes[i];
+            break;
+        }
+    }
+    if (!slot && result.count < config::detection::MAX_DETECTIONS) {
+        slot = &result.boxes[result.count++];
+        slot->score = -1.0f;
+    }
+    if (!slot) {
+        slot = std::min_element(result.boxes, result.boxes + result.count,
+                                [](const Detection& a, const Detection& b) {
+                                    return a.score < b.score;
+                                });
+    }
+    if (box.score > slot->score) {
+        *slot = box;
+    }
+}
+
+} // namespace
+
+size_t countCategory(const DetectionResult& result, int category) {
+    size_t n = 0;
+    for (size_t i = 0; i < result.count; i++) {
+        if (result.boxes[i].category == category) {
+            n++;
+        }
+    }
+    return n;
+}
+
+const char* categoryName(int category) {
+    constexpr size_t count = sizeof(config::detection::CATEGORY_NAMES) /
+                             sizeof(config::detection::CATEGORY_NAMES[0]);
+    if (category < 0 || static_cast<size_t>(category) >= count) {
+        return "object";
+    }
+    return config::detection::CATEGORY_NAMES[category];
+}
+
+const char* zoneName(int zone) {
+    if (zone < 0 || static_cast<size_t>(zone) >= ZONE_COUNT) {
+        return "frame";
+    }
+    return ZONES[zone].name;
+}
+
+ZoneRect mapZone(const config::detection::Zone& zone, int frameWidth, int frameHeight,
+                 int scaleShift) {
+    using config::detection::ZONE_FRAME_WIDTH;
+    using config::detection::ZONE_FRAME_HEIGHT;
+    
+    // Detection-frame coordinates to frame pixels, then to decoded pixels
+    const int x0 = zone.x * frameWidth / ZONE_FRAME_WIDTH;
+    const int y0 = zone.y * frameHeight / ZONE_FRAME_HEIGHT;
+    const int x1 = (zone.x + zone.width) * frameWidth / ZONE_FRAME_WIDTH;
+    const int y1 = (zone.y + zone.height) * frameHeight / ZONE_FRAME_HEIGHT;
+    
+    ZoneRect rect = {};
+    rect.x0 = std::max(0, x0) >> scaleShift;
+    rect.y0 = std::max(0, y0) >> scaleShift;
+    rect.x1 = std::min(frameWidth, x1) >> scaleShift;
+    rect.y1 = std::min(frameHeight, y1) >> scaleShift;
+    return rect;
+}
+
 Detector::Detector()
     : m_model(nullptr)
+    , m_loadMutex(xSemaphoreCreateMutex())
+    , m_inputWidth(config::detection::MODEL_INPUT_WIDTH)
+    , m_inputHeight(config::detection::MODEL_INPUT_HEIGHT)
 {
 }
 
 Detector::~Detector() {
-    // Model cleanup is handled by unique_ptr in detect()
+    // Waits on the load mutex, so a background load finishes first
+    unloadModel();
+    
+    if (m_loadMutex) {
+        vSemaphoreDelete(m_loadMutex);
+    }
+}
+
+esp_err_t Detector::loadModel() {
+    xSemaphoreTake(m_loadMutex, portMAX_DELAY);
+    
+    if (m_model) {
+        xSemaphoreGive(m_loadMutex);
+        return ESP_OK;
+    }
+    
+    auto& profiler = diagnostics::StageProfiler::instance();
+    profiler.start(diagnostics::Stage::MODEL_LOAD);
+    
+    size_t freeBefore = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    
+    esp_err_t err = ESP_OK;
+    for (;;) {
+        // A freshly updated slot counts this attempt before it can crash
+        ModelSlots::beginLoad();
+        const bool onTrial = ModelSlots::isOnTrial();
+        
+        // Eager load: builds dl::Model, minimize(), preprocessor, postprocessor
+        // from whichever A/B model slot is active
+        std::unique_ptr<Detect> model(
+            new (std::nothrow) Detect(Detect::PICO_S8_V1, false, ModelSlots::activeLabel()));
+        
+        err = ESP_OK;
+        if (!model) {
+            ESP_LOGE(TAG, "Failed to allocate model");
+            err = ESP_ERR_NO_MEM;
+        } else {
+            // Take the real input size from the model's input tensor [N, H, W, C]
+            dl::Model* raw = model->get_raw_model(0);
+            if (!raw || raw->get_inputs().empty()) {
+                ESP_LOGE(TAG, "Model in slot %s has no input", ModelSlots::activeLabel());
+                err = ESP_FAIL;
+            } else {
+                const auto& shape = raw->get_inputs().begin()->second->shape;
+                if (shape.size() == 4) {
+                    m_inputHeight = shape[1];
+                    m_inputWidth = shape[2];
+                }
+                m_model = std::move(model);
+            }
+        }
+        
+        if (err == ESP_OK) {
+            ModelSlots::confirm();
+            break;
+        }
+        // Out of memory says nothing about the image; anything else on trial
+        // restores the previous slot and loads from it
+        if (!onTrial || err == ESP_ERR_NO_MEM || ModelSlots::revert() != ESP_OK) {
+            break;
+        }
+    }
+    
+    profiler.stop(diagnostics::Stage::MODEL_LOAD);
+    
+    if (err == ESP_OK) {
+        const size_t modelBytes = freeBefore - heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+        ESP_LOGI(TAG, "Model loaded: input %dx%d, %zu bytes PSRAM",
+                 m_inputWidth, m_inputHeight, modelBytes);
+        if (modelBytes > config::arena::MODEL_BUDGET_BYTES) {
+            ESP_LOGW(TAG, "Model exceeds its %zu byte budget (config::arena)",
+                     config::arena::MODEL_BUDGET_BYTES);
+        }
+    }
+    
+    xSemaphoreGive(m_loadMutex);
+    return err;
+}
+
+void Detector::unloadModel() {
+    xSemaphoreTake(m_loadMutex, portMAX_DELAY);
+    m_model.reset();
+    xSemaphoreGive(m_loadMutex);
 }
 
 DetectionResult Detector::detect(camera_fb_t* frame) {
-    DetectionResult result = {
-        .detected = false,
-        .confidence = 0.0f,
-        .x = 0,
-        .y = 0,
-        .width = 0,
-        .height = 0
-    };
+    DetectionResult result = {};
+    result.zone = -1;
     
     if (!frame || !frame->buf || frame->len == 0) {
         ESP_LOGE(TAG, "Invalid frame buffer");
@@ -46,59 +255,208 @@ DetectionResult Detector::detect(camera_fb_t* frame) {
     ESP_LOGI(TAG, "Processing frame: %zu bytes, %dx%d",
              frame->len, frame->width, frame->height);
     
-    // Decode JPEG to RGB888
-    dl::image::jpeg_img_t jpegImg = {
-        .data = frame->buf,
-        .data_len = frame->len
-    };
-    
-    auto img = dl::image::sw_decode_jpeg(jpegImg, dl::image::DL_IMAGE_PIX_TYPE_RGB888);
-    
-    if (!img.data) {
-        ESP_LOGE(TAG, "JPEG decode failed");
+    // Use the resident model (blocks while a background load is running)
+    esp_err_t err = loadModel();
+    if (err != ESP_OK || !m_model) {
+        ESP_LOGE(TAG, "Model unavailable: %s", esp_err_to_name(err));
         return result;
     }
     
-    ESP_LOGI(TAG, "Decoded to RGB888: %dx%d, %zu bytes",
-             img.width, img.height, 
-             static_cast<size_t>(img.width * img.height * 3));
+    // Convert frame to RGB565 at (close to) model input resolution
+    auto& profiler = diagnostics::StageProfiler::instance();
+    profiler.start(diagnostics::Stage::JPEG_DECODE);
     
-    // Create detector and run inference
-    // Using unique_ptr for automatic cleanup
-    auto detector = std::make_unique<Detect>();
+    dl::image::img_t img = {};
+    int scaleShift = 0;
+    bool ownsImage = false;
+    err = prepareImage(frame, img, scaleShift, ownsImage);
+    profiler.stop(diagnostics::Stage::JPEG_DECODE);
     
-    auto& detections = detector->run(img);
+    if (err != ESP_OK || !img.data) {
+        ESP_LOGE(TAG, "Frame conversion failed");
+        return result;
+    }
     
-    // Process results
-    if (!detections.empty()) {
-        // Get the first (highest confidence) detection
-        const auto& det = detections.front();
-        
+    // One model pass per watched zone; the whole frame when none is set
+    bool watched = false;
+    for (size_t i = 0; i < ZONE_COUNT; i++) {
+        if (!ZONES[i].ignore) {
+            inferRegion(img, static_cast<int>(i), scaleShift, result);
+            watched = true;
+        }
+    }
+    if (!watched) {
+        inferRegion(img, -1, scaleShift, result);
+    }
+    
+    if (result.count > 0) {
+        // Best first; the top-level fields mirror boxes[0]
+        std::sort(result.boxes, result.boxes + result.count,
+                  [](const Detection& a, const Detection& b) { return a.score > b.score; });
+        const Detection& best = result.boxes[0];
         result.detected = true;
-        result.confidence = det.score;
+        result.confidence = best.score;
+        result.x = best.x;
+        result.y = best.y;
+        result.width = best.width;
+        result.height = best.height;
+        result.zone = best.zone;
+        result.category = best.category;
         
-        // Extract bounding box if available
-        if (det.box.size() >= 4) {
-            result.x = static_cast<int>(det.box[0]);
-            result.y = static_cast<int>(det.box[1]);
-            result.width = static_cast<int>(det.box[2] - det.box[0]);
-            result.height = static_cast<int>(det.box[3] - det.box[1]);
+        ESP_LOGI(TAG, "✓ OBJECT DETECTED! %u box(es), best %.3f (zone %s)",
+                 static_cast<unsigned>(result.count), result.confidence,
+                 zoneName(result.zone));
+        for (size_t i = 0; i < result.count; i++) {
+            const Detection& box = result.boxes[i];
+            ESP_LOGI(TAG, "  %s %.3f: (%d, %d) %dx%d zone %s",
+                     categoryName(box.category), box.score,
+                     box.x, box.y, box.width, box.height, zoneName(box.zone));
         }
-        
-        ESP_LOGI(TAG, "✓ OBJECT DETECTED! Confidence: %.3f", result.confidence);
-        ESP_LOGI(TAG, "  Bounding box: (%d, %d) %dx%d",
-                 result.x, result.y, result.width, result.height);
     } else {
         ESP_LOGI(TAG, "No object detected");
     }
     
-    // Clean up decoded image buffer
-    // Note: dl::image allocates using heap_caps_malloc with SPIRAM
-    if (img.data) {
-        heap_caps_free(img.data);
+    // Decoded image back to the arena (raw frames belong to the camera;
+    // a full-resolution fallback decode goes back to the heap)
+    if (ownsImage) {
+        PsramArena::release(img.data);
     }
     
     return result;
 }
 
+esp_err_t Detector::prepareImage(camera_fb_t* frame, dl::image::img_t& img,
+                                 int& scaleShift, bool& ownsImage) {
+    scaleShift = 0;
+    
+    // Raw RGB565 frames are used in place, no decode needed
+    if (frame->format == PIXFORMAT_RGB565) {
+        img.data = frame->buf;
+        img.width = static_cast<uint16_t>(frame->width);
+        img.height = static_cast<uint16_t>(frame->height);
+        img.pix_type = dl::image::DL_IMAGE_PIX_TYPE_RGB565;
+        ownsImage = false;
+        ESP_LOGI(TAG, "Using raw RGB565 frame: %dx%d", img.width, img.height);
+        return ESP_OK;
+    }
+    
+    if (frame->format != PIXFORMAT_JPEG) {
+        ESP_LOGE(TAG, "Unsupported pixel format: %d", frame->format);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    ownsImage = true;
+    esp_err_t err = JpegDecoder::decode(frame->buf, frame->len,
+                                        frame->width, frame->height,
+                                        m_inputWidth, m_inputHeight,
+                                        img, scaleShift);
+    if (err != ESP_OK && err != ESP_ERR_NO_MEM) {
+        // Fall back to a full-resolution decode
+        ESP_LOGW(TAG, "Scaled decode failed, using full-resolution decode");
+        dl::image::jpeg_img_t jpegImg = {
+            .data = frame->buf,
+            .data_len = frame->len
+        };
+#if CONFIG_IDF_TARGET_ESP32P4
+        img = dl::image::sw_decode_jpeg(jpegImg, dl::image::DL_IMAGE_PIX_TYPE_RGB565);
+#else
+        img = dl::image::sw_decode_jpeg(jpegImg, dl::image::DL_IMAGE_PIX_TYPE_RGB565,
+                                        dl::image::DL_IMAGE_CAP_RGB565_BIG_ENDIAN);
+#endif
+        scaleShift = 0;
+        err = img.data ? ESP_OK : ESP_FAIL;
+    }
+    
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Decoded to RGB565: %dx%d (1/%d), %zu bytes",
+                 img.width, img.height, 1 << scaleShift,
+                 static_cast<size_t>(img.width * img.height * 2));
+    }
+    
+    return err;
+}
+
+void Detector::inferRegion(const dl::image::img_t& img, int zone, int scaleShift,
+                           DetectionResult& result) {
+    // Zone rectangle in decoded pixels, clipped to the image
+    const int frameWidth = img.width << scaleShift;
+    const int frameHeight = img.height << scaleShift;
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = img.width;
+    int y1 = img.height;
+    const float baseThreshold = config::RuntimeConfig::getFloat(config::Setting::MIN_CONFIDENCE);
+    float threshold = baseThreshold;
+    if (zone >= 0) {
+        const auto& z = ZONES[zone];
+        const ZoneRect rect = mapZone(z, frameWidth, frameHeight, scaleShift);
+        x0 = rect.x0;
+        y0 = rect.y0;
+        x1 = std::min<int>(img.width, rect.x1);
+        y1 = std::min<int>(img.height, rect.y1);
+        threshold = (z.minConfidence > 0.0f) ? z.minConfidence : baseThreshold;
+    }
+    if (x1 - x0 < MIN_CROP_SIZE || y1 - y0 < MIN_CROP_SIZE) {
+        ESP_LOGW(TAG, "Zone %s is outside the frame, skipped", zoneName(zone));
+        return;
+    }
+    
+    // RGB565 rows of a sub-rectangle are not contiguous: copy the crop
+    dl::image::img_t crop = img;
+    uint8_t* cropData = nullptr;
+    if (x0 != 0 || y0 != 0 || x1 != img.width || y1 != img.height) {
+        const size_t rowBytes = static_cast<size_t>(x1 - x0) * 2;
+        cropData = static_cast<uint8_t*>(
+            PsramArena::acquire(ArenaRegion::SCRATCH, rowBytes * (y1 - y0)));
+        if (!cropData) {
+            ESP_LOGE(TAG, "No memory for zone %s crop", zoneName(zone));
+            return;
+        }
+        const uint8_t* src = static_cast<const uint8_t*>(img.data);
+        for (int y = y0; y < y1; y++) {
+            std::memcpy(cropData + static_cast<size_t>(y - y0) * rowBytes,
+                        src + (static_cast<size_t>(y) * img.width + x0) * 2, rowBytes);
+        }
+        crop.data = cropData;
+        crop.width = static_cast<uint16_t>(x1 - x0);
+        crop.height = static_cast<uint16_t>(y1 - y0);
+    }
+    
+    auto& profiler = diagnostics::StageProfiler::instance();
+    profiler.start(diagnostics::Stage::INFERENCE);
+    auto& detections = m_model->run(crop);
+    profiler.stop(diagnostics::Stage::INFERENCE);
+    
+    for (const auto& det : detections) {
+        if (det.box.size() < 4) {
+            continue;
+        }
+        
+        // Back to frame coordinates: crop offset, then decode scale
+        Detection box = {};
+        box.score = det.score;
+        box.category = det.category;
+        box.x = (static_cast<int>(det.box[0]) + x0) << scaleShift;
+        box.y = (static_cast<int>(det.box[1]) + y0) << scaleShift;
+        box.width = static_cast<int>(det.box[2] - det.box[0]) << scaleShift;
+        box.height = static_cast<int>(det.box[3] - det.box[1]) << scaleShift;
+        box.zone = zone;
+        if (inIgnoreZone(box.x + box.width / 2, box.y + box.height / 2,
+                         frameWidth, frameHeight)) {
+            ESP_LOGD(TAG, "Box (%d, %d) %dx%d in ignore zone, dropped",
+                     box.x, box.y, box.width, box.height);
+            continue;
+        }
+        
+        if (box.score >= threshold) {
+            addBox(result, box);
+        } else if (result.count == 0) {
+            // Below threshold: keep the score for logging and early reject
+            result.confidence = std::max(result.confidence, box.score);
+        }
+    }
+    
+    PsramArena::release(cropData);
+}
+
 } // namespace detection
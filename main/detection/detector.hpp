@@ -5,31 +5,108 @@
  * @brief Wrapper for ESP-DL object detection model
  * 
  * Provides simplified interface for:
- * - JPEG decoding
- * - Model inference
+ * - Resident model lifetime (explicit or background loading)
+ * - JPEG decoding (or zero-copy use of raw RGB565 frames)
+ * - Model inference on per-zone crops (config::detection::ZONES)
  * - Result interpretation
  */
 
 #include "esp_err.h"
 #include "esp_camera.h"
+#include "dl_image_define.hpp"
+#include "app_config.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <memory>
 #include <vector>
 
+class Detect;
+
 namespace detection {
 
+/**
+ * @brief One post-NMS box that cleared its zone threshold
+ */
+struct Detection {
+    float score;        // Detection confidence score
+    int category;       // Model class id
+    int x;              // Bounding box (frame coordinates)
+    int y;
+    int width;
+    int height;
+    int zone;           // Index into config::detection::ZONES (-1 = whole frame)
+};
+
 /**
  * @brief Detection result structure
+ * 
+ * The top-level fields describe the best box; boxes[] holds every
+ * qualifying box, best first. Fixed capacity, no heap allocation.
  */
 struct DetectionResult {
     bool detected;      // Was an object detected?
-    float confidence;   // Detection confidence score
+    float confidence;   // Detection score (best sub-threshold score if not detected)
     int x;              // Bounding box x
     int y;              // Bounding box y
     int width;          // Bounding box width
     int height;         // Bounding box height
+    int zone;           // Index into config::detection::ZONES (-1 = whole frame)
+    int category;       // Model class id of the best box
+    size_t count;       // Valid entries in boxes
+    Detection boxes[config::detection::MAX_DETECTIONS];
+};
+
+/**
+ * @brief Count boxes of one model class
+ */
+size_t countCategory(const DetectionResult& result, int category);
+
+/**
+ * @brief Get the display name of a model class id
+ */
+const char* categoryName(int category);
+
+/**
+ * @brief Get the display name of a zone id (as in DetectionResult::zone)
+ */
+const char* zoneName(int zone);
+
+/**
+ * @brief Zone rectangle in decoded-image pixels, [x0, x1) x [y0, y1)
+ */
+struct ZoneRect {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
 };
 
+/**
+ * @brief Map a zone onto a frame of any size decoded at 1/2^scaleShift
+ *
+ * The zone is scaled from ZONE_FRAME_WIDTH x ZONE_FRAME_HEIGHT to the
+ * frame, then reduced by the decode shift and clipped to the image.
+ *
+ * @param zone        Zone in detection-frame coordinates
+ * @param frameWidth  Frame width before decoding
+ * @param frameHeight Frame height before decoding
+ * @param scaleShift  Decode reduction
+ */
+ZoneRect mapZone(const config::detection::Zone& zone, int frameWidth, int frameHeight,
+                 int scaleShift);
+
 /**
  * @brief Object detector class
+ * 
+ * The model is built once and stays resident until unloadModel() or
+ * destruction, so repeated detect() calls reuse the same dl::Model,
+ * preprocessor and postprocessor.
+ * 
+ * @code
+ *   Detector detector;
+ *   detector.loadModel();                  // Any task, e.g. a core-1 boot job
+ *   auto result = detector.detect(frame);  // Waits for a load in progress
+ * @endcode
  */
 class Detector {
 public:
@@ -40,16 +117,68 @@ public:
     Detector(const Detector&) = delete;
     Detector& operator=(const Detector&) = delete;
     
+    /**
+     * @brief Build the model in the calling task (blocking)
+     * 
+     * Safe to call from any task; does nothing if already loaded.
+     * Callers on other tasks (e.g. detect()) block until it finishes.
+     * 
+     * @return esp_err_t 
+     *         - ESP_OK on success
+     *         - ESP_ERR_NO_MEM if model construction failed
+     */
+    esp_err_t loadModel();
+    
+    /**
+     * @brief Check if the model is resident
+     */
+    bool isModelLoaded() const { return m_model != nullptr; }
+    
+    /**
+     * @brief Release the model and its buffers
+     */
+    void unloadModel();
+    
     /**
      * @brief Run detection on a camera frame
      * 
-     * @param frame Camera frame buffer (JPEG format)
-     * @return DetectionResult Detection result
+     * Loads the model first if loadModel() was not called. The frame is
+     * decoded once and the model runs on a crop of every watched zone;
+     * every box that clears its zone's threshold (and is not centred in
+     * an ignore zone) is reported, best first.
+     * 
+     * @param frame Camera frame buffer (JPEG or RGB565 format)
+     * @return DetectionResult Detection result (frame coordinates)
      */
     DetectionResult detect(camera_fb_t* frame);
 
 private:
-    void* m_model;  // Opaque pointer to model instance
+    std::unique_ptr<Detect> m_model;    // Resident model instance
+    SemaphoreHandle_t m_loadMutex;      // Serializes model construction
+    int m_inputWidth;                   // Model input size (from tensor shape)
+    int m_inputHeight;
+    
+    /**
+     * @brief Convert a camera frame into a model-ready RGB565 image
+     * 
+     * @param frame Camera frame
+     * @param[out] img Image descriptor
+     * @param[out] scaleShift Decode reduction applied (boxes are << scaleShift)
+     * @param[out] ownsImage True if img.data goes back through PsramArena::release
+     */
+    esp_err_t prepareImage(camera_fb_t* frame, dl::image::img_t& img,
+                           int& scaleShift, bool& ownsImage);
+    
+    /**
+     * @brief Run the model on one zone of the decoded image
+     * 
+     * @param img Decoded frame
+     * @param zone Zone index, or -1 for the whole image
+     * @param scaleShift Decode reduction of img (zones are in frame coordinates)
+     * @param[in,out] result Receives the qualifying boxes (unsorted)
+     */
+    void inferRegion(const dl::image::img_t& img, int zone, int scaleShift,
+                     DetectionResult& result);
 };
 
 } // namespace detection
@@ -0,0 +1,241 @@
+/**
+ * @file hw_jpeg_decoder.cpp
+ * @brief ESP32-P4 hardware JPEG decode implementation
+ */
+
+#include "hw_jpeg_decoder.hpp"
+#include "psram_arena.hpp"
+#include "app_config.hpp"
+
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#if CONFIG_IDF_TARGET_ESP32P4
+#include "driver/jpeg_decode.h"
+#include "driver/ppa.h"
+#include "esp_cache.h"
+
+#include <cstdlib>
+#include <cstring>
+
+static const char* TAG = "HwJpegDecoder";
+#endif
+
+namespace detection {
+
+#if CONFIG_IDF_TARGET_ESP32P4
+
+namespace {
+
+constexpr int DECODE_TIMEOUT_MS = 100;      // Per frame, JPEG codec
+constexpr int MCU_SIZE = 16;                // Largest MCU (4:2:0)
+
+// DMA buffers: cache-line aligned address and length
+constexpr size_t DMA_ALIGNMENT = CONFIG_CACHE_L2_CACHE_LINE_SIZE;
+
+constexpr size_t alignUp(size_t len) {
+    return (len + DMA_ALIGNMENT - 1) & ~(DMA_ALIGNMENT - 1);
+}
+
+jpeg_decoder_handle_t s_engine = nullptr;
+ppa_client_handle_t s_scaler = nullptr;
+
+// DMA-capable copy of the bitstream, grown to the largest frame seen
+uint8_t* s_input = nullptr;
+size_t s_inputSize = 0;
+
+esp_err_t openEngines() {
+    if (!s_engine) {
+        jpeg_decode_engine_cfg_t engineConfig = {};
+        engineConfig.timeout_ms = DECODE_TIMEOUT_MS;
+        esp_err_t err = jpeg_new_decoder_engine(&engineConfig, &s_engine);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "JPEG engine unavailable: %s", esp_err_to_name(err));
+            return err;
+        }
+    }
+    if (!s_scaler) {
+        ppa_client_config_t clientConfig = {};
+        clientConfig.oper_type = PPA_OPERATION_SRM;
+        clientConfig.max_pending_trans_num = 1;
+        esp_err_t err = ppa_register_client(&clientConfig, &s_scaler);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "PPA unavailable: %s", esp_err_to_name(err));
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t stageInput(const uint8_t* data, size_t len) {
+    if (len > s_inputSize) {
+        std::free(s_input);
+        s_inputSize = 0;
+        jpeg_decode_memory_alloc_cfg_t memConfig = {};
+        memConfig.buffer_direction = JPEG_DEC_ALLOC_INPUT_BUFFER;
+        s_input = static_cast<uint8_t*>(jpeg_alloc_decoder_mem(len, &memConfig, &s_inputSize));
+        if (!s_input) {
+            ESP_LOGE(TAG, "Failed to allocate %u byte input buffer", static_cast<unsigned>(len));
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    std::memcpy(s_input, data, len);
+    return ESP_OK;
+}
+
+// Write back and drop CPU cache lines over a buffer the DMA is about to
+// write, so no dirty line is evicted on top of its output later
+esp_err_t syncForDevice(void* buffer, size_t len) {
+    return esp_cache_msync(buffer, len,
+                           ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_INVALIDATE);
+}
+
+// Drop CPU cache lines over a buffer the DMA has written, before reading it
+esp_err_t syncForCpu(void* buffer, size_t len) {
+    return esp_cache_msync(buffer, len, ESP_CACHE_MSYNC_FLAG_DIR_M2C);
+}
+
+} // namespace
+
+bool HwJpegDecoder::isSupported() {
+    return config::detection::HW_JPEG_DECODE;
+}
+
+esp_err_t HwJpegDecoder::decode(const uint8_t* data, size_t dataLen,
+                                int srcWidth, int srcHeight, int scaleShift,
+                                dl::image::img_t& out) {
+    out.data = nullptr;
+    if (!data || dataLen == 0 || scaleShift < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    jpeg_decode_picture_info_t info = {};
+    esp_err_t err = jpeg_decoder_get_info(data, dataLen, &info);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (static_cast<int>(info.width) != srcWidth || static_cast<int>(info.height) != srcHeight) {
+        ESP_LOGE(TAG, "JPEG header %lux%lu does not match frame %dx%d",
+                 static_cast<unsigned long>(info.width), static_cast<unsigned long>(info.height),
+                 srcWidth, srcHeight);
+        return ESP_ERR_INVALID_ARG;
+    }
+    // The codec writes whole MCUs: a partial one would change the row stride
+    if ((srcWidth % MCU_SIZE) != 0 || (srcHeight % MCU_SIZE) != 0) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    err = openEngines();
+    if (err == ESP_OK) {
+        err = stageInput(data, dataLen);
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // Full-size decode straight into the output, or into scratch for the scaler
+    const size_t fullBytes = static_cast<size_t>(srcWidth) * srcHeight * 2;
+    const size_t fullLen = alignUp(fullBytes);
+    const ArenaRegion fullRegion = (scaleShift == 0) ? ArenaRegion::IMAGE : ArenaRegion::SCRATCH;
+    uint8_t* full = static_cast<uint8_t*>(PsramArena::acquire(fullRegion, fullLen));
+    if (!full) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // BGR element order is expected to give RGB565_LE (the software path's
+    // P4 format); not yet confirmed on hardware, see HW_JPEG_DECODE
+    jpeg_decode_cfg_t decodeConfig = {};
+    decodeConfig.output_format = JPEG_DECODE_OUT_FORMAT_RGB565;
+    decodeConfig.rgb_order = JPEG_DEC_RGB_ELEMENT_ORDER_BGR;
+    decodeConfig.conv_std = JPEG_YUV_RGB_CONV_STD_BT601;
+
+    uint32_t decodedLen = 0;
+    err = syncForDevice(full, fullLen);
+    if (err == ESP_OK) {
+        err = jpeg_decoder_process(s_engine, &decodeConfig, s_input,
+                                   static_cast<uint32_t>(dataLen), full,
+                                   static_cast<uint32_t>(fullLen), &decodedLen);
+    }
+    if (err == ESP_OK && decodedLen < fullBytes) {
+        ESP_LOGE(TAG, "Hardware decode wrote %lu of %u bytes",
+                 static_cast<unsigned long>(decodedLen), static_cast<unsigned>(fullBytes));
+        err = ESP_ERR_INVALID_SIZE;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Hardware decode failed: %s", esp_err_to_name(err));
+        PsramArena::release(full);
+        return err;
+    }
+
+    const int outWidth = srcWidth >> scaleShift;
+    const int outHeight = srcHeight >> scaleShift;
+    uint8_t* image = full;
+    if (scaleShift > 0) {
+        const size_t outLen = alignUp(static_cast<size_t>(outWidth) * outHeight * 2);
+        image = static_cast<uint8_t*>(PsramArena::acquire(ArenaRegion::IMAGE, outLen));
+        if (!image) {
+            PsramArena::release(full);
+            return ESP_ERR_NO_MEM;
+        }
+
+        ppa_srm_oper_config_t scale = {};
+        scale.in.buffer = full;
+        scale.in.pic_w = srcWidth;
+        scale.in.pic_h = srcHeight;
+        scale.in.block_w = srcWidth;
+        scale.in.block_h = srcHeight;
+        scale.in.srm_cm = PPA_SRM_COLOR_MODE_RGB565;
+        scale.out.buffer = image;
+        scale.out.buffer_size = outLen;
+        scale.out.pic_w = outWidth;
+        scale.out.pic_h = outHeight;
+        scale.out.srm_cm = PPA_SRM_COLOR_MODE_RGB565;
+        scale.rotation_angle = PPA_SRM_ROTATION_ANGLE_0;
+        scale.scale_x = 1.0f / static_cast<float>(1 << scaleShift);     // Exact in 1/16 steps
+        scale.scale_y = scale.scale_x;
+        scale.mode = PPA_TRANS_MODE_BLOCKING;
+
+        err = syncForDevice(image, outLen);
+        if (err == ESP_OK) {
+            err = ppa_do_scale_rotate_mirror(s_scaler, &scale);
+        }
+        PsramArena::release(full);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "PPA scale failed: %s", esp_err_to_name(err));
+            PsramArena::release(image);
+            return err;
+        }
+        err = syncForCpu(image, outLen);
+    } else {
+        err = syncForCpu(image, fullLen);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Cache sync failed: %s", esp_err_to_name(err));
+        PsramArena::release(image);
+        return err;
+    }
+
+    out.data = image;
+    out.width = static_cast<uint16_t>(outWidth);
+    out.height = static_cast<uint16_t>(outHeight);
+    out.pix_type = dl::image::DL_IMAGE_PIX_TYPE_RGB565;
+
+    ESP_LOGD(TAG, "Decoded %dx%d -> %dx%d (1/%d) in hardware",
+             srcWidth, srcHeight, outWidth, outHeight, 1 << scaleShift);
+    return ESP_OK;
+}
+
+#else
+
+bool HwJpegDecoder::isSupported() {
+    return false;
+}
+
+esp_err_t HwJpegDecoder::decode(const uint8_t*, size_t, int, int, int, dl::image::img_t& out) {
+    out.data = nullptr;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // CONFIG_IDF_TARGET_ESP32P4
+
+} // namespace detection
@@ -0,0 +1,61 @@
+#pragma once
+
+/**
+ * @file hw_jpeg_decoder.hpp
+ * @brief ESP32-P4 hardware JPEG decode with PPA downscaling
+ *
+ * The JPEG codec decodes and converts YUV to RGB565 (little-endian, as
+ * the P4 ImagePreprocessor expects); for a 1/2^n reduction the PPA
+ * scaler then writes the model-sized image. Both are DMA engines, so
+ * the CPU only copies the bitstream into a DMA-capable buffer.
+ *
+ * Output goes to the PsramArena IMAGE region (the full-size intermediate
+ * of a scaled decode uses SCRATCH), like JpegDecoder's. Other targets
+ * get stubs returning ESP_ERR_NOT_SUPPORTED; JpegDecoder tries this
+ * backend first and keeps the software path as the fallback.
+ *
+ * Disabled unless config::detection::HW_JPEG_DECODE is set.
+ */
+
+#include "esp_err.h"
+#include "dl_image_define.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace detection {
+
+/**
+ * @brief Hardware JPEG + PPA decoder (static; engines opened on first use)
+ */
+class HwJpegDecoder {
+public:
+    /**
+     * @brief Check whether the hardware decoder is present and enabled
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Decode a JPEG and reduce it by 1/2^scaleShift
+     *
+     * @param data       JPEG data
+     * @param dataLen    JPEG length in bytes
+     * @param srcWidth   Full-resolution width (checked against the header)
+     * @param srcHeight  Full-resolution height
+     * @param scaleShift Reduction as a shift (0 = full size)
+     * @param[out] out   Decoded RGB565 image (caller frees with PsramArena::release)
+     *
+     * @return esp_err_t
+     *         - ESP_OK on success
+     *         - ESP_ERR_NOT_SUPPORTED on targets without the hardware, or for
+     *           frames not a whole number of MCUs (software decoder instead)
+     *         - ESP_ERR_INVALID_ARG on bad input or a header mismatch
+     *         - ESP_ERR_INVALID_SIZE if the codec wrote less than a full image
+     *         - ESP_ERR_NO_MEM if a buffer could not be allocated
+     *         - Driver errors from the JPEG codec or the PPA
+     */
+    static esp_err_t decode(const uint8_t* data, size_t dataLen,
+                            int srcWidth, int srcHeight, int scaleShift,
+                            dl::image::img_t& out);
+};
+
+} // namespace detection
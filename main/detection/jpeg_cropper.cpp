@@ -0,0 +1,195 @@
+/**
+ * @file jpeg_cropper.cpp
+ * @brief Full-resolution JPEG crop implementation
+ */
+
+#include "jpeg_cropper.hpp"
+#include "app_config.hpp"
+
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_jpeg_dec.h"
+#include "esp_jpeg_enc.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const char* TAG = "JpegCropper";
+
+namespace detection {
+
+namespace {
+
+constexpr int MCU_SIZE = 16;            // Largest MCU (4:2:0)
+constexpr size_t BUFFER_ALIGNMENT = 16; // esp_new_jpeg input/output alignment
+constexpr int RGB888_BYTES = 3;
+
+int alignDown(int value) {
+    return value & ~(MCU_SIZE - 1);
+}
+
+int alignUp(int value) {
+    return (value + MCU_SIZE - 1) & ~(MCU_SIZE - 1);
+}
+
+/**
+ * @brief Grow [start, start + length) to size, centred, inside [0, limit)
+ */
+void fitSpan(int& start, int& length, int size, int limit) {
+    const int maxLength = std::max(alignDown(limit), MCU_SIZE);
+    size = std::min(alignUp(std::max(size, length)), maxLength);
+    start = start + length / 2 - size / 2;
+    start = std::max(0, std::min(start, limit - size));
+    start = alignDown(start);
+    length = size;
+}
+
+/**
+ * @brief Decode a JPEG at full size into a PSRAM buffer
+ */
+esp_err_t decodeFull(const uint8_t* data, size_t dataLen,
+                     uint8_t*& rgb, int& width, int& height) {
+    jpeg_dec_config_t config = DEFAULT_JPEG_DEC_CONFIG();
+    config.output_type = JPEG_PIXEL_FORMAT_RGB888;
+
+    jpeg_dec_handle_t decoder = nullptr;
+    if (jpeg_dec_open(&config, &decoder) != JPEG_ERR_OK) {
+        ESP_LOGE(TAG, "Failed to open JPEG decoder");
+        return ESP_FAIL;
+    }
+
+    jpeg_dec_io_t io = {};
+    io.inbuf = const_cast<uint8_t*>(data);
+    io.inbuf_len = static_cast<int>(dataLen);
+
+    jpeg_dec_header_info_t header = {};
+    int outLen = 0;
+    if (jpeg_dec_parse_header(decoder, &io, &header) != JPEG_ERR_OK ||
+        jpeg_dec_get_outbuf_len(decoder, &outLen) != JPEG_ERR_OK || outLen <= 0) {
+        ESP_LOGE(TAG, "Failed to parse JPEG header");
+        jpeg_dec_close(decoder);
+        return ESP_FAIL;
+    }
+
+    // Check first: a failed multi-megabyte allocation is cheap, a
+    // fragmented PSRAM heap is not
+    if (heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM) < static_cast<size_t>(outLen)) {
+        ESP_LOGW(TAG, "No %d byte PSRAM block for the full-size decode", outLen);
+        jpeg_dec_close(decoder);
+        return ESP_ERR_NO_MEM;
+    }
+    rgb = static_cast<uint8_t*>(heap_caps_aligned_alloc(BUFFER_ALIGNMENT,
+                                                        static_cast<size_t>(outLen),
+                                                        MALLOC_CAP_SPIRAM));
+    if (!rgb) {
+        jpeg_dec_close(decoder);
+        return ESP_ERR_NO_MEM;
+    }
+
+    io.outbuf = rgb;
+    jpeg_error_t ret = jpeg_dec_process(decoder, &io);
+    jpeg_dec_close(decoder);
+    if (ret != JPEG_ERR_OK) {
+        ESP_LOGE(TAG, "JPEG decode failed: %d", ret);
+        heap_caps_free(rgb);
+        rgb = nullptr;
+        return ESP_FAIL;
+    }
+
+    width = header.width;
+    height = header.height;
+    return ESP_OK;
+}
+
+} // namespace
+
+CropWindow JpegCropper::around(int boxX, int boxY, int boxWidth, int boxHeight,
+                               int frameWidth, int frameHeight) {
+    const int marginX = boxWidth * config::uplink::CROP_MARGIN_PCT / 100;
+    const int marginY = boxHeight * config::uplink::CROP_MARGIN_PCT / 100;
+
+    CropWindow window = {boxX - marginX, boxY - marginY,
+                         boxWidth + 2 * marginX, boxHeight + 2 * marginY};
+    fitSpan(window.x, window.width, config::uplink::CROP_MIN_SIZE, frameWidth);
+    fitSpan(window.y, window.height, config::uplink::CROP_MIN_SIZE, frameHeight);
+    return window;
+}
+
+esp_err_t JpegCropper::crop(const uint8_t* data, size_t dataLen, const CropWindow& window,
+                            int quality, uint8_t*& out, size_t& outLen) {
+    out = nullptr;
+    outLen = 0;
+    if (!data || dataLen == 0 || window.width <= 0 || window.height <= 0 ||
+        window.x < 0 || window.y < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const int64_t startUs = esp_timer_get_time();
+
+    uint8_t* rgb = nullptr;
+    int width = 0;
+    int height = 0;
+    esp_err_t err = decodeFull(data, dataLen, rgb, width, height);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (window.x + window.width > width || window.y + window.height > height) {
+        ESP_LOGE(TAG, "Window %dx%d+%d+%d outside %dx%d frame",
+                 window.width, window.height, window.x, window.y, width, height);
+        heap_caps_free(rgb);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Window rows to the start of the buffer (each moves toward lower addresses)
+    const size_t rowLen = static_cast<size_t>(window.width) * RGB888_BYTES;
+    for (int row = 0; row < window.height; row++) {
+        const size_t src = (static_cast<size_t>(window.y + row) * width + window.x) * RGB888_BYTES;
+        std::memmove(rgb + row * rowLen, rgb + src, rowLen);
+    }
+
+    // One byte per pixel is far above any JPEG of a photo at quality <= 100
+    const size_t outSize = static_cast<size_t>(window.width) * window.height;
+    uint8_t* encoded = static_cast<uint8_t*>(heap_caps_aligned_alloc(BUFFER_ALIGNMENT, outSize,
+                                                                     MALLOC_CAP_SPIRAM));
+    if (!encoded) {
+        heap_caps_free(rgb);
+        return ESP_ERR_NO_MEM;
+    }
+
+    jpeg_enc_config_t config = DEFAULT_JPEG_ENC_CONFIG();
+    config.width = window.width;
+    config.height = window.height;
+    config.src_type = JPEG_PIXEL_FORMAT_RGB888;
+    config.subsampling = JPEG_SUBSAMPLE_420;
+    config.quality = std::max(1, std::min(quality, 100));
+
+    jpeg_enc_handle_t encoder = nullptr;
+    int encodedLen = 0;
+    jpeg_error_t ret = jpeg_enc_open(&config, &encoder);
+    if (ret == JPEG_ERR_OK) {
+        ret = jpeg_enc_process(encoder, rgb, static_cast<int>(rowLen * window.height),
+                               encoded, static_cast<int>(outSize), &encodedLen);
+        jpeg_enc_close(encoder);
+    }
+    heap_caps_free(rgb);
+
+    if (ret != JPEG_ERR_OK || encodedLen <= 0) {
+        ESP_LOGE(TAG, "JPEG encode failed: %d", ret);
+        heap_caps_free(encoded);
+        return ESP_FAIL;
+    }
+
+    out = encoded;
+    outLen = static_cast<size_t>(encodedLen);
+    ESP_LOGI(TAG, "Cropped %dx%d+%d+%d from %dx%d: %u bytes in %lld ms",
+             window.width, window.height, window.x, window.y, width, height,
+             static_cast<unsigned>(outLen), (esp_timer_get_time() - startUs) / 1000);
+    return ESP_OK;
+}
+
+void JpegCropper::release(uint8_t* buffer) {
+    heap_caps_free(buffer);
+}
+
+} // namespace detection
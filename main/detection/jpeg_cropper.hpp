@@ -0,0 +1,75 @@
+#pragma once
+
+/**
+ * @file jpeg_cropper.hpp
+ * @brief Full-resolution JPEG crop around a detection
+ *
+ * Cuts a window out of an alert frame without losing detail: the frame
+ * is decoded at full size (RGB888, PSRAM heap), the window rows are
+ * compacted in place and re-encoded with esp_new_jpeg. Used when the
+ * uplink is too slow for the whole frame (network::UplinkPlanner).
+ *
+ * The decode needs width x height x 3 bytes of PSRAM for the duration of
+ * the call (about 3.9 MB for SXGA); crop() fails with ESP_ERR_NO_MEM
+ * rather than fragmenting the heap when no such block is free.
+ */
+
+#include "esp_err.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace detection {
+
+/**
+ * @brief Crop window in frame pixels
+ */
+struct CropWindow {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+/**
+ * @brief JPEG crop and re-encode (static)
+ */
+class JpegCropper {
+public:
+    /**
+     * @brief Window around a box, grown by config::uplink::CROP_MARGIN_PCT
+     *
+     * At least CROP_MIN_SIZE square where the frame allows, clamped to the
+     * frame and aligned to the 16-pixel MCU grid.
+     *
+     * @param boxX, boxY, boxWidth, boxHeight Box in frame coordinates
+     * @param frameWidth, frameHeight         Frame size
+     */
+    static CropWindow around(int boxX, int boxY, int boxWidth, int boxHeight,
+                             int frameWidth, int frameHeight);
+
+    /**
+     * @brief Crop a JPEG frame and encode the window
+     *
+     * @param data      JPEG data
+     * @param dataLen   JPEG length in bytes
+     * @param window    Window inside the frame (from around())
+     * @param quality   Encoder quality (1-100)
+     * @param[out] out    Encoded crop (caller frees with release())
+     * @param[out] outLen Encoded length in bytes
+     *
+     * @return esp_err_t
+     *         - ESP_OK on success
+     *         - ESP_ERR_INVALID_ARG on bad input or a window outside the frame
+     *         - ESP_ERR_NO_MEM if the decode or output buffer is unavailable
+     *         - ESP_FAIL on a decoder or encoder error
+     */
+    static esp_err_t crop(const uint8_t* data, size_t dataLen, const CropWindow& window,
+                          int quality, uint8_t*& out, size_t& outLen);
+
+    /**
+     * @brief Free a buffer returned by crop()
+     */
+    static void release(uint8_t* buffer);
+};
+
+} // namespace detection
@@ -0,0 +1,140 @@
+/**
+ * @file jpeg_decoder.cpp
+ * @brief Downscaling JPEG decoder implementation
+ */
+
+#include "jpeg_decoder.hpp"
+#include "hw_jpeg_decoder.hpp"
+#include "psram_arena.hpp"
+
+#include "esp_log.h"
+#include "esp_jpeg_dec.h"
+
+static const char* TAG = "JpegDecoder";
+
+namespace detection {
+
+int JpegDecoder::selectScaleShift(int srcWidth, int srcHeight,
+                                  int minWidth, int minHeight) {
+    int shift = 0;
+
+    while (shift < MAX_SCALE_SHIFT) {
+        int nextWidth = srcWidth >> (shift + 1);
+        int nextHeight = srcHeight >> (shift + 1);
+
+        if (nextWidth < minWidth || nextHeight < minHeight) {
+            break;
+        }
+        if ((nextWidth % SCALE_ALIGNMENT) != 0 || (nextHeight % SCALE_ALIGNMENT) != 0) {
+            break;
+        }
+        shift++;
+    }
+
+    return shift;
+}
+
+esp_err_t JpegDecoder::decode(const uint8_t* data, size_t dataLen,
+                              int srcWidth, int srcHeight,
+                              int minWidth, int minHeight,
+                              dl::image::img_t& out, int& scaleShift) {
+    out.data = nullptr;
+    out.width = 0;
+    out.height = 0;
+    scaleShift = 0;
+
+    if (!data || dataLen == 0 || srcWidth <= 0 || srcHeight <= 0) {
+        ESP_LOGE(TAG, "Invalid JPEG input");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int shift = selectScaleShift(srcWidth, srcHeight, minWidth, minHeight);
+
+    // ESP32-P4: JPEG codec + PPA; the software decoder below is the fallback
+    if (HwJpegDecoder::isSupported()) {
+        esp_err_t err = HwJpegDecoder::decode(data, dataLen, srcWidth, srcHeight, shift, out);
+        if (err == ESP_OK) {
+            scaleShift = shift;
+            return ESP_OK;
+        }
+        if (err != ESP_ERR_NOT_SUPPORTED) {
+            ESP_LOGW(TAG, "Hardware decode failed (%s), decoding in software",
+                     esp_err_to_name(err));
+        }
+    }
+
+    // Configure decoder for scaled RGB565 output
+    jpeg_dec_config_t config = DEFAULT_JPEG_DEC_CONFIG();
+#if CONFIG_IDF_TARGET_ESP32P4
+    config.output_type = JPEG_PIXEL_FORMAT_RGB565_LE;
+#else
+    config.output_type = JPEG_PIXEL_FORMAT_RGB565_BE;
+#endif
+    if (shift > 0) {
+        config.scale.width = static_cast<uint16_t>(srcWidth >> shift);
+        config.scale.height = static_cast<uint16_t>(srcHeight >> shift);
+    }
+
+    jpeg_dec_handle_t decoder = nullptr;
+    if (jpeg_dec_open(&config, &decoder) != JPEG_ERR_OK) {
+        ESP_LOGE(TAG, "Failed to open JPEG decoder");
+        return ESP_FAIL;
+    }
+
+    jpeg_dec_io_t io = {};
+    io.inbuf = const_cast<uint8_t*>(data);
+    io.inbuf_len = static_cast<int>(dataLen);
+
+    jpeg_dec_header_info_t header = {};
+    if (jpeg_dec_parse_header(decoder, &io, &header) != JPEG_ERR_OK) {
+        ESP_LOGE(TAG, "Failed to parse JPEG header");
+        jpeg_dec_close(decoder);
+        return ESP_FAIL;
+    }
+
+    if (header.width != srcWidth || header.height != srcHeight) {
+        ESP_LOGE(TAG, "JPEG header %dx%d does not match frame %dx%d",
+                 header.width, header.height, srcWidth, srcHeight);
+        jpeg_dec_close(decoder);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int outLen = 0;
+    if (jpeg_dec_get_outbuf_len(decoder, &outLen) != JPEG_ERR_OK || outLen <= 0) {
+        ESP_LOGE(TAG, "Failed to query output size");
+        jpeg_dec_close(decoder);
+        return ESP_FAIL;
+    }
+
+    // Arena regions are at least 16-byte aligned, as the decoder requires
+    uint8_t* outBuf = static_cast<uint8_t*>(
+        PsramArena::acquire(ArenaRegion::IMAGE, static_cast<size_t>(outLen)));
+    if (!outBuf) {
+        ESP_LOGE(TAG, "Failed to allocate %d byte output buffer", outLen);
+        jpeg_dec_close(decoder);
+        return ESP_ERR_NO_MEM;
+    }
+
+    io.outbuf = outBuf;
+    jpeg_error_t ret = jpeg_dec_process(decoder, &io);
+    jpeg_dec_close(decoder);
+
+    if (ret != JPEG_ERR_OK) {
+        ESP_LOGE(TAG, "JPEG decode failed: %d", ret);
+        PsramArena::release(outBuf);
+        return ESP_FAIL;
+    }
+
+    out.data = outBuf;
+    out.width = static_cast<uint16_t>(srcWidth >> shift);
+    out.height = static_cast<uint16_t>(srcHeight >> shift);
+    out.pix_type = dl::image::DL_IMAGE_PIX_TYPE_RGB565;
+    scaleShift = shift;
+
+    ESP_LOGD(TAG, "Decoded %dx%d -> %dx%d (1/%d), %d bytes",
+             srcWidth, srcHeight, out.width, out.height, 1 << shift, outLen);
+
+    return ESP_OK;
+}
+
+} // namespace detection
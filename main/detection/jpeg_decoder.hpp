@@ -0,0 +1,71 @@
+#pragma once
+
+/**
+ * @file jpeg_decoder.hpp
+ * @brief Downscaling JPEG decoder for model input
+ *
+ * Decodes camera JPEG frames directly at a reduced resolution using the
+ * decoder's 1/2, 1/4 and 1/8 IDCT scaling, so the full SXGA frame is never
+ * materialized in PSRAM.
+ *
+ * Output is RGB565 in the byte order expected by the target's
+ * ImagePreprocessor (big-endian on ESP32-S3), in the IMAGE region of
+ * the PsramArena.
+ *
+ * On ESP32-P4 the hardware JPEG codec and PPA scaler (HwJpegDecoder) do
+ * the work; the esp_new_jpeg software decoder is the S3 path and the P4
+ * fallback.
+ */
+
+#include "esp_err.h"
+#include "dl_image_define.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace detection {
+
+/**
+ * @brief JPEG decoder with power-of-two downscaling
+ */
+class JpegDecoder {
+public:
+    /**
+     * @brief Decode a JPEG at the smallest scale covering the target size
+     *
+     * Picks the largest 1/2^n reduction (n <= 3) that keeps the decoded
+     * image at least minWidth x minHeight.
+     *
+     * @param data      JPEG data
+     * @param dataLen   JPEG length in bytes
+     * @param srcWidth  Full-resolution width of the JPEG
+     * @param srcHeight Full-resolution height of the JPEG
+     * @param minWidth  Minimum decoded width (model input width)
+     * @param minHeight Minimum decoded height (model input height)
+     * @param[out] out  Decoded RGB565 image (caller frees with PsramArena::release)
+     * @param[out] scaleShift Applied reduction as a shift (0 = full size)
+     *
+     * @return esp_err_t
+     *         - ESP_OK on success
+     *         - ESP_ERR_INVALID_ARG on bad input
+     *         - ESP_ERR_NO_MEM if no output buffer was available
+     *         - ESP_FAIL on decoder error
+     */
+    static esp_err_t decode(const uint8_t* data, size_t dataLen,
+                            int srcWidth, int srcHeight,
+                            int minWidth, int minHeight,
+                            dl::image::img_t& out, int& scaleShift);
+
+    /**
+     * @brief Select the scale shift for a source/target size pair
+     *
+     * @return int Shift in [0, 3]
+     */
+    static int selectScaleShift(int srcWidth, int srcHeight,
+                                int minWidth, int minHeight);
+
+private:
+    static constexpr int MAX_SCALE_SHIFT = 3;   // 1/8
+    static constexpr int SCALE_ALIGNMENT = 8;   // Decoder requires 8-px aligned output
+};
+
+} // namespace detection
@@ -0,0 +1,274 @@
+/**
+ * @file model_slots.cpp
+ * @brief A/B model partition bookkeeping implementation
+ */
+
+#include "model_slots.hpp"
+
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#include <cstdio>
+#include <cstring>
+
+static const char* TAG = "ModelSlots";
+
+// Active slot cached across deep sleep (-1 = read NVS)
+RTC_DATA_ATTR static int8_t s_activeSlot = -1;
+
+// Unconfirmed load attempts of the active slot (0 = confirmed)
+RTC_DATA_ATTR static uint8_t s_trialLoads = 0;
+
+namespace detection {
+
+namespace {
+
+constexpr const char* KEY_ACTIVE = "active";
+constexpr const char* KEY_PREVIOUS = "previous";     // Slot to revert a trial to
+constexpr const char* KEY_TRIAL = "trial";           // Unconfirmed load attempts
+constexpr const char* KEY_REJECTED = "rejected";     // SHA-256 of a failed trial image
+
+esp_err_t openNvs(nvs_open_mode_t mode, nvs_handle_t& handle) {
+    // No-op once WifiManager (or an earlier call) has initialized NVS
+    esp_err_t err = nvs_flash_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+    return nvs_open(config::model::NVS_NAMESPACE, mode, &handle);
+}
+
+void slotKey(char* key, size_t len, const char* prefix, int slot) {
+    std::snprintf(key, len, "%s%d", prefix, slot);
+}
+
+bool validSlot(int slot) {
+    return slot >= 0 && static_cast<size_t>(slot) < config::model::SLOT_COUNT;
+}
+
+} // namespace
+
+void ModelSlots::refresh() {
+    uint8_t slot = 0;
+    uint8_t trialLoads = 0;
+    nvs_handle_t handle;
+    if (openNvs(NVS_READONLY, handle) == ESP_OK) {
+        if (nvs_get_u8(handle, KEY_ACTIVE, &slot) != ESP_OK || !validSlot(slot)) {
+            slot = 0;
+        }
+        if (nvs_get_u8(handle, KEY_TRIAL, &trialLoads) != ESP_OK) {
+            trialLoads = 0;
+        }
+        nvs_close(handle);
+    }
+    s_activeSlot = static_cast<int8_t>(slot);
+    s_trialLoads = trialLoads;
+    if (trialLoads > 0) {
+        ESP_LOGW(TAG, "Active model slot: %s (on trial, %u unconfirmed loads)", label(slot),
+                 static_cast<unsigned>(trialLoads - 1));
+    } else {
+        ESP_LOGI(TAG, "Active model slot: %s", label(slot));
+    }
+}
+
+int ModelSlots::activeSlot() {
+    if (s_activeSlot < 0) {
+        refresh();
+    }
+    return s_activeSlot;
+}
+
+const char* ModelSlots::label(int slot) {
+    return validSlot(slot) ? config::model::SLOT_LABELS[slot] : config::model::SLOT_LABELS[0];
+}
+
+const esp_partition_t* ModelSlots::partition(int slot) {
+    if (!validSlot(slot)) {
+        return nullptr;
+    }
+    return esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                    config::model::SLOT_LABELS[slot]);
+}
+
+esp_err_t ModelSlots::getImage(int slot, uint8_t* sha256, uint32_t& size) {
+    if (!validSlot(slot)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    nvs_handle_t handle;
+    esp_err_t err = openNvs(NVS_READONLY, handle);
+    if (err != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    char shaKey[8];
+    char sizeKey[8];
+    slotKey(shaKey, sizeof(shaKey), "sha", slot);
+    slotKey(sizeKey, sizeof(sizeKey), "size", slot);
+
+    size_t shaLen = SHA256_LEN;
+    err = nvs_get_blob(handle, shaKey, sha256, &shaLen);
+    if (err == ESP_OK) {
+        err = nvs_get_u32(handle, sizeKey, &size);
+    }
+    nvs_close(handle);
+    return (err == ESP_OK && shaLen == SHA256_LEN) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t ModelSlots::activate(int slot, const uint8_t* sha256, uint32_t size) {
+    if (!validSlot(slot) || !sha256) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    nvs_handle_t handle;
+    esp_err_t err = openNvs(NVS_READWRITE, handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "NVS unavailable: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    char shaKey[8];
+    char sizeKey[8];
+    slotKey(shaKey, sizeof(shaKey), "sha", slot);
+    slotKey(sizeKey, sizeof(sizeKey), "size", slot);
+
+    // Image record first, then the switch itself (with its trial state)
+    const int previous = activeSlot();
+    const bool onTrial = (slot != previous);
+    err = nvs_set_blob(handle, shaKey, sha256, SHA256_LEN);
+    if (err == ESP_OK) {
+        err = nvs_set_u32(handle, sizeKey, size);
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    if (err == ESP_OK && onTrial) {
+        err = nvs_set_u8(handle, KEY_PREVIOUS, static_cast<uint8_t>(previous));
+        if (err == ESP_OK) {
+            // 1 = on trial, no load attempted yet
+            err = nvs_set_u8(handle, KEY_TRIAL, 1);
+        }
+    }
+    if (err == ESP_OK) {
+        err = nvs_set_u8(handle, KEY_ACTIVE, static_cast<uint8_t>(slot));
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Slot switch failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    s_activeSlot = static_cast<int8_t>(slot);
+    if (onTrial) {
+        s_trialLoads = 1;
+    }
+    ESP_LOGI(TAG, "Model slot %s active (%lu bytes)%s", label(slot),
+             static_cast<unsigned long>(size), onTrial ? ", on trial" : "");
+    return ESP_OK;
+}
+
+bool ModelSlots::isOnTrial() {
+    activeSlot();
+    return s_trialLoads > 0;
+}
+
+void ModelSlots::beginLoad() {
+    if (!isOnTrial()) {
+        return;
+    }
+    if (s_trialLoads > config::model::TRIAL_LOADS) {
+        ESP_LOGE(TAG, "Slot %s not confirmed after %u loads", activeLabel(),
+                 static_cast<unsigned>(config::model::TRIAL_LOADS));
+        revert();
+        return;
+    }
+
+    nvs_handle_t handle;
+    if (openNvs(NVS_READWRITE, handle) != ESP_OK) {
+        return;
+    }
+    const uint8_t next = static_cast<uint8_t>(s_trialLoads + 1);
+    if (nvs_set_u8(handle, KEY_TRIAL, next) == ESP_OK && nvs_commit(handle) == ESP_OK) {
+        s_trialLoads = next;
+    }
+    nvs_close(handle);
+}
+
+void ModelSlots::confirm() {
+    if (!isOnTrial()) {
+        return;
+    }
+    nvs_handle_t handle;
+    if (openNvs(NVS_READWRITE, handle) != ESP_OK) {
+        return;
+    }
+    nvs_erase_key(handle, KEY_TRIAL);
+    if (nvs_commit(handle) == ESP_OK) {
+        s_trialLoads = 0;
+        ESP_LOGI(TAG, "Model slot %s confirmed", activeLabel());
+    }
+    nvs_close(handle);
+}
+
+esp_err_t ModelSlots::revert() {
+    if (!isOnTrial()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const int failed = activeSlot();
+    nvs_handle_t handle;
+    esp_err_t err = openNvs(NVS_READWRITE, handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    uint8_t previous = 0;
+    if (nvs_get_u8(handle, KEY_PREVIOUS, &previous) != ESP_OK || !validSlot(previous) ||
+        previous == failed) {
+        previous = static_cast<uint8_t>(1 - failed);
+    }
+
+    // Reject the image first, so the updater cannot reinstall it
+    char shaKey[8];
+    slotKey(shaKey, sizeof(shaKey), "sha", failed);
+    uint8_t sha256[SHA256_LEN];
+    size_t shaLen = SHA256_LEN;
+    if (nvs_get_blob(handle, shaKey, sha256, &shaLen) == ESP_OK && shaLen == SHA256_LEN) {
+        err = nvs_set_blob(handle, KEY_REJECTED, sha256, SHA256_LEN);
+    }
+    if (err == ESP_OK) {
+        err = nvs_set_u8(handle, KEY_ACTIVE, previous);
+    }
+    if (err == ESP_OK) {
+        err = nvs_erase_key(handle, KEY_TRIAL);
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Slot revert failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    s_activeSlot = static_cast<int8_t>(previous);
+    s_trialLoads = 0;
+    ESP_LOGE(TAG, "Model in %s rejected, back to %s", label(failed), label(previous));
+    return ESP_OK;
+}
+
+bool ModelSlots::isRejected(const uint8_t* sha256) {
+    nvs_handle_t handle;
+    if (!sha256 || openNvs(NVS_READONLY, handle) != ESP_OK) {
+        return false;
+    }
+    uint8_t rejected[SHA256_LEN];
+    size_t len = SHA256_LEN;
+    const bool found = nvs_get_blob(handle, KEY_REJECTED, rejected, &len) == ESP_OK &&
+                       len == SHA256_LEN;
+    nvs_close(handle);
+    return found && std::memcmp(rejected, sha256, SHA256_LEN) == 0;
+}
+
+} // namespace detection
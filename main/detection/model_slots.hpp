@@ -0,0 +1,136 @@
+#pragma once
+
+/**
+ * @file model_slots.hpp
+ * @brief A/B model partition bookkeeping
+ *
+ * Provides:
+ * - Active model slot recorded in NVS, cached in RTC memory so PIR wakes
+ *   pick the partition without touching NVS
+ * - SHA-256 and size of the image written to each slot
+ * - Atomic slot switch (a single NVS key commit)
+ * - Trial of a newly activated slot: it is confirmed by the first model
+ *   load that succeeds from it; a failed load, or TRIAL_LOADS attempts
+ *   without one, restores the previous slot and rejects the image
+ *
+ * Slot 0 holds the model written by idf.py flash until the first update.
+ */
+
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "app_config.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace detection {
+
+/**
+ * @brief Model slot table (static, shared by the detector and the updater)
+ *
+ * @code
+ *   Detect model(Detect::PICO_S8_V1, false, ModelSlots::activeLabel());
+ *   ...
+ *   ModelSlots::activate(ModelSlots::inactiveSlot(), sha256, size);
+ *
+ *   ModelSlots::beginLoad();               // Before each model load
+ *   if (loaded) ModelSlots::confirm(); else ModelSlots::revert();
+ * @endcode
+ */
+class ModelSlots {
+public:
+    static constexpr size_t SHA256_LEN = 32;
+
+    /**
+     * @brief Re-read the active slot from NVS into the RTC cache
+     *
+     * Called on power-on; later wakes use the cached value.
+     */
+    static void refresh();
+
+    /**
+     * @brief Index of the slot the detector loads from
+     */
+    static int activeSlot();
+
+    /**
+     * @brief Index of the slot an update writes to
+     */
+    static int inactiveSlot() { return 1 - activeSlot(); }
+
+    /**
+     * @brief Partition label of the active slot
+     */
+    static const char* activeLabel() { return label(activeSlot()); }
+
+    /**
+     * @brief Partition label of a slot
+     */
+    static const char* label(int slot);
+
+    /**
+     * @brief Find the partition of a slot
+     *
+     * @return Partition, or nullptr if the table has no such partition
+     */
+    static const esp_partition_t* partition(int slot);
+
+    /**
+     * @brief Get the recorded image of a slot
+     *
+     * @param slot        Slot index
+     * @param[out] sha256 SHA-256 of the image (SHA256_LEN bytes)
+     * @param[out] size   Image size in bytes
+     *
+     * @return esp_err_t ESP_OK, or ESP_ERR_NOT_FOUND if nothing was recorded
+     *         (e.g. the factory image in slot 0)
+     */
+    static esp_err_t getImage(int slot, uint8_t* sha256, uint32_t& size);
+
+    /**
+     * @brief Record a verified image and make its slot active
+     *
+     * The hash and size are committed first; the active slot key is
+     * committed last, so a power cut leaves the previous slot in use.
+     * Switching to another slot puts it on trial, with the current slot
+     * kept as the one to revert to.
+     *
+     * @return esp_err_t ESP_OK or the NVS error
+     */
+    static esp_err_t activate(int slot, const uint8_t* sha256, uint32_t size);
+
+    /**
+     * @brief Check whether the active slot is on trial (not yet confirmed)
+     */
+    static bool isOnTrial();
+
+    /**
+     * @brief Count a model load attempt from a slot on trial
+     *
+     * Recorded in NVS before the load, so a load that crashes the device
+     * still counts. Once TRIAL_LOADS attempts went unconfirmed the slot is
+     * reverted before this load. No-op for a confirmed slot.
+     */
+    static void beginLoad();
+
+    /**
+     * @brief Confirm the active slot after a successful model load
+     */
+    static void confirm();
+
+    /**
+     * @brief Restore the previous slot and reject the trial image
+     *
+     * @return esp_err_t ESP_OK, ESP_ERR_INVALID_STATE if not on trial, or
+     *         the NVS error
+     */
+    static esp_err_t revert();
+
+    /**
+     * @brief Check whether an image was rejected by a failed trial
+     *
+     * The updater skips it, instead of installing it again at every check.
+     */
+    static bool isRejected(const uint8_t* sha256);
+};
+
+} // namespace detection
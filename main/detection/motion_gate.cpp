@@ -0,0 +1,193 @@
+/**
+ * @file motion_gate.cpp
+ * @brief Motion gate implementation
+ */
+
+#include "motion_gate.hpp"
+#include "jpeg_decoder.hpp"
+#include "psram_arena.hpp"
+#include "stage_profiler.hpp"
+
+#include "esp_log.h"
+#include "esp_attr.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <sys/time.h>
+
+static const char* TAG = "MotionGate";
+
+// Reference thumbnail from the last quiet wake (survives deep sleep)
+RTC_DATA_ATTR static uint8_t s_reference[detection::MotionGate::THUMB_PIXELS];
+RTC_DATA_ATTR static bool s_referenceValid = false;
+RTC_DATA_ATTR static int64_t s_referenceTime = 0;
+
+namespace detection {
+
+namespace {
+
+constexpr int BLOCK = config::motion::BLOCK_SIZE;
+constexpr int BLOCKS_X = MotionGate::THUMB_WIDTH / BLOCK;
+constexpr int BLOCKS_Y = MotionGate::THUMB_HEIGHT / BLOCK;
+
+static_assert(MotionGate::THUMB_WIDTH % BLOCK == 0 &&
+              MotionGate::THUMB_HEIGHT % BLOCK == 0,
+              "Thumbnail must tile into whole blocks");
+
+int64_t nowSec() {
+    struct timeval tv = {};
+    gettimeofday(&tv, nullptr);
+    return static_cast<int64_t>(tv.tv_sec);
+}
+
+/**
+ * @brief Luma (0-255) of one RGB565 pixel
+ */
+inline uint32_t luma565(uint16_t p) {
+    uint32_t r = (p >> 8) & 0xF8;
+    uint32_t g = (p >> 3) & 0xFC;
+    uint32_t b = (p << 3) & 0xF8;
+    return (r * 77 + g * 150 + b * 29) >> 8;
+}
+
+} // namespace
+
+const char* gateDecisionName(GateDecision decision) {
+    switch (decision) {
+        case GateDecision::MOTION:        return "motion";
+        case GateDecision::STILL:         return "still";
+        case GateDecision::NO_REFERENCE:  return "noref";
+        default:                          return "off";
+    }
+}
+
+MotionGate::MotionGate()
+    : m_thumb{}
+    , m_thumbValid(false)
+    , m_changedBlocks(0)
+{
+}
+
+esp_err_t MotionGate::buildThumbnail(const camera_fb_t* frame) {
+    dl::image::img_t img = {};
+    int scaleShift = 0;
+    bool owned = false;
+    bool bigEndian = true;
+
+    if (frame->format == PIXFORMAT_JPEG) {
+        esp_err_t err = JpegDecoder::decode(frame->buf, frame->len,
+                                            frame->width, frame->height,
+                                            THUMB_WIDTH, THUMB_HEIGHT,
+                                            img, scaleShift);
+        if (err != ESP_OK) {
+            return err;
+        }
+        owned = true;
+#if CONFIG_IDF_TARGET_ESP32P4
+        bigEndian = false;
+#endif
+    } else if (frame->format == PIXFORMAT_RGB565) {
+        img.data = frame->buf;
+        img.width = static_cast<uint16_t>(frame->width);
+        img.height = static_cast<uint16_t>(frame->height);
+    } else {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    const uint8_t* src = static_cast<const uint8_t*>(img.data);
+    const int w = img.width;
+    const int h = img.height;
+
+    // Box-filter the decoded image down to the thumbnail grid
+    for (int ty = 0; ty < THUMB_HEIGHT; ty++) {
+        int y0 = ty * h / THUMB_HEIGHT;
+        int y1 = (ty + 1) * h / THUMB_HEIGHT;
+        for (int tx = 0; tx < THUMB_WIDTH; tx++) {
+            int x0 = tx * w / THUMB_WIDTH;
+            int x1 = (tx + 1) * w / THUMB_WIDTH;
+
+            uint32_t sum = 0;
+            for (int y = y0; y < y1; y++) {
+                const uint8_t* row = src + (static_cast<size_t>(y) * w + x0) * 2;
+                for (int x = x0; x < x1; x++, row += 2) {
+                    uint16_t p = bigEndian ? (row[0] << 8) | row[1] : (row[1] << 8) | row[0];
+                    sum += luma565(p);
+                }
+            }
+            int count = (x1 - x0) * (y1 - y0);
+            m_thumb[ty * THUMB_WIDTH + tx] = static_cast<uint8_t>(count ? sum / count : 0);
+        }
+    }
+
+    if (owned) {
+        PsramArena::release(img.data);
+    }
+    m_thumbValid = true;
+    return ESP_OK;
+}
+
+int MotionGate::countChangedBlocks(const uint8_t* current, const uint8_t* reference) {
+    // Global brightness offset (AEC/AGC drift, clouds) is not motion
+    int32_t sumCur = 0;
+    int32_t sumRef = 0;
+    for (size_t i = 0; i < THUMB_PIXELS; i++) {
+        sumCur += current[i];
+        sumRef += reference[i];
+    }
+    const int32_t offset = (sumCur - sumRef) / static_cast<int32_t>(THUMB_PIXELS);
+    const int32_t blockThreshold = config::motion::BLOCK_DIFF_THRESHOLD * BLOCK * BLOCK;
+
+    int changed = 0;
+    for (int by = 0; by < BLOCKS_Y; by++) {
+        for (int bx = 0; bx < BLOCKS_X; bx++) {
+            int32_t sad = 0;
+            for (int y = 0; y < BLOCK; y++) {
+                size_t base = (by * BLOCK + y) * THUMB_WIDTH + bx * BLOCK;
+                for (int x = 0; x < BLOCK; x++) {
+                    sad += std::abs(current[base + x] - reference[base + x] - offset);
+                }
+            }
+            if (sad > blockThreshold) {
+                changed++;
+            }
+        }
+    }
+    return changed;
+}
+
+GateDecision MotionGate::evaluate(const camera_fb_t* frame) {
+    auto& profiler = diagnostics::StageProfiler::instance();
+    diagnostics::ScopedStage stage(diagnostics::Stage::MOTION_GATE);
+
+    GateDecision decision = GateDecision::NOT_RUN;
+    m_changedBlocks = 0;
+
+    if (!frame || !frame->buf || buildThumbnail(frame) != ESP_OK) {
+        ESP_LOGW(TAG, "Thumbnail unavailable, gate bypassed");
+    } else if (!s_referenceValid ||
+               nowSec() - s_referenceTime > config::motion::MAX_REFERENCE_AGE_SECONDS) {
+        decision = GateDecision::NO_REFERENCE;
+    } else {
+        m_changedBlocks = countChangedBlocks(m_thumb, s_reference);
+        decision = (m_changedBlocks >= config::motion::MIN_CHANGED_BLOCKS)
+            ? GateDecision::MOTION : GateDecision::STILL;
+    }
+
+    profiler.setGateResult(static_cast<uint8_t>(decision),
+                           static_cast<uint8_t>(m_changedBlocks));
+    ESP_LOGI(TAG, "Gate: %s (%d/%d blocks changed)", gateDecisionName(decision),
+             m_changedBlocks, BLOCKS_X * BLOCKS_Y);
+    return decision;
+}
+
+void MotionGate::updateReference() {
+    if (!m_thumbValid) {
+        return;
+    }
+    std::memcpy(s_reference, m_thumb, sizeof(s_reference));
+    s_referenceValid = true;
+    s_referenceTime = nowSec();
+    ESP_LOGD(TAG, "Reference thumbnail updated");
+}
+
+} // namespace detection
@@ -0,0 +1,100 @@
+#pragma once
+
+/**
+ * @file motion_gate.hpp
+ * @brief Visual-change pre-filter ahead of the neural network
+ *
+ * Provides:
+ * - Tiny grayscale thumbnail of the detection frame (scaled JPEG decode)
+ * - Block-difference comparison against a reference thumbnail kept in
+ *   RTC memory from the last quiet wake
+ * - Global brightness compensation so AEC shifts are not counted as motion
+ *
+ * PIR wakes caused by heat or wind with no visual change skip inference.
+ */
+
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "app_config.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace detection {
+
+/**
+ * @brief Motion gate outcome (stored in the wake record)
+ */
+enum class GateDecision : uint8_t {
+    NOT_RUN,            // Gate disabled or frame unusable
+    MOTION,             // Scene changed: run inference
+    STILL,              // No visual change: inference skipped
+    NO_REFERENCE        // No valid reference yet: run inference
+};
+
+/**
+ * @brief Get the short display name of a gate decision
+ */
+const char* gateDecisionName(GateDecision decision);
+
+/**
+ * @brief Motion gate
+ *
+ * @code
+ *   MotionGate gate;
+ *   if (gate.evaluate(frame) == GateDecision::STILL) { skip inference }
+ *   ...
+ *   if (!detected) gate.updateReference();   // quiet wake
+ * @endcode
+ */
+class MotionGate {
+public:
+    MotionGate();
+    ~MotionGate() = default;
+
+    // Disable copy operations
+    MotionGate(const MotionGate&) = delete;
+    MotionGate& operator=(const MotionGate&) = delete;
+
+    /**
+     * @brief Compare a frame against the reference thumbnail
+     *
+     * Records its duration and decision in the stage profiler.
+     *
+     * @param frame Detection frame (JPEG or RGB565)
+     * @return GateDecision Decision
+     */
+    GateDecision evaluate(const camera_fb_t* frame);
+
+    /**
+     * @brief Store the last evaluated thumbnail as the new reference
+     *
+     * Call on quiet wakes only (no detection).
+     */
+    void updateReference();
+
+    /**
+     * @brief Changed blocks found by the last evaluate()
+     */
+    int changedBlocks() const { return m_changedBlocks; }
+
+    static constexpr int THUMB_WIDTH = config::motion::THUMB_WIDTH;
+    static constexpr int THUMB_HEIGHT = config::motion::THUMB_HEIGHT;
+    static constexpr size_t THUMB_PIXELS = THUMB_WIDTH * THUMB_HEIGHT;
+
+private:
+    uint8_t m_thumb[THUMB_PIXELS];
+    bool m_thumbValid;
+    int m_changedBlocks;
+
+    /**
+     * @brief Build the grayscale thumbnail of a frame
+     */
+    esp_err_t buildThumbnail(const camera_fb_t* frame);
+
+    /**
+     * @brief Count blocks whose mean absolute difference exceeds the threshold
+     */
+    static int countChangedBlocks(const uint8_t* current, const uint8_t* reference);
+};
+
+} // namespace detection
@@ -0,0 +1,129 @@
+/**
+ * @file psram_arena.cpp
+ * @brief Detection PSRAM arena implementation
+ */
+
+#include "psram_arena.hpp"
+#include "app_config.hpp"
+
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "PsramArena";
+
+namespace detection {
+
+namespace {
+
+#if CONFIG_IDF_TARGET_ESP32P4
+// Hardware JPEG and PPA write by DMA: whole cache lines
+constexpr size_t ALIGNMENT = CONFIG_CACHE_L2_CACHE_LINE_SIZE;
+#else
+constexpr size_t ALIGNMENT = 16;                // JPEG decoder output requirement
+#endif
+constexpr size_t REGION_COUNT = static_cast<size_t>(ArenaRegion::COUNT);
+
+constexpr size_t alignUp(size_t len) {
+    return (len + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+constexpr size_t REGION_SIZES[REGION_COUNT] = {
+    alignUp(config::arena::IMAGE_BYTES),
+    alignUp(config::arena::SCRATCH_BYTES),
+};
+
+constexpr size_t regionOffset(size_t index) {
+    return (index == 0) ? 0 : regionOffset(index - 1) + REGION_SIZES[index - 1];
+}
+
+constexpr size_t TOTAL_SIZE = regionOffset(REGION_COUNT);
+
+const char* const REGION_NAMES[REGION_COUNT] = {"image", "scratch"};
+
+uint8_t* s_block = nullptr;
+bool s_inUse[REGION_COUNT] = {};
+uint32_t s_fallbacks = 0;
+
+/**
+ * @brief Region that starts at ptr (-1 if ptr is not a region base)
+ */
+int regionOf(const void* ptr) {
+    if (!s_block) {
+        return -1;
+    }
+    for (size_t i = 0; i < REGION_COUNT; i++) {
+        if (ptr == s_block + regionOffset(i)) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+esp_err_t PsramArena::reserve() {
+    if (s_block) {
+        return ESP_OK;
+    }
+    s_block = static_cast<uint8_t*>(
+        heap_caps_aligned_alloc(ALIGNMENT, TOTAL_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+    if (!s_block) {
+        ESP_LOGE(TAG, "Failed to reserve %u byte arena", static_cast<unsigned>(TOTAL_SIZE));
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Reserved %u bytes PSRAM (image %u, scratch %u)",
+             static_cast<unsigned>(TOTAL_SIZE),
+             static_cast<unsigned>(REGION_SIZES[static_cast<size_t>(ArenaRegion::IMAGE)]),
+             static_cast<unsigned>(REGION_SIZES[static_cast<size_t>(ArenaRegion::SCRATCH)]));
+    return ESP_OK;
+}
+
+bool PsramArena::isReserved() {
+    return s_block != nullptr;
+}
+
+void* PsramArena::acquire(ArenaRegion region, size_t len) {
+    const size_t index = static_cast<size_t>(region);
+    if (index >= REGION_COUNT) {
+        return nullptr;
+    }
+    if (s_block && !s_inUse[index] && len <= REGION_SIZES[index]) {
+        s_inUse[index] = true;
+        return s_block + regionOffset(index);
+    }
+
+    // First fallback is a warning; fallbackCount() tracks the rest
+    const esp_log_level_t level = (s_fallbacks++ == 0) ? ESP_LOG_WARN : ESP_LOG_DEBUG;
+    ESP_LOG_LEVEL_LOCAL(level, TAG, "%s region %s: %u bytes from the heap", REGION_NAMES[index],
+                        !s_block ? "not reserved" : (s_inUse[index] ? "busy" : "too small"),
+                        static_cast<unsigned>(len));
+    return heap_caps_aligned_alloc(ALIGNMENT, len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+}
+
+void PsramArena::release(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    int index = regionOf(ptr);
+    if (index >= 0) {
+        s_inUse[index] = false;
+    } else {
+        heap_caps_free(ptr);
+    }
+}
+
+size_t PsramArena::regionSize(ArenaRegion region) {
+    const size_t index = static_cast<size_t>(region);
+    return (index < REGION_COUNT) ? REGION_SIZES[index] : 0;
+}
+
+size_t PsramArena::totalSize() {
+    return TOTAL_SIZE;
+}
+
+uint32_t PsramArena::fallbackCount() {
+    return s_fallbacks;
+}
+
+} // namespace detection
@@ -0,0 +1,97 @@
+#pragma once
+
+/**
+ * @file psram_arena.hpp
+ * @brief Fixed PSRAM arena for the detection hot path
+ *
+ * One block is reserved at boot and split into fixed regions, one per
+ * kind of per-frame buffer:
+ * - IMAGE:   decoded RGB565 frame (JpegDecoder output)
+ * - SCRATCH: zone crops fed to the model
+ *
+ * Sizes come from config::arena, so the hot-path budget is known at
+ * build time and the heap is not fragmented by repeated detections
+ * (days of watch mode). The model's tensor arena is a single block
+ * planned by dl::Model itself and stays resident with the Detector.
+ */
+
+#include "esp_err.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace detection {
+
+/**
+ * @brief Arena regions
+ *
+ * Each region hands out one buffer at a time (its base address).
+ */
+enum class ArenaRegion : uint8_t {
+    IMAGE,
+    SCRATCH,
+    COUNT
+};
+
+/**
+ * @brief Static PSRAM arena
+ *
+ * @code
+ *   PsramArena::reserve();                                 // At boot
+ *   void* buf = PsramArena::acquire(ArenaRegion::IMAGE, len);
+ *   ...
+ *   PsramArena::release(buf);
+ * @endcode
+ */
+class PsramArena {
+public:
+    /**
+     * @brief Reserve the arena block (no-op if already reserved)
+     *
+     * @return esp_err_t
+     *         - ESP_OK on success
+     *         - ESP_ERR_NO_MEM if PSRAM cannot hold the block
+     */
+    static esp_err_t reserve();
+
+    /**
+     * @brief Check if the arena block is reserved
+     */
+    static bool isReserved();
+
+    /**
+     * @brief Get a buffer from a region
+     *
+     * Falls back to a heap allocation (the first one logs a warning) if the
+     * arena is not reserved, the region is smaller than len or already
+     * handed out.
+     *
+     * @return Buffer aligned for the decoders (16 bytes, a cache line on
+     *         ESP32-P4), or nullptr if the fallback failed
+     */
+    static void* acquire(ArenaRegion region, size_t len);
+
+    /**
+     * @brief Return a buffer from acquire() (nullptr is ignored)
+     *
+     * Arena buffers go back to their region; fallback buffers (and images
+     * a decoder allocated on its own) are freed to the heap.
+     */
+    static void release(void* ptr);
+
+    /**
+     * @brief Size of one region in bytes
+     */
+    static size_t regionSize(ArenaRegion region);
+
+    /**
+     * @brief Size of the whole block in bytes
+     */
+    static size_t totalSize();
+
+    /**
+     * @brief Number of acquire() calls served from the heap since boot
+     */
+    static uint32_t fallbackCount();
+};
+
+} // namespace detection
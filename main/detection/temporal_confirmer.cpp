@@ -0,0 +1,202 @@
+/**
+ * @file temporal_confirmer.cpp
+ * @brief Temporal confirmation implementation
+ */
+
+#include "temporal_confirmer.hpp"
+#include "app_config.hpp"
+#include "stage_profiler.hpp"
+
+#include "esp_log.h"
+
+#include <algorithm>
+
+static const char* TAG = "Confirmer";
+
+namespace detection {
+
+TemporalConfirmer::TemporalConfirmer(Detector& detector, drivers::CameraDriver& camera)
+    : m_detector(detector)
+    , m_camera(camera)
+    , m_frames(xQueueCreate(1, sizeof(camera_fb_t*)))
+    , m_captureTokens(xSemaphoreCreateCounting(1, 0))
+    , m_producerDone(xSemaphoreCreateBinary())
+    , m_stop(false)
+    , m_framesRun(0)
+{
+}
+
+TemporalConfirmer::~TemporalConfirmer() {
+    if (m_frames) {
+        vQueueDelete(m_frames);
+    }
+    if (m_captureTokens) {
+        vSemaphoreDelete(m_captureTokens);
+    }
+    if (m_producerDone) {
+        vSemaphoreDelete(m_producerDone);
+    }
+}
+
+void TemporalConfirmer::producerTask(void* arg) {
+    TemporalConfirmer* self = static_cast<TemporalConfirmer*>(arg);
+    auto& profiler = diagnostics::StageProfiler::instance();
+
+    while (true) {
+        xSemaphoreTake(self->m_captureTokens, portMAX_DELAY);
+        if (self->m_stop) {
+            break;
+        }
+
+        profiler.start(diagnostics::Stage::CAPTURE);
+        camera_fb_t* fb = self->m_camera.capture();
+        profiler.stop(diagnostics::Stage::CAPTURE);
+
+        // nullptr tells the consumer the capture failed
+        xQueueSend(self->m_frames, &fb, portMAX_DELAY);
+    }
+
+    xSemaphoreGive(self->m_producerDone);
+    vTaskDelete(nullptr);
+}
+
+bool TemporalConfirmer::startProducer() {
+    if (!m_frames || !m_captureTokens || !m_producerDone) {
+        return false;
+    }
+    m_stop = false;
+    BaseType_t ret = xTaskCreatePinnedToCore(
+        &TemporalConfirmer::producerTask, "confirm_cap",
+        config::scheduling::WORKER_STACK_SIZE, this,
+        config::scheduling::WORKER_PRIORITY, nullptr,
+        config::scheduling::WORKER_CORE);
+    return ret == pdPASS;
+}
+
+void TemporalConfirmer::stopProducer() {
+    m_stop = true;
+    xSemaphoreGive(m_captureTokens);
+
+    // Drain the queue until the producer exits, returning finished captures
+    camera_fb_t* fb = nullptr;
+    while (xSemaphoreTake(m_producerDone, pdMS_TO_TICKS(10)) != pdTRUE) {
+        if (xQueueReceive(m_frames, &fb, 0) == pdTRUE) {
+            m_camera.returnFrame(fb);
+        }
+    }
+    while (xQueueReceive(m_frames, &fb, 0) == pdTRUE) {
+        m_camera.returnFrame(fb);
+    }
+}
+
+float TemporalConfirmer::iou(const DetectionResult& a, const DetectionResult& b) {
+    int x1 = std::max(a.x, b.x);
+    int y1 = std::max(a.y, b.y);
+    int x2 = std::min(a.x + a.width, b.x + b.width);
+    int y2 = std::min(a.y + a.height, b.y + b.height);
+    if (x2 <= x1 || y2 <= y1) {
+        return 0.0f;
+    }
+    float inter = static_cast<float>(x2 - x1) * static_cast<float>(y2 - y1);
+    float uni = static_cast<float>(a.width) * a.height +
+                static_cast<float>(b.width) * b.height - inter;
+    return (uni > 0.0f) ? inter / uni : 0.0f;
+}
+
+DetectionResult TemporalConfirmer::confirm(camera_fb_t*& frame) {
+    using namespace config::detection;
+
+    const int total = CONFIRM_FRAMES;
+    m_framesRun = 0;
+
+    // Capture of the next frame overlaps inference of the current one
+    bool pipelined = (total > 1) && startProducer();
+    if (total > 1 && !pipelined) {
+        ESP_LOGW(TAG, "Capture task unavailable, single-frame decision");
+    }
+    if (pipelined) {
+        xSemaphoreGive(m_captureTokens);
+    }
+
+    DetectionResult track = {};         // Box of the best tracked frame
+    camera_fb_t* keptFrame = frame;     // Frame behind 'track'
+    float scoreSum = 0.0f;
+    int positives = 0;
+    int lowFrames = 0;
+    bool accepted = false;
+    bool rejected = false;
+
+    camera_fb_t* current = frame;
+    while (current) {
+        DetectionResult r = m_detector.detect(current);
+        m_framesRun++;
+
+        // Zone thresholds are applied by the detector; sub-threshold
+        // scores still count toward the early reject
+        float score = r.confidence;
+        bool tracked = r.detected &&
+                       (positives == 0 || iou(r, track) >= CONFIRM_TRACK_IOU);
+
+        if (tracked) {
+            positives++;
+            scoreSum += score;
+            if (score > track.confidence || !track.detected) {
+                track = r;
+                if (keptFrame != current) {
+                    m_camera.returnFrame(keptFrame);
+                    keptFrame = current;
+                }
+            }
+        }
+        if (score < REJECT_CONFIDENCE) {
+            lowFrames++;
+        }
+        if (keptFrame != current) {
+            m_camera.returnFrame(current);
+        }
+        current = nullptr;
+
+        // Early exit: clearly above, enough agreement, or no way to reach k
+        int remaining = total - m_framesRun;
+        accepted = (tracked && score >= ACCEPT_CONFIDENCE) || positives >= CONFIRM_REQUIRED;
+        rejected = (positives + remaining < CONFIRM_REQUIRED) ||
+                   (lowFrames == m_framesRun && m_framesRun >= CONFIRM_MIN_REJECT_FRAMES);
+        if (accepted || rejected || remaining == 0 || !pipelined) {
+            break;
+        }
+
+        // Frame i+1 was captured during inference of frame i
+        camera_fb_t* next = nullptr;
+        if (xQueueReceive(m_frames, &next, pdMS_TO_TICKS(CONFIRM_FRAME_TIMEOUT_MS)) != pdTRUE ||
+            !next) {
+            ESP_LOGW(TAG, "No frame from capture task, deciding on %d frame(s)", m_framesRun);
+            break;
+        }
+        current = next;
+        if (remaining > 1) {
+            xSemaphoreGive(m_captureTokens);
+        }
+    }
+
+    if (pipelined) {
+        stopProducer();
+    }
+
+    // Single frame (or truncated burst): fall back to the plain threshold
+    if (!accepted && !rejected) {
+        accepted = (positives >= CONFIRM_REQUIRED) ||
+                   (m_framesRun == 1 && positives == 1);
+    }
+
+    DetectionResult result = track;
+    result.detected = accepted && positives > 0;
+    result.confidence = (positives > 0) ? scoreSum / positives : 0.0f;
+    frame = keptFrame;
+
+    ESP_LOGI(TAG, "%s after %d/%d frame(s): %d positive, fused score %.3f",
+             result.detected ? "Confirmed" : "Rejected",
+             m_framesRun, total, positives, result.confidence);
+    return result;
+}
+
+} // namespace detection
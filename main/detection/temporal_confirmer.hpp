@@ -0,0 +1,79 @@
+#pragma once
+
+/**
+ * @file temporal_confirmer.hpp
+ * @brief Multi-frame detection confirmation with pipelined capture
+ *
+ * Provides:
+ * - k-of-n agreement over a short burst of detection frames
+ * - IoU tracking so only overlapping boxes reinforce each other
+ * - Early exit once the outcome is clearly positive or negative
+ * - Capture of frame i+1 on the worker core while frame i is inferred
+ */
+
+#include "detector.hpp"
+#include "camera_driver.hpp"
+#include "esp_camera.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <atomic>
+
+namespace detection {
+
+/**
+ * @brief Temporal confirmation over several detection frames
+ *
+ * @code
+ *   TemporalConfirmer confirmer(detector, camera);
+ *   DetectionResult result = confirmer.confirm(frame);  // frame may change
+ * @endcode
+ */
+class TemporalConfirmer {
+public:
+    TemporalConfirmer(Detector& detector, drivers::CameraDriver& camera);
+    ~TemporalConfirmer();
+
+    // Disable copy operations
+    TemporalConfirmer(const TemporalConfirmer&) = delete;
+    TemporalConfirmer& operator=(const TemporalConfirmer&) = delete;
+
+    /**
+     * @brief Run detection over up to CONFIRM_FRAMES frames and fuse them
+     *
+     * @param[in,out] frame First frame (already captured). On return, the
+     *                      frame behind the reported box; every other frame
+     *                      has been returned to the camera.
+     *
+     * @return DetectionResult Fused result: detected only if confirmed,
+     *         confidence = mean score of the tracked positives
+     */
+    DetectionResult confirm(camera_fb_t*& frame);
+
+    /**
+     * @brief Number of frames inferred by the last confirm()
+     */
+    int framesRun() const { return m_framesRun; }
+
+private:
+    Detector& m_detector;
+    drivers::CameraDriver& m_camera;
+
+    QueueHandle_t m_frames;             // Captured frames (depth 1)
+    SemaphoreHandle_t m_captureTokens;  // One token = capture one frame
+    SemaphoreHandle_t m_producerDone;
+    std::atomic<bool> m_stop;
+    int m_framesRun;
+
+    /**
+     * @brief Capture task on the worker core
+     */
+    static void producerTask(void* arg);
+
+    bool startProducer();
+    void stopProducer();
+
+    static float iou(const DetectionResult& a, const DetectionResult& b);
+};
+
+} // namespace detection
@@ -0,0 +1,327 @@
+/**
+ * @file energy_meter.cpp
+ * @brief Energy accounting implementation
+ */
+
+#include "energy_meter.hpp"
+#include "app_config.hpp"
+
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_adc/adc_oneshot.h"
+#include "esp_adc/adc_cali.h"
+#include "esp_adc/adc_cali_scheme.h"
+
+#include <cstdio>
+#include <initializer_list>
+#include <sys/time.h>
+
+static const char* TAG = "EnergyMeter";
+
+namespace diagnostics {
+
+namespace {
+
+constexpr float UAS_PER_MAH = 3.6e6f;
+
+/**
+ * @brief Counters for one wake class
+ */
+struct ClassCounters {
+    uint32_t wakes;
+    uint64_t activeUs;
+    uint64_t chargeUas;
+};
+
+/**
+ * @brief Counters for one sleep kind
+ */
+struct SleepCounters {
+    uint64_t us;
+    uint64_t chargeUas;
+};
+
+/**
+ * @brief Totals over a period (report window or since power-on)
+ */
+struct EnergyTotals {
+    int64_t startSec;                       // RTC time the period began
+    ClassCounters wakes[WAKE_CLASS_COUNT];
+    SleepCounters sleeps[SLEEP_KIND_COUNT];
+    uint32_t stubWakes;
+};
+
+const char* const SLEEP_NAMES[SLEEP_KIND_COUNT] = {"armed", "cooldown", "watch"};
+
+int64_t nowUs() {
+    struct timeval tv = {};
+    gettimeofday(&tv, nullptr);
+    return static_cast<int64_t>(tv.tv_sec) * 1000000LL + tv.tv_usec;
+}
+
+/**
+ * @brief Current added on top of the baseline while a stage runs (mA)
+ */
+float stageExtraMa(Stage stage) {
+    switch (stage) {
+        case Stage::SD_MOUNT:
+        case Stage::EVENT_LOG:
+            return config::energy::SD_MA;
+        case Stage::MODEL_LOAD:
+            return config::energy::SECOND_CORE_MA;
+        case Stage::WIFI_CONNECT:
+        case Stage::TELEGRAM_SEND:
+            return config::energy::WIFI_MA;
+        default:
+            return 0.0f;
+    }
+}
+
+float sleepMa(SleepKind kind) {
+    switch (kind) {
+        case SleepKind::ARMED:    return config::energy::DEEP_SLEEP_ARMED_MA;
+        case SleepKind::COOLDOWN: return config::energy::DEEP_SLEEP_TIMER_MA;
+        case SleepKind::WATCH:    return config::energy::LIGHT_SLEEP_MA;
+        default:                  return 0.0f;
+    }
+}
+
+// mA x µs / 1000 = µA·s
+uint64_t toUas(float ma, uint64_t us) {
+    return static_cast<uint64_t>(ma * static_cast<float>(us) / 1000.0f);
+}
+
+float toMah(uint64_t uas) {
+    return static_cast<float>(uas) / UAS_PER_MAH;
+}
+
+uint64_t totalCharge(const EnergyTotals& totals) {
+    uint64_t charge = 0;
+    for (const ClassCounters& c : totals.wakes) {
+        charge += c.chargeUas;
+    }
+    for (const SleepCounters& s : totals.sleeps) {
+        charge += s.chargeUas;
+    }
+    return charge + static_cast<uint64_t>(totals.stubWakes * config::energy::STUB_WAKE_UAS);
+}
+
+} // namespace
+
+// Report window and since-power-on totals (startSec 0 = power-on)
+RTC_DATA_ATTR static EnergyTotals s_window = {};
+RTC_DATA_ATTR static EnergyTotals s_lifetime = {};
+
+// Sleep in progress (0 = none)
+RTC_DATA_ATTR static int64_t s_sleepStartUs = 0;
+RTC_DATA_ATTR static uint8_t s_sleepKind = 0;
+
+// Earliest attempt after an undelivered report (0 = none)
+RTC_DATA_ATTR static int64_t s_reportRetrySec = 0;
+
+uint64_t EnergyMeter::activeCharge(const WakeRecord& record) {
+    // ROM and bootloader: bootUs minus the startup part totalUs already counts
+    uint64_t charge = toUas(config::energy::BOOT_MA,
+                            (record.bootUs > record.appStartUs) ? record.bootUs - record.appStartUs
+                                                                : 0);
+
+    uint32_t appUs = (record.totalUs > record.appStartUs) ? record.totalUs - record.appStartUs : 0;
+    charge += toUas(config::energy::ACTIVE_BASE_MA, record.totalUs);
+
+    // Camera draws from init (or the watch-mode resume) to shutdown
+    const bool cameraOn = record.stageUs[static_cast<size_t>(Stage::CAMERA_INIT)] > 0 ||
+                          record.stageUs[static_cast<size_t>(Stage::CAPTURE)] > 0;
+    if (cameraOn) {
+        charge += toUas(config::energy::CAMERA_MA, appUs);
+    }
+
+    for (size_t i = 0; i < STAGE_COUNT; i++) {
+        charge += toUas(stageExtraMa(static_cast<Stage>(i)), record.stageUs[i]);
+    }
+    return charge;
+}
+
+void EnergyMeter::recordActive(const WakeRecord& record, WakeClass wakeClass) {
+    const size_t index = static_cast<size_t>(wakeClass);
+    if (index >= WAKE_CLASS_COUNT) {
+        return;
+    }
+    const uint64_t charge = activeCharge(record);
+    for (EnergyTotals* totals : {&s_window, &s_lifetime}) {
+        ClassCounters& counters = totals->wakes[index];
+        counters.wakes++;
+        counters.activeUs += record.totalUs;
+        counters.chargeUas += charge;
+    }
+    ESP_LOGD(TAG, "Wake class %u: %lu us, %.3f mAh", static_cast<unsigned>(index),
+             static_cast<unsigned long>(record.totalUs), toMah(charge));
+}
+
+void EnergyMeter::beginSleep(SleepKind kind) {
+    s_sleepStartUs = nowUs();
+    s_sleepKind = static_cast<uint8_t>(kind);
+}
+
+void EnergyMeter::endSleep(uint32_t stubWakes) {
+    if (s_sleepStartUs == 0 || s_sleepKind >= SLEEP_KIND_COUNT) {
+        return;
+    }
+    const int64_t elapsed = nowUs() - s_sleepStartUs;
+    s_sleepStartUs = 0;
+    if (elapsed <= 0) {
+        return;
+    }
+    const SleepKind kind = static_cast<SleepKind>(s_sleepKind);
+    const uint64_t us = static_cast<uint64_t>(elapsed);
+    const uint64_t charge = toUas(sleepMa(kind), us);
+    for (EnergyTotals* totals : {&s_window, &s_lifetime}) {
+        totals->sleeps[s_sleepKind].us += us;
+        totals->sleeps[s_sleepKind].chargeUas += charge;
+        totals->stubWakes += stubWakes;
+    }
+}
+
+int64_t EnergyMeter::secondsUntilReport() {
+    if (config::energy::REPORT_INTERVAL_SECONDS <= 0) {
+        return -1;
+    }
+    const int64_t nowSec = nowUs() / 1000000LL;
+    int64_t remaining = s_window.startSec + config::energy::REPORT_INTERVAL_SECONDS - nowSec;
+    if (s_reportRetrySec != 0 && s_reportRetrySec - nowSec > remaining) {
+        remaining = s_reportRetrySec - nowSec;
+    }
+    return (remaining > 0) ? remaining : 0;
+}
+
+void EnergyMeter::markReported() {
+    s_window = {};
+    s_window.startSec = nowUs() / 1000000LL;
+    s_reportRetrySec = 0;
+}
+
+void EnergyMeter::markReportFailed() {
+    s_reportRetrySec = nowUs() / 1000000LL + config::energy::REPORT_RETRY_SECONDS;
+}
+
+size_t EnergyMeter::formatReport(char* buffer, size_t bufferLen) {
+    if (!buffer || bufferLen == 0) {
+        return 0;
+    }
+    const int64_t nowSec = nowUs() / 1000000LL;
+    const float windowHours = static_cast<float>(nowSec - s_window.startSec) / 3600.0f;
+    const float lifetimeDays = static_cast<float>(nowSec - s_lifetime.startSec) / 86400.0f;
+    const float windowMah = toMah(totalCharge(s_window));
+    const ClassCounters* wakes = s_window.wakes;
+
+    size_t len = 0;
+    auto append = [&](const char* format, auto... args) {
+        if (len < bufferLen) {
+            int n = std::snprintf(buffer + len, bufferLen - len, format, args...);
+            if (n > 0) {
+                len += static_cast<size_t>(n);
+            }
+        }
+    };
+
+    append("🔋 Health report (%.1f h)\n", windowHours);
+    if (windowHours > 0.0f) {
+        append("Model: avg %.2f mA, %.1f mAh/day\n",
+               windowMah / windowHours, windowMah * 24.0f / windowHours);
+    }
+    const int batteryMv = readBatteryMv();
+    if (batteryMv >= 0) {
+        append("Battery: %.2f V\n", batteryMv / 1000.0f);
+    }
+
+    const ClassCounters& pirFalse = wakes[static_cast<size_t>(WakeClass::PIR_FALSE)];
+    const ClassCounters& pirTrue = wakes[static_cast<size_t>(WakeClass::PIR_TRUE)];
+    const ClassCounters& timer = wakes[static_cast<size_t>(WakeClass::TIMER)];
+    const ClassCounters& powerOn = wakes[static_cast<size_t>(WakeClass::POWER_ON)];
+    append("Wakes: PIR %lu (alerts %lu), timer %lu, power-on %lu, stub %lu\n",
+           static_cast<unsigned long>(pirFalse.wakes + pirTrue.wakes),
+           static_cast<unsigned long>(pirTrue.wakes), static_cast<unsigned long>(timer.wakes),
+           static_cast<unsigned long>(powerOn.wakes),
+           static_cast<unsigned long>(s_window.stubWakes));
+
+    // Per-wake cost is what the watch / speculative WiFi decisions trade off
+    struct { const char* name; const ClassCounters& counters; } classes[] = {
+        {"false alarm", pirFalse}, {"alert", pirTrue}, {"timer", timer},
+    };
+    for (const auto& c : classes) {
+        if (c.counters.wakes > 0) {
+            append("%s: %.3f mAh/wake, %.1f s/wake, %.2f mAh\n", c.name,
+                   toMah(c.counters.chargeUas) / c.counters.wakes,
+                   static_cast<float>(c.counters.activeUs) / 1e6f / c.counters.wakes,
+                   toMah(c.counters.chargeUas));
+        }
+    }
+
+    append("Sleep:");
+    for (size_t i = 0; i < SLEEP_KIND_COUNT; i++) {
+        const SleepCounters& sleeps = s_window.sleeps[i];
+        if (sleeps.us > 0) {
+            append(" %s %.1f h %.2f mAh", SLEEP_NAMES[i],
+                   static_cast<float>(sleeps.us) / 3.6e9f, toMah(sleeps.chargeUas));
+        }
+    }
+    append("\nSince power-on: %.1f d, %.1f mAh", lifetimeDays, toMah(totalCharge(s_lifetime)));
+
+    if (len >= bufferLen) {
+        len = bufferLen - 1;
+    }
+    return len;
+}
+
+int EnergyMeter::readBatteryMv() {
+    if (config::energy::BATTERY_ADC_GPIO < 0) {
+        return -1;
+    }
+
+    adc_unit_t unit;
+    adc_channel_t channel;
+    if (adc_oneshot_io_to_channel(config::energy::BATTERY_ADC_GPIO, &unit, &channel) != ESP_OK) {
+        ESP_LOGW(TAG, "GPIO %d is not an ADC pin", config::energy::BATTERY_ADC_GPIO);
+        return -1;
+    }
+
+    adc_oneshot_unit_handle_t adc = nullptr;
+    adc_oneshot_unit_init_cfg_t unitConfig = {};
+    unitConfig.unit_id = unit;
+    if (adc_oneshot_new_unit(&unitConfig, &adc) != ESP_OK) {
+        return -1;
+    }
+    adc_oneshot_chan_cfg_t channelConfig = {};
+    channelConfig.atten = ADC_ATTEN_DB_12;
+    channelConfig.bitwidth = ADC_BITWIDTH_DEFAULT;
+    adc_oneshot_config_channel(adc, channel, &channelConfig);
+
+    int mv = -1;
+#if ADC_CALI_SCHEME_CURVE_FITTING_SUPPORTED
+    adc_cali_handle_t cali = nullptr;
+    adc_cali_curve_fitting_config_t caliConfig = {};
+    caliConfig.unit_id = unit;
+    caliConfig.chan = channel;
+    caliConfig.atten = channelConfig.atten;
+    caliConfig.bitwidth = channelConfig.bitwidth;
+    if (adc_cali_create_scheme_curve_fitting(&caliConfig, &cali) == ESP_OK) {
+        int sum = 0;
+        int samples = 0;
+        for (int i = 0; i < config::energy::BATTERY_SAMPLES; i++) {
+            int sample = 0;
+            if (adc_oneshot_get_calibrated_result(adc, cali, channel, &sample) == ESP_OK) {
+                sum += sample;
+                samples++;
+            }
+        }
+        if (samples > 0) {
+            mv = static_cast<int>(static_cast<float>(sum) / samples *
+                                  config::energy::BATTERY_DIVIDER_RATIO);
+        }
+        adc_cali_delete_scheme_curve_fitting(cali);
+    }
+#endif
+    adc_oneshot_del_unit(adc);
+    return mv;
+}
+
+} // namespace diagnostics
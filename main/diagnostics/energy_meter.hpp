@@ -0,0 +1,129 @@
+#pragma once
+
+/**
+ * @file energy_meter.hpp
+ * @brief Charge-per-wake accounting and the periodic health report
+ *
+ * Provides:
+ * - Charge of each wake from its stage durations and the per-stage
+ *   current model in config::energy (boot, baseline, camera, SD, CPU, radio)
+ * - Charge of each sleep from its duration and kind (armed, cooldown,
+ *   watch-mode light sleep), including wakes the wake stub absorbed
+ * - Rolling counters in RTC memory by wake class, for the current report
+ *   window and since power-on
+ * - Optional battery voltage from an ADC divider
+ *   (config::energy::BATTERY_ADC_GPIO)
+ * - A Telegram health message every REPORT_INTERVAL_SECONDS
+ *
+ * Charges are in µA·s; 3.6e6 µA·s = 1 mAh.
+ */
+
+#include "stage_profiler.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace diagnostics {
+
+/**
+ * @brief Wake classes the counters are kept for
+ */
+enum class WakeClass : uint8_t {
+    POWER_ON,           // Reset or first boot
+    TIMER,              // Maintenance / cooldown-end / watch idle timeout
+    PIR_FALSE,          // PIR (or watch trigger) without an alert
+    PIR_TRUE,           // PIR (or watch trigger) that sent an alert
+    COUNT
+};
+
+/**
+ * @brief What the device did between two active periods
+ */
+enum class SleepKind : uint8_t {
+    ARMED,              // Deep sleep with the PIR (RTC IO) wake enabled
+    COOLDOWN,           // Deep sleep on the timer only
+    WATCH,              // Watch-mode automatic light sleep
+    COUNT
+};
+
+constexpr size_t WAKE_CLASS_COUNT = static_cast<size_t>(WakeClass::COUNT);
+constexpr size_t SLEEP_KIND_COUNT = static_cast<size_t>(SleepKind::COUNT);
+
+/**
+ * @brief Energy counters (static, RTC resident)
+ *
+ * SleepManager feeds it: recordActive() with every finished wake
+ * record, beginSleep() / endSleep() around every sleep.
+ *
+ * @code
+ *   if (EnergyMeter::isReportDue()) {
+ *       char text[512];
+ *       EnergyMeter::formatReport(text, sizeof(text));
+ *       if (telegram.sendMessage(text) == ESP_OK) {
+ *           EnergyMeter::markReported();
+ *       }
+ *   }
+ * @endcode
+ */
+class EnergyMeter {
+public:
+    /**
+     * @brief Account one active period (a wake, or a watch-mode cycle)
+     */
+    static void recordActive(const WakeRecord& record, WakeClass wakeClass);
+
+    /**
+     * @brief Note the start of a sleep (right before it is entered)
+     */
+    static void beginSleep(SleepKind kind);
+
+    /**
+     * @brief Account the sleep that just ended
+     *
+     * @param stubWakes Wakes the wake stub sent back to sleep meanwhile
+     */
+    static void endSleep(uint32_t stubWakes);
+
+    /**
+     * @brief Charge the model assigns to a wake record (µA·s)
+     */
+    static uint64_t activeCharge(const WakeRecord& record);
+
+    /**
+     * @brief Seconds until the next health report (0 = due)
+     */
+    static int64_t secondsUntilReport();
+
+    /**
+     * @brief Check whether the health report is due
+     */
+    static bool isReportDue() { return secondsUntilReport() == 0; }
+
+    /**
+     * @brief Format the health message for the current window
+     *
+     * @return size_t Characters written (excluding terminator)
+     */
+    static size_t formatReport(char* buffer, size_t bufferLen);
+
+    /**
+     * @brief Start a new report window (after the report was delivered)
+     */
+    static void markReported();
+
+    /**
+     * @brief Hold the next attempt off for REPORT_RETRY_SECONDS
+     *
+     * After a report that could not be sent (no WiFi, Telegram error).
+     * The window stays open, so the late report still covers it all.
+     */
+    static void markReportFailed();
+
+    /**
+     * @brief Battery voltage from the ADC divider
+     *
+     * @return Millivolts, or -1 if no battery ADC is configured or the read failed
+     */
+    static int readBatteryMv();
+};
+
+} // namespace diagnostics
@@ -0,0 +1,268 @@
+/**
+ * @file log_buffer.cpp
+ * @brief Deferred console logging implementation
+ */
+
+#include "log_buffer.hpp"
+#include "app_config.hpp"
+
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace diagnostics {
+
+namespace {
+
+constexpr uint32_t RING_MAGIC = 0x4C4F4742;     // "LOGB"
+constexpr size_t RING_SIZE = config::debug::LOG_BUFFER_SIZE;
+constexpr size_t LINE_MAX = 192;                // Longer lines are cut
+
+/**
+ * @brief Log ring (RTC_NOINIT: kept through deep sleep and software resets)
+ */
+struct LogRing {
+    uint32_t magic;
+    uint32_t head;          // Next write position
+    uint32_t used;          // Valid bytes ending at head
+    char data[RING_SIZE];
+};
+
+RTC_NOINIT_ATTR LogRing s_ring;
+
+vprintf_like_t s_console = nullptr;     // Sink esp_log used before install()
+SemaphoreHandle_t s_lock = nullptr;
+StaticSemaphore_t s_lockStorage;
+
+int console(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = s_console ? s_console(format, args) : std::vprintf(format, args);
+    va_end(args);
+    return n;
+}
+
+/**
+ * @brief Level letter of an esp_log format (after an optional colour code)
+ */
+char levelOf(const char* format) {
+    if (format[0] == '\033') {
+        const char* end = std::strchr(format, 'm');
+        if (!end) {
+            return '\0';
+        }
+        format = end + 1;
+    }
+    return format[0];
+}
+
+/**
+ * @brief Check for an empty message or a box-drawing banner line
+ */
+bool isDecorative(const char* format) {
+    const char* message = std::strstr(format, "%s: ");
+    if (!message) {
+        return false;
+    }
+    const unsigned char* text = reinterpret_cast<const unsigned char*>(message + 4);
+    // Empty (newline or colour reset next), or U+2500..U+257F in UTF-8
+    return text[0] == '\n' || text[0] == '\033' ||
+           (text[0] == 0xE2 && (text[1] == 0x94 || text[1] == 0x95));
+}
+
+/**
+ * @brief Remove colour escape sequences in place
+ */
+size_t stripColours(char* line, size_t len) {
+    size_t out = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (line[i] == '\033') {
+            while (i < len && line[i] != 'm') {
+                i++;
+            }
+            continue;
+        }
+        line[out++] = line[i];
+    }
+    return out;
+}
+
+size_t oldest() {
+    return (s_ring.head + RING_SIZE - s_ring.used) % RING_SIZE;
+}
+
+char at(size_t start, size_t offset) {
+    return s_ring.data[(start + offset) % RING_SIZE];
+}
+
+/**
+ * @brief Offset of the first whole line at least dropBytes past the oldest byte
+ *
+ * Once the ring has wrapped, the oldest line is cut and always skipped.
+ */
+size_t firstLine(size_t start, size_t dropBytes) {
+    if (s_ring.used == RING_SIZE) {
+        dropBytes = std::max<size_t>(dropBytes, 1);
+    }
+    if (dropBytes == 0) {
+        return 0;
+    }
+    size_t offset = dropBytes - 1;
+    while (offset < s_ring.used && at(start, offset) != '\n') {
+        offset++;
+    }
+    return offset + 1;
+}
+
+// Callers hold s_lock
+void append(const char* text, size_t len) {
+    if (len > RING_SIZE) {
+        text += len - RING_SIZE;
+        len = RING_SIZE;
+    }
+    const size_t first = std::min(len, RING_SIZE - s_ring.head);
+    std::memcpy(s_ring.data + s_ring.head, text, first);
+    std::memcpy(s_ring.data, text + first, len - first);
+    s_ring.head = (s_ring.head + len) % RING_SIZE;
+    s_ring.used = std::min<uint32_t>(s_ring.used + len, RING_SIZE);
+}
+
+int bufferedVprintf(const char* format, va_list args) {
+    const char level = levelOf(format);
+    if (level == 'E' || level == 'W') {
+        // Context first, so the console shows what led to the error
+        if (level == 'E') {
+            LogBuffer::flush();
+        }
+        return s_console(format, args);
+    }
+    if (isDecorative(format)) {
+        return 0;
+    }
+
+    char line[LINE_MAX];
+    int n = std::vsnprintf(line, sizeof(line), format, args);
+    if (n <= 0) {
+        return n;
+    }
+    size_t len = std::min(static_cast<size_t>(n), LINE_MAX - 1);
+    if (static_cast<size_t>(n) >= LINE_MAX) {
+        line[len - 1] = '\n';
+    }
+    len = stripColours(line, len);
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    append(line, len);
+    xSemaphoreGive(s_lock);
+    return n;
+}
+
+bool crashReset(esp_reset_reason_t reason) {
+    switch (reason) {
+        case ESP_RST_PANIC:
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:
+        case ESP_RST_BROWNOUT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+void LogBuffer::install() {
+    if (config::debug::VERBOSE_LOGGING || s_console) {
+        return;
+    }
+
+    // Power-on leaves RTC_NOINIT memory undefined
+    if (s_ring.magic != RING_MAGIC || s_ring.head >= RING_SIZE || s_ring.used > RING_SIZE) {
+        s_ring.magic = RING_MAGIC;
+        s_ring.head = 0;
+        s_ring.used = 0;
+    }
+    s_lock = xSemaphoreCreateMutexStatic(&s_lockStorage);
+    s_console = esp_log_set_vprintf(&bufferedVprintf);
+
+    const esp_reset_reason_t reason = esp_reset_reason();
+    if (crashReset(reason) && s_ring.used > 0) {
+        console("--- Buffered log before reset (reason %d) ---\n", static_cast<int>(reason));
+        flush();
+    }
+
+    char marker[32];
+    int n = std::snprintf(marker, sizeof(marker), "--- boot, reset %d ---\n",
+                          static_cast<int>(reason));
+    if (n > 0) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        append(marker, std::min(static_cast<size_t>(n), sizeof(marker) - 1));
+        xSemaphoreGive(s_lock);
+    }
+}
+
+bool LogBuffer::isBuffering() {
+    return s_console != nullptr;
+}
+
+void LogBuffer::flush() {
+    if (!s_console) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    const size_t skip = std::min<size_t>(firstLine(oldest(), 0), s_ring.used);
+    const size_t start = (oldest() + skip) % RING_SIZE;
+    const size_t len = s_ring.used - skip;
+    const size_t first = std::min(len, RING_SIZE - start);
+    if (first > 0) {
+        console("%.*s", static_cast<int>(first), s_ring.data + start);
+    }
+    if (len > first) {
+        console("%.*s", static_cast<int>(len - first), s_ring.data);
+    }
+    s_ring.used = 0;
+    xSemaphoreGive(s_lock);
+}
+
+size_t LogBuffer::read(char* buffer, size_t bufferLen) {
+    if (!buffer || bufferLen == 0) {
+        return 0;
+    }
+    buffer[0] = '\0';
+    if (!s_console) {
+        return 0;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    // Whole lines only: drop whatever does not fit
+    const size_t start = oldest();
+    const size_t overflow = (s_ring.used > bufferLen - 1) ? s_ring.used - (bufferLen - 1) : 0;
+    const size_t skip = firstLine(start, overflow);
+
+    size_t len = 0;
+    for (size_t i = skip; i < s_ring.used && len + 1 < bufferLen; i++) {
+        buffer[len++] = at(start, i);
+    }
+    buffer[len] = '\0';
+    xSemaphoreGive(s_lock);
+    return len;
+}
+
+void LogBuffer::clear() {
+    if (!s_console) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_ring.used = 0;
+    xSemaphoreGive(s_lock);
+}
+
+} // namespace diagnostics
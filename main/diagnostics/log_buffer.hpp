@@ -0,0 +1,68 @@
+#pragma once
+
+/**
+ * @file log_buffer.hpp
+ * @brief Deferred console logging for production builds
+ *
+ * At 115200 baud every log line blocks its task for about 87 µs per
+ * character, which puts the console on the wake-to-sleep path. With
+ * config::debug::VERBOSE_LOGGING off, install() routes esp_log output
+ * into a ring buffer in RTC memory instead:
+ * - Info/debug lines are only buffered; decorative banner lines (empty,
+ *   or box drawing) are dropped
+ * - A warning goes straight to the console; an error first writes out
+ *   the buffered lines before it, so the context is not lost
+ * - The buffer survives deep sleep and crash resets; after a panic,
+ *   watchdog or brownout reset it is written out at the next boot
+ * - flush() and read() write it out on demand (Telegram /logs)
+ */
+
+#include <cstdint>
+#include <cstddef>
+
+namespace diagnostics {
+
+/**
+ * @brief RTC ring buffer behind esp_log (static)
+ *
+ * @code
+ *   LogBuffer::install();                      // First thing in app_main()
+ *   ...
+ *   char text[config::debug::LOG_BUFFER_SIZE + 1];
+ *   LogBuffer::read(text, sizeof(text));       // Oldest line first
+ * @endcode
+ */
+class LogBuffer {
+public:
+    /**
+     * @brief Route esp_log into the buffer (nothing with VERBOSE_LOGGING)
+     */
+    static void install();
+
+    /**
+     * @brief Check whether log lines are being buffered
+     */
+    static bool isBuffering();
+
+    /**
+     * @brief Write the buffered lines to the console and clear the buffer
+     */
+    static void flush();
+
+    /**
+     * @brief Copy the buffered lines out, oldest first
+     *
+     * A line cut by the ring wrap is skipped. Output is null-terminated;
+     * when it does not fit, the newest lines are kept.
+     *
+     * @return size_t Number of characters written (excluding terminator)
+     */
+    static size_t read(char* buffer, size_t bufferLen);
+
+    /**
+     * @brief Drop the buffered lines
+     */
+    static void clear();
+};
+
+} // namespace diagnostics
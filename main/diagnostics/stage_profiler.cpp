@@ -0,0 +1,156 @@
+/**
+ * @file stage_profiler.cpp
+ * @brief Stage profiler implementation
+ */
+
+#include "stage_profiler.hpp"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_app_desc.h"
+
+#include <cstdio>
+#include <cstring>
+
+static const char* TAG = "Profiler";
+
+namespace diagnostics {
+
+static const char* const STAGE_NAMES[STAGE_COUNT] = {
+    "sd",
+    "cam",
+    "warm",
+    "cap",
+    "gate",
+    "model",
+    "dec",
+    "inf",
+    "hires",
+    "wifi",
+    "tg",
+    "log",
+    "off",
+};
+
+const char* stageName(Stage stage) {
+    size_t index = static_cast<size_t>(stage);
+    return (index < STAGE_COUNT) ? STAGE_NAMES[index] : "?";
+}
+
+StageProfiler& StageProfiler::instance() {
+    static StageProfiler s_instance;
+    return s_instance;
+}
+
+StageProfiler::StageProfiler()
+    : m_record{}
+    , m_stageStartUs{}
+    , m_originUs(0)
+    , m_begun(false)
+{
+}
+
+void StageProfiler::begin(uint32_t sequence, uint8_t wakeReason) {
+    std::memset(&m_record, 0, sizeof(m_record));
+    std::memset(m_stageStartUs, 0, sizeof(m_stageStartUs));
+
+    const esp_app_desc_t* app = esp_app_get_description();
+    std::memcpy(&m_record.buildId, app->app_elf_sha256, sizeof(m_record.buildId));
+
+    m_record.sequence = sequence;
+    m_record.wakeReason = wakeReason;
+
+    // The first record of a boot starts at reset; watch-mode cycles
+    // start at their trigger
+    int64_t now = esp_timer_get_time();
+    m_originUs = m_begun ? now : 0;
+    m_record.appStartUs = m_begun ? 0 : static_cast<uint32_t>(now);
+    m_begun = true;
+}
+
+void StageProfiler::start(Stage stage) {
+    size_t index = static_cast<size_t>(stage);
+    if (index >= STAGE_COUNT) {
+        return;
+    }
+    m_stageStartUs[index] = esp_timer_get_time();
+}
+
+void StageProfiler::stop(Stage stage) {
+    size_t index = static_cast<size_t>(stage);
+    if (index >= STAGE_COUNT || m_stageStartUs[index] == 0) {
+        return;
+    }
+    int64_t elapsed = esp_timer_get_time() - m_stageStartUs[index];
+    m_record.stageUs[index] += static_cast<uint32_t>(elapsed);
+    m_stageStartUs[index] = 0;
+}
+
+void StageProfiler::setBootInfo(uint32_t bootUs, uint32_t stubWakes) {
+    m_record.bootUs = bootUs;
+    m_record.stubWakes = static_cast<uint8_t>((stubWakes > UINT8_MAX) ? UINT8_MAX : stubWakes);
+}
+
+void StageProfiler::setGateResult(uint8_t decision, uint8_t changedBlocks) {
+    m_record.gateDecision = decision;
+    m_record.gateChangedBlocks = changedBlocks;
+}
+
+const WakeRecord& StageProfiler::finish() {
+    m_record.totalUs = static_cast<uint32_t>(esp_timer_get_time() - m_originUs);
+    return m_record;
+}
+
+void StageProfiler::logRecord(const WakeRecord& record) {
+    ESP_LOGI(TAG, "Wake #%lu [build %08lx] reason=%u gate=%u/%u stub=%u boot=%lu us "
+             "app_start=%lu us total=%lu us",
+             static_cast<unsigned long>(record.sequence),
+             static_cast<unsigned long>(record.buildId),
+             record.wakeReason,
+             record.gateDecision, record.gateChangedBlocks,
+             record.stubWakes,
+             static_cast<unsigned long>(record.bootUs),
+             static_cast<unsigned long>(record.appStartUs),
+             static_cast<unsigned long>(record.totalUs));
+
+    for (size_t i = 0; i < STAGE_COUNT; i++) {
+        if (record.stageUs[i] == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "  %-5s %8lu us", STAGE_NAMES[i],
+                 static_cast<unsigned long>(record.stageUs[i]));
+    }
+}
+
+size_t StageProfiler::formatSummary(const WakeRecord& record, char* buffer, size_t bufferLen) {
+    if (!buffer || bufferLen == 0) {
+        return 0;
+    }
+
+    int written = std::snprintf(buffer, bufferLen, "#%lu %lums boot=%lu",
+                                static_cast<unsigned long>(record.sequence),
+                                static_cast<unsigned long>(record.totalUs / 1000),
+                                static_cast<unsigned long>(record.bootUs / 1000));
+    if (written < 0) {
+        buffer[0] = '\0';
+        return 0;
+    }
+
+    size_t offset = static_cast<size_t>(written);
+    for (size_t i = 0; i < STAGE_COUNT && offset < bufferLen; i++) {
+        if (record.stageUs[i] == 0) {
+            continue;
+        }
+        written = std::snprintf(buffer + offset, bufferLen - offset, " %s=%lu",
+                                STAGE_NAMES[i],
+                                static_cast<unsigned long>(record.stageUs[i] / 1000));
+        if (written < 0) {
+            break;
+        }
+        offset += static_cast<size_t>(written);
+    }
+
+    return (offset < bufferLen) ? offset : bufferLen - 1;
+}
+
+} // namespace diagnostics
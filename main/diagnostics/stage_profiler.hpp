@@ -0,0 +1,182 @@
+#pragma once
+
+/**
+ * @file stage_profiler.hpp
+ * @brief Per-wake stage timing for the detection pipeline
+ *
+ * Provides:
+ * - esp_timer based duration capture for each pipeline stage
+ * - Compact wake records suitable for RTC memory
+ * - Serial dump and one-line summary for Telegram messages
+ *
+ * @note Records are persisted across deep sleep by power::SleepManager
+ */
+
+#include <cstdint>
+#include <cstddef>
+
+namespace diagnostics {
+
+/**
+ * @brief Pipeline stages measured on each wake
+ */
+enum class Stage : uint8_t {
+    SD_MOUNT,           // SdCardDriver::mount()
+    CAMERA_INIT,        // CameraDriver::init()
+    CAMERA_WARMUP,      // CameraDriver::warmup()
+    CAPTURE,            // CameraDriver::capture()
+    MOTION_GATE,        // detection::MotionGate::evaluate()
+    MODEL_LOAD,         // Detector::loadModel() (may overlap other stages)
+    JPEG_DECODE,        // JPEG decode inside Detector::detect()
+    INFERENCE,          // Model inference inside Detector::detect()
+    ALERT_CAPTURE,      // Switch to alert stream + high-res capture
+    WIFI_CONNECT,       // WifiManager::connect()
+    TELEGRAM_SEND,      // TelegramClient::sendDocument()
+    EVENT_LOG,          // drivers::EventLog appends
+    SHUTDOWN,           // Hardware shutdown before deep sleep
+    COUNT
+};
+
+constexpr size_t STAGE_COUNT = static_cast<size_t>(Stage::COUNT);
+
+/**
+ * @brief Timing record for a single wake
+ *
+ * Kept small and POD so it can live in an RTC_DATA_ATTR ring buffer.
+ */
+struct WakeRecord {
+    uint32_t sequence;                  // Monotonic wake counter
+    uint32_t buildId;                   // First 4 bytes of app ELF SHA-256
+    uint8_t  wakeReason;                // power::WakeReason value
+    uint8_t  gateDecision;              // detection::GateDecision value
+    uint8_t  gateChangedBlocks;         // Blocks the motion gate saw change
+    uint8_t  stubWakes;                 // Wakes the wake stub absorbed before this one (saturated)
+    uint32_t bootUs;                    // RTC wake to app_main() incl. ROM + bootloader (0 = n/a)
+    uint32_t appStartUs;                // esp_timer time at app_main() entry (0 = watch cycle)
+    uint32_t totalUs;                   // Wake (or watch trigger) to deep sleep or next wait
+    uint32_t stageUs[STAGE_COUNT];      // Stage durations (0 = not run)
+};
+
+/**
+ * @brief Get the short display name of a stage
+ */
+const char* stageName(Stage stage);
+
+/**
+ * @brief Stage profiler for the current wake
+ *
+ * Single instance shared by the application and the drivers so that
+ * stages inside library calls (e.g. Detector::detect) can be timed
+ * without threading a profiler reference through every API.
+ *
+ * @code
+ *   auto& profiler = diagnostics::StageProfiler::instance();
+ *   profiler.start(diagnostics::Stage::SD_MOUNT);
+ *   sdCard.mount();
+ *   profiler.stop(diagnostics::Stage::SD_MOUNT);
+ * @endcode
+ */
+class StageProfiler {
+public:
+    /**
+     * @brief Get the profiler instance
+     */
+    static StageProfiler& instance();
+
+    // Disable copy operations
+    StageProfiler(const StageProfiler&) = delete;
+    StageProfiler& operator=(const StageProfiler&) = delete;
+
+    /**
+     * @brief Reset the record for a new wake
+     *
+     * @param sequence   Wake sequence number
+     * @param wakeReason Wake reason (power::WakeReason as integer)
+     */
+    void begin(uint32_t sequence, uint8_t wakeReason);
+
+    /**
+     * @brief Record how this wake reached app_main()
+     *
+     * @param bootUs    Wake to app_main() on the RTC clock (0 = not measured)
+     * @param stubWakes Wakes the wake stub absorbed since the previous boot
+     */
+    void setBootInfo(uint32_t bootUs, uint32_t stubWakes);
+
+    /**
+     * @brief Mark the start of a stage
+     */
+    void start(Stage stage);
+
+    /**
+     * @brief Mark the end of a stage
+     *
+     * Durations accumulate, so a stage run more than once in a wake
+     * reports its total time.
+     */
+    void stop(Stage stage);
+
+    /**
+     * @brief Record the motion gate outcome for this wake
+     *
+     * @param decision      detection::GateDecision as integer
+     * @param changedBlocks Changed thumbnail blocks
+     */
+    void setGateResult(uint8_t decision, uint8_t changedBlocks);
+
+    /**
+     * @brief Close the record (called right before deep sleep or a watch-mode wait)
+     *
+     * @return const WakeRecord& The finished record
+     */
+    const WakeRecord& finish();
+
+    /**
+     * @brief Get the record being built for this wake
+     */
+    const WakeRecord& current() const { return m_record; }
+
+    /**
+     * @brief Log a wake record to serial
+     */
+    static void logRecord(const WakeRecord& record);
+
+    /**
+     * @brief Format a wake record as a single line
+     *
+     * @param record Record to format
+     * @param buffer Output buffer
+     * @param bufferLen Size of output buffer
+     * @return size_t Number of characters written (excluding terminator)
+     */
+    static size_t formatSummary(const WakeRecord& record, char* buffer, size_t bufferLen);
+
+private:
+    StageProfiler();
+
+    WakeRecord m_record;
+    int64_t m_stageStartUs[STAGE_COUNT];
+    int64_t m_originUs;                 // esp_timer time the record counts from
+    bool m_begun;                       // A record was begun since boot
+};
+
+/**
+ * @brief RAII helper that times a stage for the lifetime of a scope
+ */
+class ScopedStage {
+public:
+    explicit ScopedStage(Stage stage) : m_stage(stage) {
+        StageProfiler::instance().start(m_stage);
+    }
+    ~ScopedStage() {
+        StageProfiler::instance().stop(m_stage);
+    }
+
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+
+private:
+    Stage m_stage;
+};
+
+} // namespace diagnostics
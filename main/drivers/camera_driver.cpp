@@ -6,19 +6,44 @@
 #include "camera_driver.hpp"
 #include "board_config.hpp"
 #include "app_config.hpp"
+#include "runtime_config.hpp"
 
 #include "esp_log.h"
 #include "driver/gpio.h"
 #include "driver/ledc.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_attr.h"
+
+#include <algorithm>
+#include <cstdlib>
 
 static const char* TAG = "CameraDriver";
 
+// OV2640 sensor-bank registers (bank select in bit 8 for get_reg/set_reg)
+static constexpr int OV2640_REG_GAIN   = 0x100;  // AGC[7:0]
+static constexpr int OV2640_REG_REG04  = 0x104;  // AEC[1:0] in bits [1:0]
+static constexpr int OV2640_REG_COM2   = 0x109;  // Standby in bit 4
+static constexpr int OV2640_REG_AEC    = 0x110;  // AEC[9:2]
+static constexpr int OV2640_REG_REG45  = 0x145;  // AGC[9:8] in [7:6], AEC[15:10] in [5:0]
+static constexpr int OV2640_COM2_STANDBY = 0x10;  // COM2 standby bit
+
+// Last converged exposure (survives deep sleep)
+struct ExposureState {
+    bool valid;
+    uint16_t aec;
+    uint16_t gain;
+};
+RTC_DATA_ATTR static ExposureState s_lastExposure = {false, 0, 0};
+
 namespace drivers {
 
 CameraDriver::CameraDriver()
     : m_initialized(false)
+    , m_mode(CaptureMode::ALERT)
+    , m_alertFrameSize(config::camera::ALERT_FRAME_SIZE)
+    , m_alertQuality(0)
+    , m_quality(0)
 {
 }
 
@@ -64,9 +89,9 @@ esp_err_t CameraDriver::init() {
     // Clock and format settings
     config.xclk_freq_hz = config::camera::XCLK_FREQ_HZ;
     config.pixel_format = PIXFORMAT_JPEG;
-    config.frame_size = FRAMESIZE_SXGA;  // 1280x1024 for object detection
-    config.jpeg_quality = config::camera::JPEG_QUALITY;
-    config.fb_count = config::camera::FB_COUNT;
+    config.frame_size = config::camera::ALERT_FRAME_SIZE;  // Sizes frame buffers
+    config.jpeg_quality = config::RuntimeConfig::get(config::Setting::JPEG_QUALITY);
+    config.fb_count = config::RuntimeConfig::get(config::Setting::FB_COUNT);
     config.fb_location = CAMERA_FB_IN_PSRAM;
     config.grab_mode = CAMERA_GRAB_LATEST;
     
@@ -88,11 +113,118 @@ esp_err_t CameraDriver::init() {
     }
     
     m_initialized = true;
+    m_mode = CaptureMode::ALERT;
+    m_quality = config.jpeg_quality;
+    
+    // Run warmup and inference on the low-res stream
+    err = setCaptureMode(CaptureMode::DETECTION);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Detection stream unavailable, staying at alert resolution");
+    }
+    
+    // Start AEC/AGC close to where they settled on the previous wake
+    preloadExposure(sensor);
+    
     ESP_LOGI(TAG, "Camera initialized successfully");
     
     return ESP_OK;
 }
 
+esp_err_t CameraDriver::setCaptureMode(CaptureMode mode) {
+    if (!m_initialized) {
+        ESP_LOGE(TAG, "Camera not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (mode == m_mode) {
+        return ESP_OK;
+    }
+    
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (!sensor) {
+        ESP_LOGE(TAG, "Failed to get camera sensor!");
+        return ESP_FAIL;
+    }
+    
+    const int baseQuality = config::RuntimeConfig::get(config::Setting::JPEG_QUALITY);
+    framesize_t frameSize = config::camera::DETECTION_FRAME_SIZE;
+    int quality = baseQuality;
+    if (mode == CaptureMode::ALERT) {
+        frameSize = m_alertFrameSize;
+        quality = std::max(m_alertQuality, baseQuality);
+    }
+    
+    // Register-level window/scaler change; buffers were sized for
+    // ALERT_FRAME_SIZE at init so no reallocation is needed.
+    if (sensor->set_framesize(sensor, frameSize) != 0) {
+        ESP_LOGE(TAG, "Sensor rejected frame size %d", frameSize);
+        return ESP_FAIL;
+    }
+    if (quality != m_quality) {
+        if (sensor->set_quality(sensor, quality) != 0) {
+            ESP_LOGW(TAG, "Sensor rejected JPEG quality %d", quality);
+        } else {
+            m_quality = quality;
+        }
+    }
+    
+    // Drop frames that were queued at the previous resolution
+    for (int i = 0; i < config::camera::MODE_SWITCH_DISCARD_FRAMES; i++) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (fb) {
+            esp_camera_fb_return(fb);
+        }
+    }
+    
+    m_mode = mode;
+    ESP_LOGI(TAG, "Capture mode: %s (%dx%d, quality %d)",
+             (mode == CaptureMode::DETECTION) ? "detection" : "alert",
+             resolution[frameSize].width, resolution[frameSize].height, m_quality);
+    
+    return ESP_OK;
+}
+
+void CameraDriver::setAlertEncoding(framesize_t frameSize, int quality) {
+    // Frame sizes are ordered by resolution; larger ones overflow the buffers
+    m_alertFrameSize = (frameSize <= config::camera::ALERT_FRAME_SIZE)
+        ? frameSize : config::camera::ALERT_FRAME_SIZE;
+    m_alertQuality = quality;
+}
+
+esp_err_t CameraDriver::standby() {
+    if (!m_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (!sensor ||
+        sensor->set_reg(sensor, OV2640_REG_COM2, OV2640_COM2_STANDBY, OV2640_COM2_STANDBY) != 0) {
+        ESP_LOGE(TAG, "Failed to put sensor in standby");
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Sensor in standby");
+    return ESP_OK;
+}
+
+esp_err_t CameraDriver::resume() {
+    if (!m_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (!sensor || sensor->set_reg(sensor, OV2640_REG_COM2, OV2640_COM2_STANDBY, 0) != 0) {
+        ESP_LOGE(TAG, "Failed to wake sensor");
+        return ESP_FAIL;
+    }
+    
+    // Drop frames captured before standby or while the sensor restarted
+    for (int i = 0; i < config::camera::STANDBY_DISCARD_FRAMES; i++) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (fb) {
+            esp_camera_fb_return(fb);
+        }
+    }
+    return ESP_OK;
+}
+
 void CameraDriver::applySensorSettings(sensor_t* sensor) {
     ESP_LOGI(TAG, "Sensor PID: 0x%04x", sensor->id.PID);
     
@@ -145,36 +277,126 @@ void CameraDriver::applySensorSettings(sensor_t* sensor) {
     }
 }
 
+bool CameraDriver::readExposure(sensor_t* sensor, uint16_t& aec, uint16_t& gain) {
+    if (sensor->id.PID != OV2640_PID) {
+        return false;
+    }
+    
+    int reg04 = sensor->get_reg(sensor, OV2640_REG_REG04, 0x03);
+    int reg10 = sensor->get_reg(sensor, OV2640_REG_AEC, 0xFF);
+    int reg45 = sensor->get_reg(sensor, OV2640_REG_REG45, 0xFF);
+    int reg00 = sensor->get_reg(sensor, OV2640_REG_GAIN, 0xFF);
+    if (reg04 < 0 || reg10 < 0 || reg45 < 0 || reg00 < 0) {
+        return false;
+    }
+    
+    aec = static_cast<uint16_t>(((reg45 & 0x3F) << 10) | (reg10 << 2) | reg04);
+    gain = static_cast<uint16_t>(((reg45 & 0xC0) << 2) | reg00);
+    return true;
+}
+
+void CameraDriver::preloadExposure(sensor_t* sensor) {
+    if (!s_lastExposure.valid || sensor->id.PID != OV2640_PID) {
+        return;
+    }
+    
+    uint16_t aec = s_lastExposure.aec;
+    uint16_t gain = s_lastExposure.gain;
+    
+    // AEC/AGC stay enabled; this only moves their starting point
+    sensor->set_reg(sensor, OV2640_REG_REG45, 0xFF,
+                    ((gain >> 2) & 0xC0) | ((aec >> 10) & 0x3F));
+    sensor->set_reg(sensor, OV2640_REG_AEC, 0xFF, (aec >> 2) & 0xFF);
+    sensor->set_reg(sensor, OV2640_REG_REG04, 0x03, aec & 0x03);
+    sensor->set_reg(sensor, OV2640_REG_GAIN, 0xFF, gain & 0xFF);
+    
+    ESP_LOGI(TAG, "Preloaded exposure from RTC: AEC=%u, gain=%u", aec, gain);
+}
+
 bool CameraDriver::warmup() {
     if (!m_initialized) {
         ESP_LOGE(TAG, "Camera not initialized");
         return false;
     }
     
-    ESP_LOGI(TAG, "Warming up camera (%d frames, %d ms delay)...",
-             config::timing::CAMERA_WARMUP_FRAMES,
-             config::timing::CAMERA_WARMUP_DELAY_MS);
+    const int maxFrames = config::RuntimeConfig::get(config::Setting::WARMUP_FRAMES);
+    const int requiredStable = config::RuntimeConfig::get(config::Setting::WARMUP_STABLE_FRAMES);
+    ESP_LOGI(TAG, "Warming up camera (max %d frames, %d ms delay)...",
+             maxFrames, config::timing::CAMERA_WARMUP_DELAY_MS);
+    
+    sensor_t* sensor = esp_camera_sensor_get();
     
+    int framesTaken = 0;
     int validFrames = 0;
+    int stableFrames = 0;
+    bool converged = false;
     
-    for (int i = 0; i < config::timing::CAMERA_WARMUP_FRAMES; i++) {
+    size_t prevLen = 0;
+    uint16_t prevAec = 0;
+    uint16_t prevGain = 0;
+    bool havePrevExposure = false;
+    uint16_t aec = 0;
+    uint16_t gain = 0;
+    
+    for (int i = 0; i < maxFrames; i++) {
         camera_fb_t* fb = esp_camera_fb_get();
+        framesTaken++;
+        
         if (fb) {
             if (fb->len > config::camera::MIN_FRAME_SIZE) {
                 validFrames++;
+                
+                // Frame size stability (JPEG size tracks scene brightness)
+                bool sizeStable = false;
+                if (prevLen > 0) {
+                    size_t delta = (fb->len > prevLen) ? fb->len - prevLen : prevLen - fb->len;
+                    sizeStable = delta * 100 <=
+                        prevLen * config::timing::CAMERA_WARMUP_SIZE_TOLERANCE_PCT;
+                }
+                prevLen = fb->len;
+                
+                // AEC/AGC register stability
+                bool exposureStable = false;
+                if (sensor && readExposure(sensor, aec, gain)) {
+                    if (havePrevExposure) {
+                        exposureStable =
+                            std::abs(aec - prevAec) <= config::timing::CAMERA_WARMUP_AEC_TOLERANCE &&
+                            std::abs(gain - prevGain) <= config::timing::CAMERA_WARMUP_GAIN_TOLERANCE;
+                    }
+                    prevAec = aec;
+                    prevGain = gain;
+                    havePrevExposure = true;
+                }
+                
+                stableFrames = (sizeStable || exposureStable) ? stableFrames + 1 : 0;
+            } else {
+                stableFrames = 0;
             }
             esp_camera_fb_return(fb);
         }
+        
+        if (stableFrames >= requiredStable) {
+            converged = true;
+            break;
+        }
+        
         vTaskDelay(pdMS_TO_TICKS(config::timing::CAMERA_WARMUP_DELAY_MS));
     }
     
-    float successRate = (static_cast<float>(validFrames) / 
-                        config::timing::CAMERA_WARMUP_FRAMES) * 100.0f;
+    // Remember converged exposure for the next wake
+    if (converged && havePrevExposure) {
+        s_lastExposure = {true, prevAec, prevGain};
+    }
+    
+    float successRate = (static_cast<float>(validFrames) / framesTaken) * 100.0f;
     
-    ESP_LOGI(TAG, "Warmup complete: %d/%d valid frames (%.1f%%)",
-             validFrames, config::timing::CAMERA_WARMUP_FRAMES, successRate);
+    ESP_LOGI(TAG, "Warmup complete: %d/%d valid frames (%.1f%%), %s",
+             validFrames, framesTaken, successRate,
+             converged ? "exposure converged" : "not converged");
     
-    return validFrames >= config::timing::CAMERA_MIN_VALID_FRAMES;
+    // A shortened warmup (runtime "warmup_frames") lowers the bar with it
+    return converged ||
+           validFrames >= std::min(config::timing::CAMERA_MIN_VALID_FRAMES, maxFrames);
 }
 
 camera_fb_t* CameraDriver::capture() {
@@ -232,7 +454,7 @@ void CameraDriver::shutdown() {
     sensor_t* sensor = esp_camera_sensor_get();
     if (sensor) {
         // OV2640 standby mode
-        sensor->set_reg(sensor, 0x09, 0xFF, 0x10);
+        sensor->set_reg(sensor, OV2640_REG_COM2, OV2640_COM2_STANDBY, OV2640_COM2_STANDBY);
     }
     
     // Deinitialize camera
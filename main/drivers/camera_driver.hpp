@@ -7,7 +7,9 @@
  * Provides:
  * - Camera initialization with optimized settings
  * - Frame capture with validation
+ * - Dual-stream capture (low-res detection / high-res alert)
  * - Low-light optimization for object detection
+ * - Sensor standby between watch-mode triggers
  * - Proper shutdown for deep sleep
  */
 
@@ -16,6 +18,14 @@
 
 namespace drivers {
 
+/**
+ * @brief Capture stream selection
+ */
+enum class CaptureMode {
+    DETECTION,          // Low-res JPEG for warmup and inference
+    ALERT               // High-res JPEG for the Telegram photo
+};
+
 /**
  * @brief Camera driver class for OV2640 sensor
  */
@@ -31,6 +41,9 @@ public:
     /**
      * @brief Initialize camera with optimized settings
      * 
+     * Frame buffers are sized for the alert resolution, then the sensor
+     * is switched to the detection stream.
+     * 
      * @return esp_err_t 
      *         - ESP_OK on success
      *         - ESP_ERR_CAMERA_NOT_DETECTED if sensor not found
@@ -41,9 +54,13 @@ public:
     /**
      * @brief Perform camera warmup for exposure stabilization
      * 
-     * Captures and discards frames to allow auto-exposure to settle.
+     * Captures and discards frames until auto-exposure settles: either the
+     * JPEG size or the OV2640 AEC/AGC registers stay stable for
+     * "stable_frames" frames; "warmup_frames" is the hard upper bound
+     * (runtime settings). The converged exposure/gain is kept in RTC memory and
+     * preloaded by init() on the next wake.
      * 
-     * @return true if sufficient valid frames captured
+     * @return true if exposure converged or sufficient valid frames captured
      * @return false if warmup failed
      */
     bool warmup();
@@ -63,6 +80,52 @@ public:
      */
     void returnFrame(camera_fb_t* fb);
     
+    /**
+     * @brief Switch between detection and alert streams
+     * 
+     * Reconfigures the sensor output window over SCCB without
+     * reinitializing the camera driver, then drops stale frames.
+     * 
+     * @param mode Target capture mode
+     * @return esp_err_t 
+     *         - ESP_OK on success
+     *         - ESP_ERR_INVALID_STATE if camera not initialized
+     *         - ESP_FAIL if the sensor rejected the frame size
+     */
+    esp_err_t setCaptureMode(CaptureMode mode);
+    
+    /**
+     * @brief Select the alert stream encoding for the next switch to ALERT
+     * 
+     * The detection stream always uses the runtime "jpeg_quality".
+     * 
+     * @param frameSize Alert frame size (at most ALERT_FRAME_SIZE)
+     * @param quality   JPEG quality, raised to the runtime "jpeg_quality"
+     *                  if lower (frame buffers are sized for it)
+     */
+    void setAlertEncoding(framesize_t frameSize, int quality);
+    
+    /**
+     * @brief Get the active capture mode
+     */
+    CaptureMode getCaptureMode() const { return m_mode; }
+    
+    /**
+     * @brief Put the sensor in standby, keeping the driver and its buffers
+     * 
+     * Exposure settings are retained, so resume() needs no warmup.
+     * 
+     * @return esp_err_t ESP_OK, ESP_ERR_INVALID_STATE if not initialized
+     */
+    esp_err_t standby();
+    
+    /**
+     * @brief Leave standby and drop the stale frames
+     * 
+     * @return esp_err_t ESP_OK, ESP_ERR_INVALID_STATE if not initialized
+     */
+    esp_err_t resume();
+    
     /**
      * @brief Shutdown camera and reset GPIO pins for deep sleep
      */
@@ -75,6 +138,10 @@ public:
 
 private:
     bool m_initialized;
+    CaptureMode m_mode;
+    framesize_t m_alertFrameSize;
+    int m_alertQuality;         // 0 = runtime "jpeg_quality"
+    int m_quality;              // Quality the sensor is set to
     
     /**
      * @brief Apply sensor-specific optimizations
@@ -85,6 +152,18 @@ private:
      * @brief Reset all camera GPIO pins to input mode
      */
     void resetGpioPins();
+    
+    /**
+     * @brief Read current OV2640 exposure (AEC) and gain (AGC) registers
+     * 
+     * @return true if registers were read
+     */
+    bool readExposure(sensor_t* sensor, uint16_t& aec, uint16_t& gain);
+    
+    /**
+     * @brief Seed OV2640 AEC/AGC with the last converged values from RTC
+     */
+    void preloadExposure(sensor_t* sensor);
 };
 
 } // namespace drivers
@@ -0,0 +1,336 @@
+/**
+ * @file event_log.cpp
+ * @brief SD event log implementation
+ */
+
+#include "event_log.hpp"
+#include "app_config.hpp"
+
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_vfs_fat.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static const char* TAG = "EventLog";
+
+// Next sequence number; 0 means "recover from the index"
+RTC_DATA_ATTR static uint32_t s_nextSequence = 0;
+
+// Data file offset of the next record
+RTC_DATA_ATTR static uint32_t s_nextOffset = 0;
+
+namespace drivers {
+
+namespace {
+
+constexpr uint32_t RECORD_MAGIC = 0x47564553;   // "SEVG"
+constexpr uint32_t INDEX_MAGIC = 0x58495653;    // "SVIX"
+constexpr const char* DATA_FILE = "data.bin";
+constexpr const char* INDEX_FILE = "index.bin";
+
+constexpr size_t SECTOR_SIZE = 512;
+constexpr size_t CHUNK_SIZE = config::eventlog::WRITE_CHUNK_SIZE;
+constexpr uint32_t DATA_SIZE = config::eventlog::DATA_FILE_SIZE;
+constexpr size_t INDEX_SLOTS = config::eventlog::INDEX_SLOTS;
+constexpr uint32_t INDEX_SIZE = INDEX_SLOTS * sizeof(EventIndexEntry);
+
+static_assert(sizeof(EventIndexEntry) == 32, "Index slots are 32 bytes on the card");
+static_assert(CHUNK_SIZE % SECTOR_SIZE == 0, "Writes must stay sector aligned");
+static_assert(DATA_SIZE % SECTOR_SIZE == 0, "Records start on a sector boundary");
+
+/**
+ * @brief Header at the start of each record's first sector
+ */
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t length;
+    uint16_t type;
+    uint16_t reserved;
+};
+
+uint32_t alignUp(uint32_t value, uint32_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+uint32_t entryCheck(const EventIndexEntry& entry) {
+    return entry.magic ^ entry.sequence ^ (entry.offset * 31u) ^ entry.length ^
+           (static_cast<uint32_t>(entry.type) << 16) ^
+           static_cast<uint32_t>(entry.timestamp) ^ 0xA5A5A5A5u;
+}
+
+bool isValidEntry(const EventIndexEntry& entry) {
+    return entry.magic == INDEX_MAGIC && entry.sequence != 0 &&
+           entry.check == entryCheck(entry);
+}
+
+int64_t nowSec() {
+    struct timeval tv = {};
+    gettimeofday(&tv, nullptr);
+    return static_cast<int64_t>(tv.tv_sec);
+}
+
+} // namespace
+
+EventLog::EventLog(const char* mountPoint)
+    : m_mountPoint(mountPoint)
+    , m_dir{}
+    , m_dataFd(-1)
+    , m_indexFd(-1)
+    , m_buffer(nullptr)
+{
+    std::snprintf(m_dir, sizeof(m_dir), "%s/%s", mountPoint, config::eventlog::DIRECTORY);
+}
+
+EventLog::~EventLog() {
+    close();
+}
+
+esp_err_t EventLog::openFile(const char* name, uint32_t size, int& fd, bool& created) {
+    char path[96];
+    std::snprintf(path, sizeof(path), "%s/%s", m_dir, name);
+    created = false;
+
+    struct stat st = {};
+    if (stat(path, &st) != 0 || static_cast<uint32_t>(st.st_size) != size) {
+        // One contiguous cluster run, allocated now: appends never touch the FAT
+        unlink(path);
+        ESP_LOGI(TAG, "Pre-allocating %s (%lu KB)", path, static_cast<unsigned long>(size / 1024));
+        esp_err_t err = esp_vfs_fat_create_contiguous_file(m_mountPoint, path, size, true);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Cannot allocate %s: %s", path, esp_err_to_name(err));
+            return ESP_FAIL;
+        }
+        created = true;
+    }
+
+    fd = ::open(path, O_RDWR);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "Cannot open %s (errno %d)", path, errno);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t EventLog::open() {
+    if (isOpen()) {
+        return ESP_OK;
+    }
+    if (mkdir(m_dir, 0775) != 0 && errno != EEXIST) {
+        ESP_LOGE(TAG, "Cannot create %s (errno %d)", m_dir, errno);
+        return ESP_FAIL;
+    }
+
+    m_buffer = static_cast<uint8_t*>(
+        heap_caps_aligned_alloc(4, CHUNK_SIZE, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL));
+    if (!m_buffer) {
+        ESP_LOGE(TAG, "No DMA memory for the %u byte staging buffer",
+                 static_cast<unsigned>(CHUNK_SIZE));
+        return ESP_ERR_NO_MEM;
+    }
+
+    bool dataCreated = false;
+    bool indexCreated = false;
+    esp_err_t err = openFile(DATA_FILE, DATA_SIZE, m_dataFd, dataCreated);
+    if (err == ESP_OK) {
+        err = openFile(INDEX_FILE, INDEX_SIZE, m_indexFd, indexCreated);
+    }
+    if (err == ESP_OK && indexCreated) {
+        // Pre-allocated clusters hold stale data: start from empty slots
+        std::memset(m_buffer, 0, CHUNK_SIZE);
+        for (uint32_t offset = 0; offset < INDEX_SIZE && err == ESP_OK; offset += CHUNK_SIZE) {
+            size_t len = std::min<size_t>(CHUNK_SIZE, INDEX_SIZE - offset);
+            if (pwrite(m_indexFd, m_buffer, len, offset) != static_cast<ssize_t>(len)) {
+                err = ESP_FAIL;
+            }
+        }
+    }
+    if (err == ESP_OK && (dataCreated || indexCreated || s_nextSequence == 0)) {
+        // New files (or a card swap) invalidate the RTC head
+        err = recoverHead();
+    }
+    if (err != ESP_OK) {
+        close();
+        return err;
+    }
+    return ESP_OK;
+}
+
+esp_err_t EventLog::recoverHead() {
+    // Newest valid slot wins; the ring continues right after its record
+    EventIndexEntry newest = {};
+    for (uint32_t offset = 0; offset < INDEX_SIZE; offset += CHUNK_SIZE) {
+        size_t len = std::min<size_t>(CHUNK_SIZE, INDEX_SIZE - offset);
+        if (pread(m_indexFd, m_buffer, len, offset) != static_cast<ssize_t>(len)) {
+            ESP_LOGE(TAG, "Index read failed (errno %d)", errno);
+            return ESP_FAIL;
+        }
+        const EventIndexEntry* entries = reinterpret_cast<const EventIndexEntry*>(m_buffer);
+        for (size_t i = 0; i < len / sizeof(EventIndexEntry); i++) {
+            if (isValidEntry(entries[i]) && entries[i].sequence > newest.sequence) {
+                newest = entries[i];
+            }
+        }
+    }
+
+    if (newest.sequence == 0) {
+        s_nextSequence = 1;
+        s_nextOffset = 0;
+    } else {
+        s_nextSequence = newest.sequence + 1;
+        s_nextOffset = newest.offset + alignUp(sizeof(RecordHeader) + newest.length, SECTOR_SIZE);
+    }
+    ESP_LOGD(TAG, "Head recovered: seq %lu at %lu", static_cast<unsigned long>(s_nextSequence),
+             static_cast<unsigned long>(s_nextOffset));
+    return ESP_OK;
+}
+
+esp_err_t EventLog::append(EventType type, const void* data, size_t len, uint32_t* sequence) {
+    if (!isOpen()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (sizeof(RecordHeader) + static_cast<uint64_t>(len) > DATA_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    const uint32_t paddedLen = alignUp(sizeof(RecordHeader) + len, SECTOR_SIZE);
+
+    // Wrap: the oldest records are overwritten
+    uint32_t offset = s_nextOffset;
+    if (offset + static_cast<uint64_t>(paddedLen) > DATA_SIZE) {
+        offset = 0;
+    }
+
+    const RecordHeader header = {RECORD_MAGIC, s_nextSequence, static_cast<uint32_t>(len),
+                                 static_cast<uint16_t>(type), 0};
+    std::memcpy(m_buffer, &header, sizeof(header));
+    size_t fill = sizeof(header);
+
+    // Stage whole chunks; only the last one is padded to a sector
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    size_t remaining = len;
+    uint32_t pos = offset;
+    while (true) {
+        size_t n = std::min(remaining, CHUNK_SIZE - fill);
+        std::memcpy(m_buffer + fill, src, n);
+        src += n;
+        remaining -= n;
+        fill += n;
+        if (remaining == 0) {
+            size_t padded = alignUp(fill, SECTOR_SIZE);
+            std::memset(m_buffer + fill, 0, padded - fill);
+            fill = padded;
+        }
+        if (pwrite(m_dataFd, m_buffer, fill, pos) != static_cast<ssize_t>(fill)) {
+            ESP_LOGE(TAG, "Data write at %lu failed (errno %d)", static_cast<unsigned long>(pos),
+                     errno);
+            return ESP_FAIL;
+        }
+        pos += fill;
+        fill = 0;
+        if (remaining == 0) {
+            break;
+        }
+    }
+
+    EventIndexEntry entry = {};
+    entry.magic = INDEX_MAGIC;
+    entry.sequence = s_nextSequence;
+    entry.offset = offset;
+    entry.length = static_cast<uint32_t>(len);
+    entry.type = static_cast<uint16_t>(type);
+    entry.timestamp = nowSec();
+    entry.check = entryCheck(entry);
+    const off_t slot = static_cast<off_t>((entry.sequence % INDEX_SLOTS) * sizeof(entry));
+    if (pwrite(m_indexFd, &entry, sizeof(entry), slot) != static_cast<ssize_t>(sizeof(entry))) {
+        ESP_LOGE(TAG, "Index write failed (errno %d)", errno);
+        return ESP_FAIL;
+    }
+
+    if (config::eventlog::SYNC_POLICY == config::eventlog::SyncPolicy::EVERY_RECORD) {
+        fsync(m_dataFd);
+        fsync(m_indexFd);
+    }
+
+    if (sequence) {
+        *sequence = entry.sequence;
+    }
+    s_nextSequence++;
+    s_nextOffset = offset + paddedLen;
+    return ESP_OK;
+}
+
+esp_err_t EventLog::find(uint32_t sequence, EventIndexEntry& entry) {
+    if (!isOpen()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const off_t slot = static_cast<off_t>((sequence % INDEX_SLOTS) * sizeof(entry));
+    if (pread(m_indexFd, &entry, sizeof(entry), slot) != static_cast<ssize_t>(sizeof(entry))) {
+        return ESP_FAIL;
+    }
+    if (!isValidEntry(entry) || entry.sequence != sequence) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t EventLog::read(const EventIndexEntry& entry, void* buffer, size_t len) {
+    if (!isOpen()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (len < entry.length) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // The ring may have reused the space since the index slot was written
+    RecordHeader header = {};
+    if (pread(m_dataFd, &header, sizeof(header), entry.offset) !=
+            static_cast<ssize_t>(sizeof(header))) {
+        return ESP_FAIL;
+    }
+    if (header.magic != RECORD_MAGIC || header.sequence != entry.sequence ||
+        header.length != entry.length) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const off_t payload = static_cast<off_t>(entry.offset + sizeof(header));
+    if (pread(m_dataFd, buffer, entry.length, payload) != static_cast<ssize_t>(entry.length)) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+uint32_t EventLog::lastSequence() const {
+    return (s_nextSequence > 0) ? s_nextSequence - 1 : 0;
+}
+
+void EventLog::close() {
+    if (m_dataFd >= 0) {
+        if (config::eventlog::SYNC_POLICY == config::eventlog::SyncPolicy::ON_CLOSE) {
+            fsync(m_dataFd);
+        }
+        ::close(m_dataFd);
+        m_dataFd = -1;
+    }
+    if (m_indexFd >= 0) {
+        if (config::eventlog::SYNC_POLICY == config::eventlog::SyncPolicy::ON_CLOSE) {
+            fsync(m_indexFd);
+        }
+        ::close(m_indexFd);
+        m_indexFd = -1;
+    }
+    if (m_buffer) {
+        heap_caps_free(m_buffer);
+        m_buffer = nullptr;
+    }
+}
+
+} // namespace drivers
@@ -0,0 +1,146 @@
+#pragma once
+
+/**
+ * @file event_log.hpp
+ * @brief Append-only event log on the SD card
+ *
+ * Provides:
+ * - A data file pre-allocated as one contiguous cluster run, reused as a
+ *   ring once full (no cluster allocation or FAT updates while logging)
+ * - Records padded to whole sectors and written from a DMA-capable
+ *   staging buffer, so FatFs passes them straight to the card in
+ *   multi-sector writes
+ * - A fixed-slot index file: a record is found by sequence number
+ *   without scanning a directory
+ * - fsync() per record or on close (config::eventlog::SYNC_POLICY)
+ *
+ * The write head lives in RTC memory; after power-on it is recovered
+ * from the index.
+ */
+
+#include "esp_err.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace drivers {
+
+/**
+ * @brief Kinds of event log records
+ */
+enum class EventType : uint16_t {
+    ALERT = 1,          // Alert caption (text)
+    ALERT_FRAME = 2,    // High-resolution alert JPEG
+    DEBUG_FRAME = 3,    // Detection frame (config::debug::SAVE_DEBUG_IMAGES)
+};
+
+/**
+ * @brief Index slot of one record (32 bytes on the card)
+ */
+struct EventIndexEntry {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t offset;        // Record start in the data file (sector aligned)
+    uint32_t length;        // Payload bytes
+    uint16_t type;          // EventType
+    uint16_t reserved;
+    uint32_t check;         // Guards against stale or never-written slots
+    int64_t  timestamp;     // RTC time (seconds)
+};
+
+/**
+ * @brief Event log in config::eventlog::DIRECTORY on a mounted card
+ *
+ * @code
+ *   EventLog log(sdCard.getMountPoint());
+ *   if (log.open() == ESP_OK) {
+ *       log.append(EventType::ALERT_FRAME, fb->buf, fb->len);
+ *       log.close();
+ *   }
+ * @endcode
+ */
+class EventLog {
+public:
+    explicit EventLog(const char* mountPoint);
+    ~EventLog();
+
+    // Disable copy operations
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    /**
+     * @brief Open (creating and pre-allocating on first use) the log files
+     *
+     * @return esp_err_t
+     *         - ESP_OK on success
+     *         - ESP_ERR_NO_MEM if the staging buffer cannot be allocated
+     *         - ESP_FAIL on a file system error
+     */
+    esp_err_t open();
+
+    /**
+     * @brief Append one record
+     *
+     * @param type     Record kind
+     * @param data     Payload
+     * @param len      Payload bytes
+     * @param sequence Receives the record's sequence number (optional)
+     *
+     * @return esp_err_t
+     *         - ESP_OK on success
+     *         - ESP_ERR_INVALID_STATE if the log is not open
+     *         - ESP_ERR_INVALID_SIZE if the record exceeds the data file
+     *         - ESP_FAIL on a write error
+     */
+    esp_err_t append(EventType type, const void* data, size_t len, uint32_t* sequence = nullptr);
+
+    /**
+     * @brief Look up a record in the index
+     *
+     * @return esp_err_t ESP_ERR_NOT_FOUND if the slot holds another record
+     */
+    esp_err_t find(uint32_t sequence, EventIndexEntry& entry);
+
+    /**
+     * @brief Read a record's payload
+     *
+     * @param entry  Index entry from find()
+     * @param buffer Destination, at least entry.length bytes
+     * @param len    Size of buffer
+     *
+     * @return esp_err_t ESP_ERR_NOT_FOUND if the ring has overwritten the record
+     */
+    esp_err_t read(const EventIndexEntry& entry, void* buffer, size_t len);
+
+    /**
+     * @brief Sequence number of the newest record (0 = empty log)
+     */
+    uint32_t lastSequence() const;
+
+    /**
+     * @brief Flush and close the log files
+     */
+    void close();
+
+    bool isOpen() const { return m_dataFd >= 0; }
+
+private:
+    const char* m_mountPoint;
+    char m_dir[64];
+    int m_dataFd;
+    int m_indexFd;
+    uint8_t* m_buffer;      // WRITE_CHUNK_SIZE bytes, DMA capable
+
+    /**
+     * @brief Open a log file, pre-allocating it contiguously if missing
+     *
+     * @param created Set if the file was (re)created
+     */
+    esp_err_t openFile(const char* name, uint32_t size, int& fd, bool& created);
+
+    /**
+     * @brief Find the write head from the newest valid index slot
+     */
+    esp_err_t recoverHead();
+};
+
+} // namespace drivers
@@ -45,13 +45,21 @@ esp_err_t SdCardDriver::mount() {
     
     // SDMMC host configuration
     sdmmc_host_t host = SDMMC_HOST_DEFAULT();
+    if (config::sdcard::HIGH_SPEED) {
+        host.max_freq_khz = SDMMC_FREQ_HIGHSPEED;
+    }
     
-    // Slot configuration for 1-bit mode
+    // Slot configuration: 4-bit where the board routes D1-D3, else 1-bit
     sdmmc_slot_config_t slotConfig = SDMMC_SLOT_CONFIG_DEFAULT();
-    slotConfig.width = 1;  // 1-bit mode
+    slotConfig.width = config::sdcard::BUS_WIDTH;
     slotConfig.clk = static_cast<gpio_num_t>(config::sdcard::PIN_CLK);
     slotConfig.cmd = static_cast<gpio_num_t>(config::sdcard::PIN_CMD);
     slotConfig.d0 = static_cast<gpio_num_t>(config::sdcard::PIN_D0);
+    if (config::sdcard::BUS_WIDTH == 4) {
+        slotConfig.d1 = static_cast<gpio_num_t>(config::sdcard::PIN_D1);
+        slotConfig.d2 = static_cast<gpio_num_t>(config::sdcard::PIN_D2);
+        slotConfig.d3 = static_cast<gpio_num_t>(config::sdcard::PIN_D3);
+    }
     
     // Mount filesystem
     esp_err_t ret = esp_vfs_fat_sdmmc_mount(
@@ -75,7 +83,8 @@ esp_err_t SdCardDriver::mount() {
     // Log card info
     ESP_LOGI(TAG, "SD card mounted successfully");
     ESP_LOGI(TAG, "  Name: %s", m_card->cid.name);
-    ESP_LOGI(TAG, "  Speed: %s", (m_card->max_freq_khz < 26000) ? "Default" : "High Speed");
+    ESP_LOGI(TAG, "  Speed: %s, %d-bit", (m_card->max_freq_khz < 26000) ? "Default" : "High Speed",
+             config::sdcard::BUS_WIDTH);
     ESP_LOGI(TAG, "  Size: %lluMB", 
              ((uint64_t)m_card->csd.capacity) * m_card->csd.sector_size / (1024 * 1024));
     
@@ -87,6 +96,9 @@ void SdCardDriver::resetGpioPins() {
     
     for (size_t i = 0; i < config::sdcard::PINS_COUNT; i++) {
         gpio_num_t pin = config::sdcard::PINS[i];
+        if (pin == GPIO_NUM_NC) {
+            continue;
+        }
         gpio_reset_pin(pin);
         gpio_set_direction(pin, GPIO_MODE_INPUT);
         gpio_pullup_dis(pin);
@@ -5,7 +5,8 @@
  * @brief SD Card driver for FAT filesystem access
  * 
  * Supports:
- * - 1-bit SDMMC mode for ESP32-S3
+ * - 1-bit SDMMC mode, 4-bit where the board routes D1-D3
+ * - High-speed (40 MHz) clock
  * - FAT32 filesystem
  * - Proper GPIO cleanup for deep sleep
  */
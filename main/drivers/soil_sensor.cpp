@@ -0,0 +1,126 @@
+/**
+ * @file soil_sensor.cpp
+ * @brief Soil-moisture probe implementation
+ */
+
+#include "soil_sensor.hpp"
+#include "app_config.hpp"
+
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_adc/adc_oneshot.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <algorithm>
+#include <sys/time.h>
+
+static const char* TAG = "SoilSensor";
+
+static_assert(config::farm::SOIL_RAW_DRY != config::farm::SOIL_RAW_WET,
+              "Soil probe calibration needs distinct dry and wet readings");
+
+// Last reading (survives deep sleep; time 0 = none)
+RTC_DATA_ATTR static int s_lastPercent = -1;
+RTC_DATA_ATTR static int64_t s_lastTime = 0;
+
+namespace {
+
+int64_t nowSec() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec;
+}
+
+void setProbePower(bool on) {
+    if (config::farm::SOIL_POWER_GPIO < 0) {
+        return;
+    }
+    const gpio_num_t pin = static_cast<gpio_num_t>(config::farm::SOIL_POWER_GPIO);
+    if (on) {
+        gpio_reset_pin(pin);
+        gpio_set_direction(pin, GPIO_MODE_OUTPUT);
+        gpio_set_level(pin, 1);
+        vTaskDelay(pdMS_TO_TICKS(config::farm::SOIL_SETTLE_MS));
+    } else {
+        gpio_set_level(pin, 0);
+        // Floating in deep sleep would leave the probe half powered
+        gpio_set_direction(pin, GPIO_MODE_DISABLE);
+    }
+}
+
+} // namespace
+
+namespace drivers {
+
+bool SoilSensor::isFitted() {
+    return config::farm::SOIL_ADC_GPIO >= 0;
+}
+
+esp_err_t SoilSensor::sample(int& percent) {
+    if (!isFitted()) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    adc_unit_t unit;
+    adc_channel_t channel;
+    esp_err_t err = adc_oneshot_io_to_channel(config::farm::SOIL_ADC_GPIO, &unit, &channel);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "GPIO %d is not an ADC pin", config::farm::SOIL_ADC_GPIO);
+        return err;
+    }
+
+    adc_oneshot_unit_handle_t adc = nullptr;
+    adc_oneshot_unit_init_cfg_t unitConfig = {};
+    unitConfig.unit_id = unit;
+    err = adc_oneshot_new_unit(&unitConfig, &adc);
+    if (err != ESP_OK) {
+        return err;
+    }
+    adc_oneshot_chan_cfg_t channelConfig = {};
+    channelConfig.atten = ADC_ATTEN_DB_12;
+    channelConfig.bitwidth = ADC_BITWIDTH_DEFAULT;
+    adc_oneshot_config_channel(adc, channel, &channelConfig);
+
+    setProbePower(true);
+    int sum = 0;
+    int samples = 0;
+    for (int i = 0; i < config::farm::SOIL_SAMPLES; i++) {
+        int raw = 0;
+        if (adc_oneshot_read(adc, channel, &raw) == ESP_OK) {
+            sum += raw;
+            samples++;
+        }
+    }
+    setProbePower(false);
+    adc_oneshot_del_unit(adc);
+
+    if (samples == 0) {
+        ESP_LOGW(TAG, "No soil probe reading");
+        return ESP_FAIL;
+    }
+
+    // Capacitive probes read lower the wetter the soil
+    const int raw = sum / samples;
+    const int span = config::farm::SOIL_RAW_DRY - config::farm::SOIL_RAW_WET;
+    percent = std::clamp((config::farm::SOIL_RAW_DRY - raw) * 100 / span, 0, 100);
+
+    s_lastPercent = percent;
+    s_lastTime = nowSec();
+    ESP_LOGI(TAG, "Soil moisture %d %% (raw %d)", percent, raw);
+    return ESP_OK;
+}
+
+int SoilSensor::lastPercent() {
+    return (s_lastTime != 0) ? s_lastPercent : -1;
+}
+
+int64_t SoilSensor::lastReadingAge() {
+    if (s_lastTime == 0) {
+        return -1;
+    }
+    return std::max<int64_t>(nowSec() - s_lastTime, 0);
+}
+
+} // namespace drivers
@@ -0,0 +1,61 @@
+#pragma once
+
+/**
+ * @file soil_sensor.hpp
+ * @brief Capacitive soil-moisture probe on an ADC pin
+ *
+ * Provides:
+ * - Moisture in percent from the raw ADC reading and the probe's dry/wet
+ *   calibration (config::farm::SOIL_RAW_DRY / SOIL_RAW_WET)
+ * - Optional probe power switched from a GPIO around the reading
+ * - The last reading and its time in RTC memory, for /status and the
+ *   crop photo caption
+ *
+ * Sampled by the SOIL_SAMPLE timer wake task (power::SleepManager).
+ */
+
+#include "esp_err.h"
+#include <cstdint>
+
+namespace drivers {
+
+/**
+ * @brief Soil-moisture probe (static, RTC resident)
+ *
+ * @code
+ *   int percent = 0;
+ *   if (SoilSensor::sample(percent) == ESP_OK) {
+ *       ESP_LOGI(TAG, "Soil moisture %d %%", percent);
+ *   }
+ * @endcode
+ */
+class SoilSensor {
+public:
+    /**
+     * @brief Check whether a probe is configured (SOIL_ADC_GPIO >= 0)
+     */
+    static bool isFitted();
+
+    /**
+     * @brief Read the probe and keep the result as the last reading
+     *
+     * @param percent Moisture, 0 (dry) to 100 (wet)
+     * @return esp_err_t
+     *         - ESP_OK on success
+     *         - ESP_ERR_NOT_SUPPORTED if no probe is configured
+     *         - Other ESP error codes on ADC failure
+     */
+    static esp_err_t sample(int& percent);
+
+    /**
+     * @brief Last reading in percent, or -1 if none since power-on
+     */
+    static int lastPercent();
+
+    /**
+     * @brief Seconds since the last reading, or -1 if none since power-on
+     */
+    static int64_t lastReadingAge();
+};
+
+} // namespace drivers
@@ -0,0 +1,357 @@
+/**
+ * @file alert_outbox.cpp
+ * @brief Alert outbox implementation
+ */
+
+#include "alert_outbox.hpp"
+#include "app_config.hpp"
+
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char* TAG = "AlertOutbox";
+
+// Queued alert count (-1 = unknown until the first SD scan after power-on)
+RTC_DATA_ATTR static int32_t s_pendingHint = -1;
+
+// Next record id; 0 means "recover from the highest id on the card"
+RTC_DATA_ATTR static uint32_t s_nextId = 0;
+
+// Failed drains since the last full one (retry backoff exponent)
+RTC_DATA_ATTR static uint8_t s_retryLevel = 0;
+
+namespace network {
+
+namespace {
+
+constexpr uint32_t RECORD_MAGIC = 0x524C4153;   // "SALR"
+constexpr uint16_t RECORD_VERSION = 1;
+constexpr const char* RECORD_EXT = "alr";
+constexpr const char* TEMP_EXT = "tmp";
+constexpr const char* BAD_EXT = "bad";
+
+static_assert(config::camera::ALERT_BURST_FRAMES <= AlertOutbox::MAX_FRAMES,
+              "Outbox records must hold a full alert burst");
+
+/**
+ * @brief On-card record header, followed by the caption and the frames
+ */
+struct RecordHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t frameCount;
+    uint32_t captionLen;
+    uint32_t frameLen[AlertOutbox::MAX_FRAMES];
+};
+
+/**
+ * @brief Frames of a record loaded into PSRAM for sending
+ */
+struct LoadedFrames {
+    uint8_t* data[AlertOutbox::MAX_FRAMES];
+};
+
+void freeLoadedFrame(size_t index, void* context) {
+    LoadedFrames* frames = static_cast<LoadedFrames*>(context);
+    heap_caps_free(frames->data[index]);
+    frames->data[index] = nullptr;
+}
+
+bool parseRecordName(const char* name, uint32_t& id) {
+    char* end = nullptr;
+    unsigned long value = std::strtoul(name, &end, 10);
+    if (end == name || *end != '.' || std::strcmp(end + 1, RECORD_EXT) != 0) {
+        return false;
+    }
+    id = static_cast<uint32_t>(value);
+    return true;
+}
+
+} // namespace
+
+AlertOutbox::AlertOutbox(const char* mountPoint)
+    : m_dir{}
+    , m_dirReady(false)
+{
+    std::snprintf(m_dir, sizeof(m_dir), "%s/%s", mountPoint, config::outbox::DIRECTORY);
+}
+
+bool AlertOutbox::mayHavePending() {
+    return s_pendingHint != 0;
+}
+
+int64_t AlertOutbox::retryIntervalSeconds() {
+    const int64_t maxInterval = config::outbox::RETRY_MAX_INTERVAL_SECONDS;
+    int64_t interval = config::outbox::RETRY_INTERVAL_SECONDS;
+    for (uint8_t i = 0; i < s_retryLevel && interval < maxInterval; i++) {
+        interval *= 2;
+    }
+    return std::min(interval, maxInterval);
+}
+
+esp_err_t AlertOutbox::ensureDirectory() {
+    if (m_dirReady) {
+        return ESP_OK;
+    }
+    if (mkdir(m_dir, 0775) != 0 && errno != EEXIST) {
+        ESP_LOGE(TAG, "Cannot create %s (errno %d)", m_dir, errno);
+        return ESP_FAIL;
+    }
+    m_dirReady = true;
+    return ESP_OK;
+}
+
+void AlertOutbox::recordPath(char* path, size_t len, uint32_t id, const char* ext) const {
+    std::snprintf(path, len, "%s/%08lu.%s", m_dir, static_cast<unsigned long>(id), ext);
+}
+
+size_t AlertOutbox::listPending(uint32_t* ids, size_t maxIds) {
+    DIR* dir = opendir(m_dir);
+    if (!dir) {
+        s_pendingHint = 0;
+        return 0;
+    }
+
+    size_t count = 0;
+    size_t total = 0;
+    uint32_t highest = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        uint32_t id = 0;
+        if (!parseRecordName(entry->d_name, id)) {
+            continue;
+        }
+        total++;
+        highest = std::max(highest, id);
+        if (count < maxIds) {
+            ids[count++] = id;
+        } else if (maxIds > 0) {
+            // Keep the oldest maxIds
+            uint32_t* newest = std::max_element(ids, ids + count);
+            if (id < *newest) {
+                *newest = id;
+            }
+        }
+    }
+    closedir(dir);
+
+    std::sort(ids, ids + count);
+    s_pendingHint = static_cast<int32_t>(total);
+    if (s_nextId <= highest) {
+        s_nextId = highest + 1;
+    }
+    return count;
+}
+
+size_t AlertOutbox::pendingCount() {
+    listPending(nullptr, 0);
+    return static_cast<size_t>(s_pendingHint);
+}
+
+esp_err_t AlertOutbox::enqueue(const MediaItem* frames, size_t count, const char* caption,
+                               uint32_t* id) {
+    if (!frames || count == 0 || count > MAX_FRAMES || !caption) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ensureDirectory() != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    // Bound SD usage: drop the oldest alerts once the outbox is full
+    uint32_t oldest[config::outbox::MAX_ALERTS];
+    size_t pending = listPending(oldest, config::outbox::MAX_ALERTS);
+    if (s_nextId == 0) {
+        s_nextId = 1;
+    }
+    for (size_t i = 0; i < pending &&
+                       static_cast<size_t>(s_pendingHint) >= config::outbox::MAX_ALERTS; i++) {
+        ESP_LOGW(TAG, "Outbox full, dropping alert %lu", static_cast<unsigned long>(oldest[i]));
+        remove(oldest[i]);
+    }
+
+    RecordHeader header = {};
+    header.magic = RECORD_MAGIC;
+    header.version = RECORD_VERSION;
+    header.frameCount = static_cast<uint16_t>(count);
+    header.captionLen = static_cast<uint32_t>(std::strlen(caption));
+    for (size_t i = 0; i < count; i++) {
+        header.frameLen[i] = static_cast<uint32_t>(frames[i].len);
+    }
+
+    uint32_t recordId = s_nextId++;
+    char tempPath[64];
+    char finalPath[64];
+    recordPath(tempPath, sizeof(tempPath), recordId, TEMP_EXT);
+    recordPath(finalPath, sizeof(finalPath), recordId, RECORD_EXT);
+
+    FILE* file = std::fopen(tempPath, "wb");
+    if (!file) {
+        ESP_LOGE(TAG, "Cannot create %s (errno %d)", tempPath, errno);
+        return ESP_FAIL;
+    }
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(caption, 1, header.captionLen, file) == header.captionLen;
+    for (size_t i = 0; ok && i < count; i++) {
+        ok = std::fwrite(frames[i].data, 1, frames[i].len, file) == frames[i].len;
+    }
+    ok = (std::fflush(file) == 0) && ok;
+    ok = (fsync(fileno(file)) == 0) && ok;
+    ok = (std::fclose(file) == 0) && ok;
+
+    // Rename commits the record: only complete files carry the record extension
+    if (!ok || std::rename(tempPath, finalPath) != 0) {
+        ESP_LOGE(TAG, "Failed to write alert %lu", static_cast<unsigned long>(recordId));
+        unlink(tempPath);
+        return ESP_FAIL;
+    }
+
+    s_pendingHint = (s_pendingHint < 0) ? 1 : s_pendingHint + 1;
+    if (id) {
+        *id = recordId;
+    }
+    ESP_LOGI(TAG, "Alert %lu queued (%u frame(s), %ld pending)",
+             static_cast<unsigned long>(recordId), static_cast<unsigned>(count),
+             static_cast<long>(s_pendingHint));
+    return ESP_OK;
+}
+
+esp_err_t AlertOutbox::remove(uint32_t id) {
+    char path[64];
+    recordPath(path, sizeof(path), id, RECORD_EXT);
+    if (unlink(path) != 0) {
+        ESP_LOGW(TAG, "Cannot remove alert %lu (errno %d)", static_cast<unsigned long>(id), errno);
+        return ESP_FAIL;
+    }
+    if (s_pendingHint > 0) {
+        s_pendingHint--;
+    }
+    ESP_LOGD(TAG, "Alert %lu removed", static_cast<unsigned long>(id));
+    return ESP_OK;
+}
+
+void AlertOutbox::quarantine(uint32_t id) {
+    char path[64];
+    char badPath[64];
+    recordPath(path, sizeof(path), id, RECORD_EXT);
+    recordPath(badPath, sizeof(badPath), id, BAD_EXT);
+    ESP_LOGW(TAG, "Alert %lu is corrupt, moving aside", static_cast<unsigned long>(id));
+    if (std::rename(path, badPath) != 0) {
+        unlink(path);
+    }
+    if (s_pendingHint > 0) {
+        s_pendingHint--;
+    }
+}
+
+esp_err_t AlertOutbox::deliver(TelegramClient& telegram, uint32_t id) {
+    char path[64];
+    recordPath(path, sizeof(path), id, RECORD_EXT);
+
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return ESP_FAIL;
+    }
+
+    RecordHeader header = {};
+    char caption[config::outbox::MAX_CAPTION_LEN + 1];
+    bool valid = std::fread(&header, sizeof(header), 1, file) == 1 &&
+                 header.magic == RECORD_MAGIC &&
+                 header.version == RECORD_VERSION &&
+                 header.frameCount >= 1 && header.frameCount <= MAX_FRAMES &&
+                 header.captionLen <= config::outbox::MAX_CAPTION_LEN &&
+                 std::fread(caption, 1, header.captionLen, file) == header.captionLen;
+    caption[valid ? header.captionLen : 0] = '\0';
+
+    // Frame lengths must add up to the file before any is allocated: a
+    // corrupt one would otherwise fail the drain here on every retry
+    uint64_t recordSize = sizeof(header) + header.captionLen;
+    for (size_t i = 0; valid && i < header.frameCount; i++) {
+        valid = header.frameLen[i] > 0;
+        recordSize += header.frameLen[i];
+    }
+    struct stat st;
+    valid = valid && stat(path, &st) == 0 && static_cast<uint64_t>(st.st_size) == recordSize;
+
+    LoadedFrames frames = {};
+    MediaItem items[MAX_FRAMES] = {};
+    for (size_t i = 0; valid && i < header.frameCount; i++) {
+        frames.data[i] = static_cast<uint8_t*>(
+            heap_caps_malloc(header.frameLen[i], MALLOC_CAP_SPIRAM));
+        if (!frames.data[i]) {
+            ESP_LOGE(TAG, "No memory for %lu byte frame",
+                     static_cast<unsigned long>(header.frameLen[i]));
+            std::fclose(file);
+            for (size_t j = 0; j < i; j++) {
+                freeLoadedFrame(j, &frames);
+            }
+            return ESP_ERR_NO_MEM;
+        }
+        valid = std::fread(frames.data[i], 1, header.frameLen[i], file) == header.frameLen[i];
+        items[i] = {frames.data[i], header.frameLen[i]};
+    }
+    std::fclose(file);
+
+    if (!valid) {
+        for (size_t i = 0; i < header.frameCount && i < MAX_FRAMES; i++) {
+            freeLoadedFrame(i, &frames);
+        }
+        quarantine(id);
+        return ESP_OK;
+    }
+
+    esp_err_t err;
+    if (header.frameCount >= TelegramClient::MEDIA_GROUP_MIN) {
+        err = telegram.sendMediaGroup(items, header.frameCount, caption,
+                                      &freeLoadedFrame, &frames);
+    } else {
+        err = telegram.sendDocument(items[0].data, items[0].len, caption,
+                                    "intruder_detection.jpg");
+        freeLoadedFrame(0, &frames);
+    }
+
+    if (err == ESP_OK) {
+        remove(id);
+        ESP_LOGI(TAG, "Queued alert %lu delivered", static_cast<unsigned long>(id));
+    }
+    return err;
+}
+
+esp_err_t AlertOutbox::drain(TelegramClient& telegram, size_t maxAlerts) {
+    uint32_t ids[config::outbox::DRAIN_MAX_ALERTS];
+    size_t count = listPending(ids, std::min(maxAlerts, config::outbox::DRAIN_MAX_ALERTS));
+    if (count == 0) {
+        s_retryLevel = 0;
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "Draining %u of %ld queued alert(s)", static_cast<unsigned>(count),
+             static_cast<long>(s_pendingHint));
+
+    for (size_t i = 0; i < count; i++) {
+        esp_err_t err = deliver(telegram, ids[i]);
+        if (err != ESP_OK) {
+            if (s_retryLevel < UINT8_MAX) {
+                s_retryLevel++;
+            }
+            ESP_LOGW(TAG, "Drain stopped at alert %lu: %s (retry in %llds)",
+                     static_cast<unsigned long>(ids[i]), esp_err_to_name(err),
+                     static_cast<long long>(retryIntervalSeconds()));
+            return err;
+        }
+    }
+    s_retryLevel = 0;
+    return ESP_OK;
+}
+
+} // namespace network
@@ -0,0 +1,119 @@
+#pragma once
+
+/**
+ * @file alert_outbox.hpp
+ * @brief Persistent queue of undelivered alerts on the SD card
+ *
+ * Provides:
+ * - Durable alert records (caption + JPEG frames) written before any
+ *   network activity, so a failed uplink does not lose the alert
+ * - Oldest-first batched delivery over one Telegram session
+ * - Removal right after the Bot API acknowledges each alert
+ * - RTC hint so wakes with an empty outbox skip the SD scan
+ * - Retry interval that backs off after failed drains (RTC)
+ *
+ * @note Delivery is at-least-once: a power loss between the API reply and
+ *       the record removal re-sends that single alert on the next drain.
+ */
+
+#include "esp_err.h"
+#include "telegram_client.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace network {
+
+/**
+ * @brief SD-backed alert outbox
+ *
+ * @code
+ *   AlertOutbox outbox(sdCard.getMountPoint());
+ *   uint32_t id = 0;
+ *   outbox.enqueue(items, count, caption, &id);
+ *   if (wifi.connect() == ESP_OK) {
+ *       if (telegram.sendMediaGroup(...) == ESP_OK) outbox.remove(id);
+ *       outbox.drain(telegram, config::outbox::DRAIN_MAX_ALERTS);
+ *   }
+ * @endcode
+ */
+class AlertOutbox {
+public:
+    /**
+     * @param mountPoint Mounted SD card path (SdCardDriver::getMountPoint())
+     */
+    explicit AlertOutbox(const char* mountPoint);
+    ~AlertOutbox() = default;
+
+    // Disable copy operations
+    AlertOutbox(const AlertOutbox&) = delete;
+    AlertOutbox& operator=(const AlertOutbox&) = delete;
+
+    /**
+     * @brief Store an alert
+     *
+     * The record is written to a temporary file and renamed into place,
+     * so a partially written alert is never delivered.
+     *
+     * @param frames  JPEG frames (1..MAX_FRAMES)
+     * @param count   Number of frames
+     * @param caption Alert caption
+     * @param[out] id Record id (optional), for remove()
+     *
+     * @return esp_err_t ESP_OK, ESP_ERR_INVALID_ARG or ESP_FAIL on I/O error
+     */
+    esp_err_t enqueue(const MediaItem* frames, size_t count, const char* caption,
+                      uint32_t* id = nullptr);
+
+    /**
+     * @brief Remove a delivered alert
+     */
+    esp_err_t remove(uint32_t id);
+
+    /**
+     * @brief Deliver queued alerts, oldest first
+     *
+     * Stops at the first failed send; remaining alerts stay queued. A
+     * failure doubles retryIntervalSeconds(), a full drain resets it.
+     *
+     * @param telegram  Client (its connection is reused for every alert)
+     * @param maxAlerts Maximum alerts to deliver in this call
+     *
+     * @return esp_err_t ESP_OK if the outbox was emptied up to maxAlerts,
+     *         else the first send error
+     */
+    esp_err_t drain(TelegramClient& telegram, size_t maxAlerts);
+
+    /**
+     * @brief Number of queued alerts (scans the SD card)
+     */
+    size_t pendingCount();
+
+    /**
+     * @brief Check whether alerts may be queued, without SD access
+     *
+     * True after power-on until the first scan, then tracks the outbox.
+     */
+    static bool mayHavePending();
+
+    /**
+     * @brief Delay before the next drain attempt (seconds)
+     *
+     * RETRY_INTERVAL_SECONDS doubled per failed drain since the last
+     * delivery, capped at RETRY_MAX_INTERVAL_SECONDS.
+     */
+    static int64_t retryIntervalSeconds();
+
+    static constexpr size_t MAX_FRAMES = 4;
+
+private:
+    char m_dir[32];
+    bool m_dirReady;
+
+    esp_err_t ensureDirectory();
+    void recordPath(char* path, size_t len, uint32_t id, const char* ext) const;
+    size_t listPending(uint32_t* ids, size_t maxIds);   // ids may be null if maxIds == 0
+    esp_err_t deliver(TelegramClient& telegram, uint32_t id);
+    void quarantine(uint32_t id);
+};
+
+} // namespace network
@@ -0,0 +1,187 @@
+/**
+ * @file command_poller.cpp
+ * @brief Telegram command poller implementation
+ */
+
+#include "command_poller.hpp"
+#include "credentials.hpp"
+#include "app_config.hpp"
+#include "runtime_config.hpp"
+
+#include "esp_log.h"
+#include "esp_attr.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+#include <sys/time.h>
+
+static const char* TAG = "CommandPoller";
+
+// Next update_id to fetch; updates below it are confirmed with Telegram
+RTC_DATA_ATTR static int64_t s_offset = 0;
+
+// Offset is in sync with the bot (false after power-on)
+RTC_DATA_ATTR static bool s_synced = false;
+
+// RTC time of the last poll
+RTC_DATA_ATTR static int64_t s_lastPollTime = 0;
+
+namespace network {
+
+namespace {
+
+struct CommandName {
+    const char* name;
+    CommandType type;
+};
+
+const CommandName COMMAND_NAMES[] = {
+    {"arm", CommandType::ARM},
+    {"disarm", CommandType::DISARM},
+    {"cooldown", CommandType::COOLDOWN},
+    {"status", CommandType::STATUS},
+    {"capture", CommandType::CAPTURE},
+    {"photo", CommandType::CAPTURE},
+    {"config", CommandType::CONFIG},
+    {"set", CommandType::SET},
+    {"unset", CommandType::UNSET},
+    {"logs", CommandType::LOGS},
+};
+
+/**
+ * @brief getUpdates callback state
+ */
+struct PollState {
+    BotCommand* commands;
+    size_t count;
+    int64_t maxUpdateId;
+    bool run;               // false while syncing: confirm, do not run
+};
+
+int64_t nowSec() {
+    struct timeval now = {};
+    gettimeofday(&now, nullptr);
+    return static_cast<int64_t>(now.tv_sec);
+}
+
+void onUpdate(const BotUpdate& update, void* context) {
+    PollState& state = *static_cast<PollState*>(context);
+    if (update.updateId > state.maxUpdateId) {
+        state.maxUpdateId = update.updateId;
+    }
+    if (!state.run) {
+        ESP_LOGI(TAG, "Dropping update %lld queued before power-on",
+                 static_cast<long long>(update.updateId));
+        return;
+    }
+    if (std::strcmp(update.chatId, credentials::telegram::CHAT_ID) != 0) {
+        ESP_LOGW(TAG, "Ignoring update %lld from chat %s",
+                 static_cast<long long>(update.updateId), update.chatId);
+        return;
+    }
+
+    BotCommand command = {};
+    if (!CommandPoller::parse(update.text, command)) {
+        return;
+    }
+    if (state.count < config::commands::MAX_UPDATES) {
+        state.commands[state.count++] = command;
+        ESP_LOGI(TAG, "Command: %s", update.text);
+    }
+}
+
+} // namespace
+
+int64_t CommandPoller::secondsUntilPoll() {
+    if (!config::commands::ENABLED) {
+        return -1;
+    }
+    const int64_t interval = config::RuntimeConfig::get(config::Setting::COMMAND_POLL_SECONDS);
+    int64_t remaining = s_lastPollTime + interval - nowSec();
+    return (remaining > 0) ? remaining : 0;
+}
+
+void CommandPoller::markAttempt() {
+    s_lastPollTime = nowSec();
+}
+
+esp_err_t CommandPoller::poll(TelegramClient& telegram, BotCommand* commands, size_t& count) {
+    count = 0;
+    s_lastPollTime = nowSec();
+
+    PollState state = {commands, 0, -1, s_synced};
+    esp_err_t err = ESP_OK;
+    if (!s_synced) {
+        // Latest update only; the next offset confirms it and all older ones
+        err = telegram.getUpdates(-1, 1, 0, &onUpdate, &state);
+        if (err == ESP_OK) {
+            s_synced = true;
+            if (state.maxUpdateId >= 0) {
+                s_offset = state.maxUpdateId + 1;
+            }
+            state.run = true;
+        }
+    }
+
+    if (err == ESP_OK) {
+        err = telegram.getUpdates(s_offset, config::commands::MAX_UPDATES,
+                                  config::commands::POLL_TIMEOUT_SECONDS, &onUpdate, &state);
+        if (state.maxUpdateId >= s_offset) {
+            s_offset = state.maxUpdateId + 1;
+        }
+    }
+
+    count = state.count;
+    return err;
+}
+
+bool CommandPoller::parse(const char* text, BotCommand& command) {
+    while (*text == ' ') {
+        text++;
+    }
+    if (*text != '/') {
+        return false;
+    }
+    text++;
+
+    // Command word, without a "@botname" suffix (group chats)
+    size_t wordLen = std::strcspn(text, " @");
+    const char* rest = text + std::strcspn(text, " ");
+
+    command.type = CommandType::HELP;
+    command.argument = -1;
+    for (const CommandName& entry : COMMAND_NAMES) {
+        if (std::strlen(entry.name) == wordLen && strncasecmp(entry.name, text, wordLen) == 0) {
+            command.type = entry.type;
+            break;
+        }
+    }
+
+    while (*rest == ' ') {
+        rest++;
+    }
+    std::strncpy(command.args, rest, BotCommand::ARGS_MAX - 1);
+    command.args[BotCommand::ARGS_MAX - 1] = '\0';
+    if (command.type == CommandType::COOLDOWN && std::isdigit(static_cast<unsigned char>(*rest))) {
+        command.argument = std::strtoll(rest, nullptr, 10) * 60;     // Minutes
+    }
+    return true;
+}
+
+const char* CommandPoller::helpText() {
+    return "Commands:\n"
+           "/arm - enable PIR alerts (ends a cooldown)\n"
+           "/disarm - disable PIR alerts\n"
+           "/cooldown <minutes> - alert cooldown\n"
+           "/status - status snapshot\n"
+           "/capture - photo now\n"
+           "/config - runtime settings\n"
+           "/set <name> <value> - override a setting\n"
+           "/unset <name> - back to the default\n"
+           "/logs - buffered log\n"
+           "Commands run at the next poll wake.";
+}
+
+} // namespace network
@@ -0,0 +1,112 @@
+#pragma once
+
+/**
+ * @file command_poller.hpp
+ * @brief Telegram bot commands fetched on timer wakes
+ *
+ * Provides:
+ * - getUpdates polling with the update_id offset kept in RTC memory
+ * - Commands accepted only from credentials::telegram::CHAT_ID
+ * - Parsing of /arm, /disarm, /cooldown <minutes>, /status, /capture,
+ *   /config, /set <name> <value>, /unset <name>, /logs (and /help for anything
+ *   else starting with '/')
+ *
+ * Applying a command is up to the caller. Without a saved offset (first
+ * poll after power-on) queued updates are confirmed but not run, so a
+ * stale /capture is not replayed on every reset.
+ */
+
+#include "esp_err.h"
+#include "telegram_client.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace network {
+
+/**
+ * @brief Commands understood by the bot
+ */
+enum class CommandType : uint8_t {
+    ARM,                // Enable the PIR wake and end a running cooldown
+    DISARM,             // Disable the PIR wake (timer wakes continue)
+    COOLDOWN,           // Set the alert cooldown (argument: seconds)
+    STATUS,             // Reply with a status snapshot
+    CAPTURE,            // Take and send a photo now
+    CONFIG,             // Reply with the runtime settings
+    SET,                // Override a runtime setting (args: "<name> <value>")
+    UNSET,              // Drop an override (args: "<name>")
+    LOGS,               // Reply with the buffered log (diagnostics::LogBuffer)
+    HELP                // Unknown command: reply with the command list
+};
+
+/**
+ * @brief One parsed command
+ */
+struct BotCommand {
+    static constexpr size_t ARGS_MAX = 40;
+    
+    CommandType type;
+    int64_t argument;   // COOLDOWN seconds; -1 if not given
+    char args[ARGS_MAX];    // Text after the command word (SET, UNSET)
+};
+
+/**
+ * @brief Command poller (static, RTC resident)
+ *
+ * @code
+ *   if (CommandPoller::isPollDue()) {
+ *       BotCommand commands[config::commands::MAX_UPDATES];
+ *       size_t count = 0;
+ *       CommandPoller::poll(telegram, commands, count);   // WiFi connected
+ *       for (size_t i = 0; i < count; i++) { ... }
+ *   }
+ * @endcode
+ */
+class CommandPoller {
+public:
+    /**
+     * @brief Seconds until the next poll (-1 = commands disabled)
+     */
+    static int64_t secondsUntilPoll();
+
+    /**
+     * @brief Check whether the periodic poll is due
+     */
+    static bool isPollDue() { return secondsUntilPoll() == 0; }
+
+    /**
+     * @brief Start the next poll interval now
+     *
+     * Call before connecting for a due poll: an uplink that never comes
+     * up then waits one interval instead of leaving the poll due (and the
+     * timer wake at 0 s) until WiFi returns.
+     */
+    static void markAttempt();
+
+    /**
+     * @brief Fetch pending commands and confirm them with Telegram
+     *
+     * Counts as the periodic poll whatever the outcome.
+     *
+     * @param telegram Client (its connection is reused)
+     * @param[out] commands Commands in arrival order (config::commands::MAX_UPDATES)
+     * @param[out] count    Number of commands
+     *
+     * @return esp_err_t ESP_OK, or the getUpdates error
+     */
+    static esp_err_t poll(TelegramClient& telegram, BotCommand* commands, size_t& count);
+
+    /**
+     * @brief Parse a message text ("/cmd[@bot] [argument]")
+     *
+     * @return true if the text is a command
+     */
+    static bool parse(const char* text, BotCommand& command);
+
+    /**
+     * @brief Command list for /help replies
+     */
+    static const char* helpText();
+};
+
+} // namespace network
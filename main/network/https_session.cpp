@@ -0,0 +1,628 @@
+/**
+ * @file https_session.cpp
+ * @brief HTTPS session implementation
+ */
+
+#include "https_session.hpp"
+#include "app_config.hpp"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_crt_bundle.h"
+
+#include "mbedtls/ssl.h"
+#include "mbedtls/net_sockets.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/x509_crt.h"
+
+#include "lwip/sockets.h"
+#include "lwip/netdb.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <strings.h>
+#include <new>
+
+static const char* TAG = "HttpsSession";
+
+// Serialized TLS session from the last successful handshake
+RTC_DATA_ATTR static uint8_t s_savedSession[config::network::TLS_SESSION_CACHE_SIZE];
+RTC_DATA_ATTR static size_t s_savedSessionLen = 0;
+
+namespace {
+
+timeval toTimeval(int timeoutMs) {
+    timeval tv;
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+    return tv;
+}
+
+/**
+ * @brief Bound blocking send() and recv() on the socket
+ */
+void setSocketTimeouts(int fd, int timeoutMs) {
+    const timeval tv = toTimeval(timeoutMs);
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+/**
+ * @brief Non-blocking connect to one address, waiting at most timeoutMs
+ *
+ * @return Connected blocking socket, or -1
+ */
+int connectWithTimeout(const addrinfo* address, int timeoutMs) {
+    int fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (fd < 0) {
+        return -1;
+    }
+    const int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+    int ret = connect(fd, address->ai_addr, address->ai_addrlen);
+    if (ret != 0 && errno == EINPROGRESS) {
+        fd_set writable;
+        FD_ZERO(&writable);
+        FD_SET(fd, &writable);
+        timeval tv = toTimeval(timeoutMs);
+        ret = select(fd + 1, nullptr, &writable, nullptr, &tv);
+        if (ret > 0) {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len);
+            ret = (error == 0) ? 0 : -1;
+        } else {
+            ret = -1;       // Timed out (0) or select failed
+        }
+    }
+    if (ret != 0) {
+        ::close(fd);
+        return -1;
+    }
+
+    fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+    setSocketTimeouts(fd, timeoutMs);
+    return fd;
+}
+
+} // namespace
+
+namespace network {
+
+struct HttpsSession::TlsState {
+    mbedtls_net_context net;
+    mbedtls_ssl_context ssl;
+    mbedtls_ssl_config conf;
+    mbedtls_ctr_drbg_context drbg;
+    mbedtls_entropy_context entropy;
+    mbedtls_x509_crt ca;
+
+    TlsState() {
+        mbedtls_net_init(&net);
+        mbedtls_ssl_init(&ssl);
+        mbedtls_ssl_config_init(&conf);
+        mbedtls_ctr_drbg_init(&drbg);
+        mbedtls_entropy_init(&entropy);
+        mbedtls_x509_crt_init(&ca);
+    }
+
+    ~TlsState() {
+        mbedtls_net_free(&net);
+        mbedtls_ssl_free(&ssl);
+        mbedtls_ssl_config_free(&conf);
+        mbedtls_ctr_drbg_free(&drbg);
+        mbedtls_entropy_free(&entropy);
+        mbedtls_x509_crt_free(&ca);
+    }
+};
+
+HttpsSession::HttpsSession(const char* host, uint16_t port, int timeoutMs,
+                           const char* caPem, bool resumable)
+    : m_host(host)
+    , m_port(port)
+    , m_timeoutMs(timeoutMs)
+    , m_caPem(caPem)
+    , m_resumable(resumable && config::network::TLS_SESSION_RESUMPTION)
+    , m_tls()
+    , m_rx{}
+    , m_rxPos(0)
+    , m_rxLen(0)
+    , m_keepAlive(false)
+    , m_chunked(false)
+    , m_bodyDone(true)
+    , m_bodyRemaining(0)
+    , m_lengthKnown(false)
+{
+}
+
+HttpsSession::~HttpsSession() {
+    close();
+}
+
+void HttpsSession::forgetSavedSession() {
+    s_savedSessionLen = 0;
+}
+
+esp_err_t HttpsSession::connect() {
+    if (m_tls) {
+        return ESP_OK;
+    }
+
+    m_tls.reset(new (std::nothrow) TlsState());
+    if (!m_tls) {
+        ESP_LOGE(TAG, "Failed to allocate TLS context");
+        return ESP_ERR_NO_MEM;
+    }
+
+    m_rxPos = 0;
+    m_rxLen = 0;
+    m_bodyDone = true;
+
+    int64_t startUs = esp_timer_get_time();
+    esp_err_t err = handshake();
+    if (err != ESP_OK) {
+        m_tls.reset();
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Connected to %s in %lld ms", m_host,
+             (esp_timer_get_time() - startUs) / 1000);
+    saveSession();
+    return ESP_OK;
+}
+
+esp_err_t HttpsSession::handshake() {
+    TlsState& tls = *m_tls;
+    int ret = mbedtls_ctr_drbg_seed(&tls.drbg, mbedtls_entropy_func, &tls.entropy,
+                                    nullptr, 0);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "DRBG seed failed: -0x%04x", -ret);
+        return ESP_FAIL;
+    }
+
+    ret = mbedtls_ssl_config_defaults(&tls.conf, MBEDTLS_SSL_IS_CLIENT,
+                                      MBEDTLS_SSL_TRANSPORT_STREAM,
+                                      MBEDTLS_SSL_PRESET_DEFAULT);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "SSL config failed: -0x%04x", -ret);
+        return ESP_FAIL;
+    }
+
+    // Pinned CA: one certificate to parse and check instead of the bundle
+    if (m_caPem) {
+        ret = mbedtls_x509_crt_parse(&tls.ca, reinterpret_cast<const unsigned char*>(m_caPem),
+                                     std::strlen(m_caPem) + 1);
+        if (ret != 0) {
+            ESP_LOGE(TAG, "Pinned CA parse failed: -0x%04x", -ret);
+            return ESP_FAIL;
+        }
+        mbedtls_ssl_conf_ca_chain(&tls.conf, &tls.ca, nullptr);
+    } else if (esp_crt_bundle_attach(&tls.conf) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to attach certificate bundle");
+        return ESP_FAIL;
+    }
+
+    mbedtls_ssl_conf_authmode(&tls.conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    mbedtls_ssl_conf_rng(&tls.conf, mbedtls_ctr_drbg_random, &tls.drbg);
+    mbedtls_ssl_conf_read_timeout(&tls.conf, static_cast<uint32_t>(m_timeoutMs));
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_conf_session_tickets(&tls.conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+
+    ret = mbedtls_ssl_setup(&tls.ssl, &tls.conf);
+    if (ret == 0) {
+        ret = mbedtls_ssl_set_hostname(&tls.ssl, m_host);
+    }
+    if (ret != 0) {
+        ESP_LOGE(TAG, "SSL setup failed: -0x%04x", -ret);
+        return ESP_FAIL;
+    }
+
+    // Offer the session from the previous wake for an abbreviated handshake
+    if (m_resumable && s_savedSessionLen > 0) {
+        mbedtls_ssl_session saved;
+        mbedtls_ssl_session_init(&saved);
+        if (mbedtls_ssl_session_load(&saved, s_savedSession, s_savedSessionLen) == 0 &&
+            mbedtls_ssl_set_session(&tls.ssl, &saved) == 0) {
+            ESP_LOGD(TAG, "Offering saved TLS session (%u bytes)",
+                     static_cast<unsigned>(s_savedSessionLen));
+        } else {
+            s_savedSessionLen = 0;
+        }
+        mbedtls_ssl_session_free(&saved);
+    }
+
+    esp_err_t err = connectSocket();
+    if (err != ESP_OK) {
+        return err;
+    }
+    mbedtls_ssl_set_bio(&tls.ssl, &tls.net, mbedtls_net_send, nullptr,
+                        mbedtls_net_recv_timeout);
+
+    const int64_t deadlineUs = esp_timer_get_time() + m_timeoutMs * 1000LL;
+    while ((ret = mbedtls_ssl_handshake(&tls.ssl)) != 0) {
+        if ((ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) ||
+            esp_timer_get_time() > deadlineUs) {
+            ESP_LOGE(TAG, "TLS handshake failed: -0x%04x", -ret);
+            // A stale ticket must not break every following wake
+            if (m_resumable) {
+                s_savedSessionLen = 0;
+            }
+            return ESP_FAIL;
+        }
+    }
+
+    uint32_t flags = mbedtls_ssl_get_verify_result(&tls.ssl);
+    if (flags != 0) {
+        ESP_LOGE(TAG, "Certificate verification failed: 0x%08lx",
+                 static_cast<unsigned long>(flags));
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t HttpsSession::connectSocket() {
+    char port[8];
+    std::snprintf(port, sizeof(port), "%u", m_port);
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(m_host, port, &hints, &addresses) != 0 || !addresses) {
+        ESP_LOGE(TAG, "DNS lookup for %s failed", m_host);
+        return ESP_FAIL;
+    }
+
+    // mbedtls_net_connect() would block for the lwIP connect timeout
+    int fd = -1;
+    for (const addrinfo* address = addresses; address && fd < 0; address = address->ai_next) {
+        fd = connectWithTimeout(address, m_timeoutMs);
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "TCP connect to %s failed or timed out (%d ms)", m_host, m_timeoutMs);
+        return ESP_ERR_TIMEOUT;
+    }
+    m_tls->net.fd = fd;
+    return ESP_OK;
+}
+
+void HttpsSession::saveSession() {
+    if (!m_resumable) {
+        return;
+    }
+
+    mbedtls_ssl_session session;
+    mbedtls_ssl_session_init(&session);
+
+    size_t len = 0;
+    if (mbedtls_ssl_get_session(&m_tls->ssl, &session) == 0 &&
+        mbedtls_ssl_session_save(&session, s_savedSession, sizeof(s_savedSession),
+                                 &len) == 0) {
+        s_savedSessionLen = len;
+        ESP_LOGD(TAG, "Saved TLS session (%u bytes)", static_cast<unsigned>(len));
+    } else {
+        // Too large for RTC memory or not resumable
+        s_savedSessionLen = 0;
+        ESP_LOGW(TAG, "TLS session not saved");
+    }
+
+    mbedtls_ssl_session_free(&session);
+}
+
+void HttpsSession::close() {
+    if (!m_tls) {
+        return;
+    }
+    mbedtls_ssl_close_notify(&m_tls->ssl);
+    m_tls.reset();
+
+    m_rxPos = 0;
+    m_rxLen = 0;
+    m_bodyDone = true;
+    ESP_LOGD(TAG, "Connection closed");
+}
+
+void HttpsSession::setReadTimeout(int timeoutMs) {
+    m_timeoutMs = timeoutMs;
+    if (m_tls) {
+        // The SSL context reads the timeout from its config on every receive
+        mbedtls_ssl_conf_read_timeout(&m_tls->conf, static_cast<uint32_t>(timeoutMs));
+        if (m_tls->net.fd >= 0) {
+            setSocketTimeouts(m_tls->net.fd, timeoutMs);
+        }
+    }
+}
+
+esp_err_t HttpsSession::writeAll(const void* data, size_t len) {
+    const unsigned char* ptr = static_cast<const unsigned char*>(data);
+    // SO_SNDTIMEO bounds each send; the deadline bounds retries without progress
+    int64_t deadlineUs = esp_timer_get_time() + m_timeoutMs * 1000LL;
+    while (len > 0) {
+        int ret = mbedtls_ssl_write(&m_tls->ssl, ptr, len);
+        if ((ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) &&
+            esp_timer_get_time() <= deadlineUs) {
+            continue;
+        }
+        if (ret <= 0) {
+            ESP_LOGE(TAG, "TLS write failed: -0x%04x", -ret);
+            return ESP_FAIL;
+        }
+        ptr += ret;
+        len -= static_cast<size_t>(ret);
+        deadlineUs = esp_timer_get_time() + m_timeoutMs * 1000LL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t HttpsSession::beginRequest(const char* method, const char* path,
+                                     const char* contentType, size_t contentLength) {
+    if (!m_bodyDone) {
+        // Previous response not drained; the stream is out of sync
+        close();
+    }
+
+    char header[REQUEST_HEADER_SIZE];
+    int headerLen;
+    if (contentType) {
+        headerLen = std::snprintf(header, sizeof(header),
+            "%s %s HTTP/1.1\r\n"
+            "Host: %s\r\n"
+            "User-Agent: ESP32-Sentinel\r\n"
+            "Connection: keep-alive\r\n"
+            "Content-Type: %s\r\n"
+            "Content-Length: %u\r\n\r\n",
+            method, path, m_host, contentType, static_cast<unsigned>(contentLength));
+    } else {
+        headerLen = std::snprintf(header, sizeof(header),
+            "%s %s HTTP/1.1\r\n"
+            "Host: %s\r\n"
+            "User-Agent: ESP32-Sentinel\r\n"
+            "Connection: keep-alive\r\n\r\n",
+            method, path, m_host);
+    }
+    if (headerLen < 0 || static_cast<size_t>(headerLen) >= sizeof(header)) {
+        ESP_LOGE(TAG, "Request header too long");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // A reused connection may have been closed by the server while idle;
+    // nothing of this request has been sent yet, so retry once on a new one
+    const bool reused = isConnected();
+    for (int attempt = 0; attempt < 2; attempt++) {
+        esp_err_t err = connect();
+        if (err != ESP_OK) {
+            return err;
+        }
+        if (writeAll(header, static_cast<size_t>(headerLen)) == ESP_OK) {
+            return ESP_OK;
+        }
+        close();
+        if (!reused) {
+            break;
+        }
+    }
+    return ESP_FAIL;
+}
+
+esp_err_t HttpsSession::write(const void* data, size_t len) {
+    if (!m_tls) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = writeAll(data, len);
+    if (err != ESP_OK) {
+        close();
+    }
+    return err;
+}
+
+int HttpsSession::fill() {
+    m_rxPos = 0;
+    m_rxLen = 0;
+    while (true) {
+        int ret = mbedtls_ssl_read(&m_tls->ssl, reinterpret_cast<unsigned char*>(m_rx),
+                                   sizeof(m_rx));
+        if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+            continue;
+        }
+        if (ret == 0 || ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) {
+            return 0;
+        }
+        if (ret < 0) {
+            ESP_LOGE(TAG, "TLS read failed: -0x%04x", -ret);
+            return -1;
+        }
+        m_rxLen = static_cast<size_t>(ret);
+        return ret;
+    }
+}
+
+esp_err_t HttpsSession::readLine(char* line, size_t len) {
+    size_t used = 0;
+    while (true) {
+        if (m_rxPos == m_rxLen && fill() <= 0) {
+            return ESP_FAIL;
+        }
+        char c = m_rx[m_rxPos++];
+        if (c == '\n') {
+            break;
+        }
+        // Over-long lines are truncated; only the prefix is ever parsed
+        if (c != '\r' && used + 1 < len) {
+            line[used++] = c;
+        }
+    }
+    line[used] = '\0';
+    return ESP_OK;
+}
+
+esp_err_t HttpsSession::finishRequest(int& statusCode) {
+    statusCode = 0;
+    if (!m_tls) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    char line[LINE_BUFFER_SIZE];
+    int minor = 0;
+    if (readLine(line, sizeof(line)) != ESP_OK ||
+        std::sscanf(line, "HTTP/1.%d %d", &minor, &statusCode) != 2) {
+        ESP_LOGE(TAG, "Invalid or missing status line");
+        close();
+        return ESP_FAIL;
+    }
+
+    m_keepAlive = (minor >= 1);
+    m_chunked = false;
+    m_lengthKnown = false;
+    m_bodyRemaining = 0;
+
+    while (true) {
+        if (readLine(line, sizeof(line)) != ESP_OK) {
+            ESP_LOGE(TAG, "Truncated response headers");
+            close();
+            return ESP_FAIL;
+        }
+        if (line[0] == '\0') {
+            break;
+        }
+
+        char* value = std::strchr(line, ':');
+        if (!value) {
+            continue;
+        }
+        *value++ = '\0';
+        while (*value == ' ') {
+            value++;
+        }
+
+        if (strcasecmp(line, "Content-Length") == 0) {
+            m_bodyRemaining = std::strtoul(value, nullptr, 10);
+            m_lengthKnown = true;
+        } else if (strcasecmp(line, "Transfer-Encoding") == 0) {
+            m_chunked = (strcasestr(value, "chunked") != nullptr);
+        } else if (strcasecmp(line, "Connection") == 0) {
+            if (strcasestr(value, "close")) {
+                m_keepAlive = false;
+            } else if (strcasestr(value, "keep-alive")) {
+                m_keepAlive = true;
+            }
+        }
+    }
+
+    if (m_chunked) {
+        m_lengthKnown = false;
+        m_bodyRemaining = 0;
+    } else if (!m_lengthKnown) {
+        // Body runs until the server closes the connection
+        m_keepAlive = false;
+    }
+
+    m_bodyDone = false;
+    if (m_lengthKnown && m_bodyRemaining == 0) {
+        endOfBody();
+    }
+    return ESP_OK;
+}
+
+esp_err_t HttpsSession::nextChunk() {
+    char line[LINE_BUFFER_SIZE];
+    if (readLine(line, sizeof(line)) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    m_bodyRemaining = std::strtoul(line, nullptr, 16);
+    if (m_bodyRemaining > 0) {
+        return ESP_OK;
+    }
+
+    // Last chunk: skip optional trailers up to the blank line
+    do {
+        if (readLine(line, sizeof(line)) != ESP_OK) {
+            return ESP_FAIL;
+        }
+    } while (line[0] != '\0');
+    endOfBody();
+    return ESP_OK;
+}
+
+void HttpsSession::endOfBody() {
+    m_bodyDone = true;
+    if (!m_keepAlive) {
+        close();
+    }
+}
+
+int HttpsSession::readBody(char* buffer, size_t len) {
+    if (m_bodyDone) {
+        return 0;
+    }
+    if (!m_tls || !buffer || len == 0) {
+        return -1;
+    }
+
+    if (m_chunked && m_bodyRemaining == 0) {
+        if (nextChunk() != ESP_OK) {
+            close();
+            return -1;
+        }
+        if (m_bodyDone) {
+            return 0;
+        }
+    }
+
+    if (m_rxPos == m_rxLen) {
+        int ret = fill();
+        if (ret <= 0) {
+            if (ret == 0 && !m_lengthKnown && !m_chunked) {
+                endOfBody();
+                return 0;
+            }
+            close();
+            return -1;
+        }
+    }
+
+    size_t n = m_rxLen - m_rxPos;
+    if (n > len) {
+        n = len;
+    }
+    if ((m_lengthKnown || m_chunked) && n > m_bodyRemaining) {
+        n = m_bodyRemaining;
+    }
+    std::memcpy(buffer, m_rx + m_rxPos, n);
+    m_rxPos += n;
+
+    if (m_lengthKnown || m_chunked) {
+        m_bodyRemaining -= n;
+        if (m_bodyRemaining == 0) {
+            if (m_lengthKnown) {
+                endOfBody();
+            } else {
+                // CRLF after the chunk data
+                char crlf[4];
+                if (readLine(crlf, sizeof(crlf)) != ESP_OK) {
+                    close();
+                }
+            }
+        }
+    }
+    return static_cast<int>(n);
+}
+
+esp_err_t HttpsSession::discardBody() {
+    char scratch[128];
+    int ret;
+    while ((ret = readBody(scratch, sizeof(scratch))) > 0) {
+    }
+    return (ret == 0) ? ESP_OK : ESP_FAIL;
+}
+
+} // namespace network
@@ -0,0 +1,165 @@
+#pragma once
+
+/**
+ * @file https_session.hpp
+ * @brief Persistent HTTPS/1.1 connection with TLS session resumption
+ *
+ * Provides:
+ * - One keep-alive TLS connection reused for several requests
+ * - TLS session (ticket or session id) saved in RTC memory so the first
+ *   request after deep sleep does an abbreviated handshake
+ * - Optional CA pinning instead of the full certificate bundle
+ * - Streaming request bodies and Content-Length / chunked responses
+ *
+ * @note Built directly on mbedTLS: esp_http_client does not expose a way
+ *       to inject a saved session before the handshake.
+ */
+
+#include "esp_err.h"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+namespace network {
+
+/**
+ * @brief HTTPS client session bound to a single host
+ *
+ * @code
+ *   HttpsSession session("api.telegram.org", 443, timeoutMs);
+ *   session.beginRequest("POST", "/bot.../sendMessage", "application/json", len);
+ *   session.write(body, len);
+ *   int status = 0;
+ *   session.finishRequest(status);
+ *   session.discardBody();
+ * @endcode
+ */
+class HttpsSession {
+public:
+    /**
+     * @brief Construct a session (does not connect)
+     *
+     * @param host      Server host name (also used for SNI and verification)
+     * @param port      Server port
+     * @param timeoutMs TCP connect timeout, and limit for each send and
+     *                  receive call
+     * @param caPem     Pinned CA certificate (NUL-terminated PEM), or
+     *                  nullptr to verify against the certificate bundle
+     * @param resumable Use the RTC session cache; it holds one session,
+     *                  so only the Telegram connection owns it
+     */
+    HttpsSession(const char* host, uint16_t port, int timeoutMs,
+                 const char* caPem = nullptr, bool resumable = true);
+    ~HttpsSession();
+
+    // Disable copy operations
+    HttpsSession(const HttpsSession&) = delete;
+    HttpsSession& operator=(const HttpsSession&) = delete;
+
+    /**
+     * @brief Open the TLS connection if it is not already open
+     *
+     * Offers the session saved in RTC memory for resumption and saves the
+     * new session after a successful handshake.
+     *
+     * @return esp_err_t ESP_OK, ESP_ERR_NO_MEM or ESP_FAIL
+     */
+    esp_err_t connect();
+
+    /**
+     * @brief Send close_notify and release the connection
+     */
+    void close();
+
+    /**
+     * @brief Change the send/receive timeout (applies to an open
+     *        connection too)
+     */
+    void setReadTimeout(int timeoutMs);
+
+    /**
+     * @brief Check whether the connection is open
+     */
+    bool isConnected() const { return m_tls != nullptr; }
+
+    /**
+     * @brief Connect if needed and send the request line and headers
+     *
+     * @param method        HTTP method ("POST", "GET")
+     * @param path          Request path including query string
+     * @param contentType   Body content type (nullptr for no body)
+     * @param contentLength Exact body length that will be written
+     *
+     * @return esp_err_t ESP_OK or ESP_FAIL
+     */
+    esp_err_t beginRequest(const char* method, const char* path,
+                           const char* contentType, size_t contentLength);
+
+    /**
+     * @brief Write part of the request body
+     */
+    esp_err_t write(const void* data, size_t len);
+
+    /**
+     * @brief Read the response status line and headers
+     *
+     * @param[out] statusCode HTTP status code
+     *
+     * @return esp_err_t ESP_OK or ESP_FAIL (connection is closed on failure)
+     */
+    esp_err_t finishRequest(int& statusCode);
+
+    /**
+     * @brief Read part of the response body
+     *
+     * @return int Bytes read, 0 at end of body, negative on error
+     */
+    int readBody(char* buffer, size_t len);
+
+    /**
+     * @brief Read and drop the rest of the response body
+     *
+     * Required before the next request on a keep-alive connection.
+     */
+    esp_err_t discardBody();
+
+    /**
+     * @brief Drop the TLS session saved in RTC memory
+     */
+    static void forgetSavedSession();
+
+private:
+    struct TlsState;
+
+    static constexpr size_t RX_BUFFER_SIZE = 512;
+    static constexpr size_t LINE_BUFFER_SIZE = 256;
+    static constexpr size_t REQUEST_HEADER_SIZE = 384;
+
+    const char* m_host;
+    uint16_t m_port;
+    int m_timeoutMs;
+    const char* m_caPem;
+    bool m_resumable;
+    std::unique_ptr<TlsState> m_tls;
+
+    // Response parser state
+    char m_rx[RX_BUFFER_SIZE];
+    size_t m_rxPos;
+    size_t m_rxLen;
+    bool m_keepAlive;
+    bool m_chunked;
+    bool m_bodyDone;
+    size_t m_bodyRemaining;    // Content-Length or current chunk remainder
+    bool m_lengthKnown;
+
+    esp_err_t handshake();
+    esp_err_t connectSocket();
+    void saveSession();
+    esp_err_t writeAll(const void* data, size_t len);
+    int fill();
+    esp_err_t readLine(char* line, size_t len);
+    esp_err_t nextChunk();
+    void endOfBody();
+};
+
+} // namespace network
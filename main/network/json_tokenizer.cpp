@@ -0,0 +1,314 @@
+/**
+ * @file json_tokenizer.cpp
+ * @brief Streaming JSON tokenizer implementation
+ */
+
+#include "json_tokenizer.hpp"
+
+#include <cstring>
+
+namespace network {
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool isNumberChar(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+} // namespace
+
+JsonTokenizer::JsonTokenizer(JsonTokenFn onToken, void* context)
+    : m_onToken(onToken)
+    , m_context(context)
+    , m_state(State::VALUE)
+    , m_depth(0)
+    , m_isObject{}
+    , m_keys{}
+    , m_text{}
+    , m_textLen(0)
+    , m_truncated(false)
+    , m_stringIsKey(false)
+    , m_unicode(0)
+    , m_unicodeDigits(0)
+{
+}
+
+void JsonTokenizer::reset() {
+    m_state = State::VALUE;
+    m_depth = 0;
+    m_keys[0][0] = '\0';
+    m_textLen = 0;
+    m_text[0] = '\0';
+}
+
+const char* JsonTokenizer::keyAt(int depth) const {
+    if (depth < 0 || depth > m_depth) {
+        return "";
+    }
+    return m_keys[depth];
+}
+
+esp_err_t JsonTokenizer::feed(const char* data, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        if (m_state == State::ERROR) {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        if (step(data[i])) {
+            i++;
+        }
+    }
+    return (m_state == State::ERROR) ? ESP_ERR_INVALID_RESPONSE : ESP_OK;
+}
+
+void JsonTokenizer::beginText() {
+    m_textLen = 0;
+    m_text[0] = '\0';
+    m_truncated = false;
+}
+
+void JsonTokenizer::appendText(char c) {
+    if (m_textLen + 1 < TEXT_MAX) {
+        m_text[m_textLen++] = c;
+        m_text[m_textLen] = '\0';
+    } else {
+        m_truncated = true;
+    }
+}
+
+void JsonTokenizer::appendUtf8(uint32_t codepoint) {
+    if (codepoint >= 0xD800 && codepoint <= 0xDFFF) {
+        appendText('?');                    // Surrogate halves are not paired up
+    } else if (codepoint < 0x80) {
+        appendText(static_cast<char>(codepoint));
+    } else if (codepoint < 0x800) {
+        appendText(static_cast<char>(0xC0 | (codepoint >> 6)));
+        appendText(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    } else {
+        appendText(static_cast<char>(0xE0 | (codepoint >> 12)));
+        appendText(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        appendText(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+}
+
+void JsonTokenizer::emit(JsonTokenType type, const char* text) {
+    if (!m_onToken) {
+        return;
+    }
+    JsonToken token = {};
+    token.type = type;
+    token.depth = m_depth;
+    token.key = m_keys[m_depth];
+    token.text = text;
+    token.truncated = (text == m_text) && m_truncated;
+    m_onToken(*this, token, m_context);
+}
+
+void JsonTokenizer::valueDone() {
+    m_state = (m_depth == 0) ? State::DONE : State::AFTER_VALUE;
+}
+
+void JsonTokenizer::openContainer(bool isObject) {
+    if (m_depth >= MAX_DEPTH) {
+        m_state = State::ERROR;
+        return;
+    }
+    emit(isObject ? JsonTokenType::OBJECT_BEGIN : JsonTokenType::ARRAY_BEGIN, "");
+    m_isObject[m_depth] = isObject;
+    m_depth++;
+    m_keys[m_depth][0] = '\0';
+    m_state = isObject ? State::KEY_OR_END : State::VALUE_OR_END;
+}
+
+void JsonTokenizer::closeContainer(bool isObject) {
+    m_depth--;
+    emit(isObject ? JsonTokenType::OBJECT_END : JsonTokenType::ARRAY_END, "");
+    valueDone();
+}
+
+void JsonTokenizer::endString() {
+    if (m_stringIsKey) {
+        std::strncpy(m_keys[m_depth], m_text, KEY_MAX - 1);
+        m_keys[m_depth][KEY_MAX - 1] = '\0';
+        m_state = State::COLON;
+    } else {
+        emit(JsonTokenType::STRING, m_text);
+        valueDone();
+    }
+}
+
+bool JsonTokenizer::step(char c) {
+    switch (m_state) {
+        case State::VALUE_OR_END:
+            if (c == ']') {
+                closeContainer(false);
+                return true;
+            }
+            [[fallthrough]];
+        case State::VALUE:
+            if (isSpace(c)) {
+                return true;
+            }
+            if (c == '{' || c == '[') {
+                openContainer(c == '{');
+            } else if (c == '"') {
+                beginText();
+                m_stringIsKey = false;
+                m_state = State::STRING;
+            } else if (c == '-' || (c >= '0' && c <= '9')) {
+                beginText();
+                appendText(c);
+                m_state = State::NUMBER;
+            } else if (c >= 'a' && c <= 'z') {
+                beginText();
+                appendText(c);
+                m_state = State::LITERAL;
+            } else {
+                m_state = State::ERROR;
+            }
+            return true;
+
+        case State::KEY_OR_END:
+            if (c == '}') {
+                closeContainer(true);
+                return true;
+            }
+            [[fallthrough]];
+        case State::KEY:
+            if (isSpace(c)) {
+                return true;
+            }
+            if (c == '"') {
+                beginText();
+                m_stringIsKey = true;
+                m_state = State::STRING;
+            } else {
+                m_state = State::ERROR;
+            }
+            return true;
+
+        case State::COLON:
+            if (c == ':') {
+                m_state = State::VALUE;
+            } else if (!isSpace(c)) {
+                m_state = State::ERROR;
+            }
+            return true;
+
+        case State::AFTER_VALUE: {
+            if (isSpace(c)) {
+                return true;
+            }
+            const bool inObject = m_isObject[m_depth - 1];
+            if (c == ',') {
+                m_keys[m_depth][0] = '\0';
+                m_state = inObject ? State::KEY : State::VALUE;
+            } else if (c == (inObject ? '}' : ']')) {
+                closeContainer(inObject);
+            } else {
+                m_state = State::ERROR;
+            }
+            return true;
+        }
+
+        case State::STRING:
+            if (c == '"') {
+                endString();
+            } else if (c == '\\') {
+                m_state = State::ESCAPE;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                m_state = State::ERROR;
+            } else {
+                appendText(c);
+            }
+            return true;
+
+        case State::ESCAPE:
+            m_state = State::STRING;
+            switch (c) {
+                case '"':
+                case '\\':
+                case '/': appendText(c); break;
+                case 'b': appendText('\b'); break;
+                case 'f': appendText('\f'); break;
+                case 'n': appendText('\n'); break;
+                case 'r': appendText('\r'); break;
+                case 't': appendText('\t'); break;
+                case 'u':
+                    m_unicode = 0;
+                    m_unicodeDigits = 0;
+                    m_state = State::UNICODE;
+                    break;
+                default:
+                    m_state = State::ERROR;
+                    break;
+            }
+            return true;
+
+        case State::UNICODE: {
+            int digit = hexValue(c);
+            if (digit < 0) {
+                m_state = State::ERROR;
+                return true;
+            }
+            m_unicode = (m_unicode << 4) | static_cast<uint32_t>(digit);
+            if (++m_unicodeDigits == 4) {
+                appendUtf8(m_unicode);
+                m_state = State::STRING;
+            }
+            return true;
+        }
+
+        case State::NUMBER:
+            if (isNumberChar(c)) {
+                appendText(c);
+                return true;
+            }
+            emit(JsonTokenType::NUMBER, m_text);
+            valueDone();
+            return false;                   // c belongs to what follows
+
+        case State::LITERAL:
+            if (c >= 'a' && c <= 'z') {
+                appendText(c);
+                return true;
+            }
+            if (std::strcmp(m_text, "true") != 0 && std::strcmp(m_text, "false") != 0 &&
+                std::strcmp(m_text, "null") != 0) {
+                m_state = State::ERROR;
+                return true;
+            }
+            emit(JsonTokenType::LITERAL, m_text);
+            valueDone();
+            return false;
+
+        case State::DONE:
+            if (!isSpace(c)) {
+                m_state = State::ERROR;
+            }
+            return true;
+
+        case State::ERROR:
+        default:
+            return true;
+    }
+}
+
+} // namespace network
@@ -0,0 +1,149 @@
+#pragma once
+
+/**
+ * @file json_tokenizer.hpp
+ * @brief Streaming JSON tokenizer with fixed memory
+ *
+ * Takes a response body in arbitrary pieces (as they come off the TLS
+ * stream) and reports each value as a token, so the body is never
+ * buffered whole. Keys of all enclosing objects are kept, which is all
+ * a caller needs to pick fields out of a known document shape.
+ *
+ * Strings and numbers longer than TEXT_MAX - 1 and keys longer than
+ * KEY_MAX - 1 are truncated; escapes are decoded (\uXXXX to UTF-8).
+ */
+
+#include "esp_err.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace network {
+
+/**
+ * @brief JSON token types
+ */
+enum class JsonTokenType : uint8_t {
+    OBJECT_BEGIN,
+    OBJECT_END,
+    ARRAY_BEGIN,
+    ARRAY_END,
+    STRING,
+    NUMBER,
+    LITERAL,            // true, false or null
+};
+
+/**
+ * @brief One token; pointers are valid only during the callback
+ */
+struct JsonToken {
+    JsonTokenType type;
+    int depth;          // Enclosing containers (the top-level value is 0)
+    const char* key;    // Key of this value in its object ("" in arrays)
+    const char* text;   // Value text (STRING, NUMBER, LITERAL; "" otherwise)
+    bool truncated;     // text was cut at TEXT_MAX - 1
+};
+
+class JsonTokenizer;
+
+/**
+ * @brief Token callback
+ *
+ * @param tokenizer Source tokenizer (for keyAt() on enclosing objects)
+ */
+using JsonTokenFn = void (*)(const JsonTokenizer& tokenizer, const JsonToken& token,
+                             void* context);
+
+/**
+ * @brief Incremental JSON tokenizer
+ *
+ * @code
+ *   JsonTokenizer json(&onToken, &state);
+ *   while ((n = session.readBody(buf, sizeof(buf))) > 0) {
+ *       if (json.feed(buf, n) != ESP_OK) break;
+ *   }
+ *   bool ok = json.isComplete();
+ * @endcode
+ */
+class JsonTokenizer {
+public:
+    static constexpr int MAX_DEPTH = 12;
+    static constexpr size_t KEY_MAX = 24;
+    static constexpr size_t TEXT_MAX = 160;
+
+    JsonTokenizer(JsonTokenFn onToken, void* context);
+
+    /**
+     * @brief Tokenize the next piece of the document
+     *
+     * @return esp_err_t
+     *         - ESP_OK (more input may follow)
+     *         - ESP_ERR_INVALID_RESPONSE on a syntax error or nesting
+     *           deeper than MAX_DEPTH (later calls fail too)
+     */
+    esp_err_t feed(const char* data, size_t len);
+
+    /**
+     * @brief Check whether the top-level value has been closed
+     */
+    bool isComplete() const { return m_state == State::DONE; }
+
+    /**
+     * @brief Key of the enclosing value at a depth ("" for array items)
+     *
+     * @param depth 0..token depth
+     */
+    const char* keyAt(int depth) const;
+
+    /**
+     * @brief Start a new document
+     */
+    void reset();
+
+private:
+    enum class State : uint8_t {
+        VALUE,              // Expecting a value
+        VALUE_OR_END,       // After '[': a value or ']'
+        KEY_OR_END,         // After '{': a key or '}'
+        KEY,                // After ',' in an object: a key
+        COLON,
+        AFTER_VALUE,        // ',' or the closing bracket
+        STRING,
+        ESCAPE,
+        UNICODE,
+        NUMBER,
+        LITERAL,
+        DONE,
+        ERROR
+    };
+
+    JsonTokenFn m_onToken;
+    void* m_context;
+    State m_state;
+    int m_depth;                            // Open containers
+    bool m_isObject[MAX_DEPTH];
+    char m_keys[MAX_DEPTH + 1][KEY_MAX];    // Key of the value at each depth
+    char m_text[TEXT_MAX];
+    size_t m_textLen;
+    bool m_truncated;
+    bool m_stringIsKey;
+    uint32_t m_unicode;
+    int m_unicodeDigits;
+
+    /**
+     * @brief Handle one character (may leave it for the next state)
+     *
+     * @return true if the character was used
+     */
+    bool step(char c);
+
+    void beginText();
+    void appendText(char c);
+    void appendUtf8(uint32_t codepoint);
+    void endString();
+    void emit(JsonTokenType type, const char* text);
+    void openContainer(bool isObject);
+    void closeContainer(bool isObject);
+    void valueDone();
+};
+
+} // namespace network
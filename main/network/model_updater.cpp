@@ -0,0 +1,330 @@
+/**
+ * @file model_updater.cpp
+ * @brief Model update implementation
+ */
+
+#include "model_updater.hpp"
+#include "model_slots.hpp"
+#include "app_config.hpp"
+#include "runtime_config.hpp"
+
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "spi_flash_mmap.h"
+#include "mbedtls/sha256.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/time.h>
+
+static const char* TAG = "ModelUpdater";
+
+// RTC time of the last update check
+RTC_DATA_ATTR static int64_t s_lastCheckTime = 0;
+
+namespace network {
+
+namespace {
+
+using detection::ModelSlots;
+
+constexpr size_t SHA256_LEN = ModelSlots::SHA256_LEN;
+constexpr size_t CHUNK_SIZE = config::model::CHUNK_SIZE;
+constexpr size_t MANIFEST_MAX_LEN = 128;
+constexpr uint32_t PROGRESS_LOG_BYTES = 64 * 1024;
+
+static_assert(CHUNK_SIZE % SPI_FLASH_SEC_SIZE == 0,
+              "Chunks are erased sector by sector");
+
+int64_t nowSec() {
+    struct timeval tv = {};
+    gettimeofday(&tv, nullptr);
+    return static_cast<int64_t>(tv.tv_sec);
+}
+
+int hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Parse "<64 hex digits> <decimal size>"
+ */
+bool parseManifest(const char* text, uint8_t* sha256, uint32_t& size) {
+    for (size_t i = 0; i < SHA256_LEN; i++) {
+        int hi = hexNibble(text[2 * i]);
+        int lo = (hi < 0) ? -1 : hexNibble(text[2 * i + 1]);
+        if (lo < 0) {
+            return false;
+        }
+        sha256[i] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    char* end = nullptr;
+    unsigned long value = std::strtoul(text + 2 * SHA256_LEN, &end, 10);
+    if (end == text + 2 * SHA256_LEN || value == 0) {
+        return false;
+    }
+    size = static_cast<uint32_t>(value);
+    return true;
+}
+
+} // namespace
+
+ModelUpdater::ModelUpdater()
+    : m_session(config::model::UPDATE_HOST, config::model::UPDATE_PORT,
+                config::RuntimeConfig::get(config::Setting::HTTP_TIMEOUT_MS), nullptr, false)
+{
+}
+
+bool ModelUpdater::isEnabled() {
+    return config::model::UPDATE_HOST[0] != '\0';
+}
+
+int64_t ModelUpdater::secondsUntilCheck() {
+    if (!isEnabled()) {
+        return -1;
+    }
+    int64_t remaining = s_lastCheckTime + config::model::CHECK_INTERVAL_SECONDS - nowSec();
+    return (remaining > 0) ? remaining : 0;
+}
+
+bool ModelUpdater::isCheckDue() {
+    return secondsUntilCheck() == 0;
+}
+
+esp_err_t ModelUpdater::fetchManifest(uint8_t* sha256, uint32_t& size) {
+    int status = 0;
+    if (m_session.beginRequest("GET", config::model::MANIFEST_PATH, nullptr, 0) != ESP_OK ||
+        m_session.finishRequest(status) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    char text[MANIFEST_MAX_LEN + 1];
+    size_t len = 0;
+    int n;
+    while (len < MANIFEST_MAX_LEN &&
+           (n = m_session.readBody(text + len, MANIFEST_MAX_LEN - len)) > 0) {
+        len += static_cast<size_t>(n);
+    }
+    text[len] = '\0';
+    m_session.discardBody();
+
+    if (status != 200) {
+        ESP_LOGE(TAG, "Manifest request failed: HTTP %d", status);
+        return ESP_FAIL;
+    }
+    if (len < 2 * SHA256_LEN + 2 || !parseManifest(text, sha256, size)) {
+        ESP_LOGE(TAG, "Malformed manifest");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ModelUpdater::hashPartition(const esp_partition_t* part, uint32_t size,
+                                      uint8_t* buffer, uint8_t* sha256) {
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+
+    esp_err_t err = ESP_OK;
+    for (uint32_t offset = 0; offset < size && err == ESP_OK; offset += CHUNK_SIZE) {
+        size_t len = std::min<size_t>(CHUNK_SIZE, size - offset);
+        err = esp_partition_read(part, offset, buffer, len);
+        if (err == ESP_OK) {
+            mbedtls_sha256_update(&ctx, buffer, len);
+        }
+    }
+    mbedtls_sha256_finish(&ctx, sha256);
+    mbedtls_sha256_free(&ctx);
+    return err;
+}
+
+bool ModelUpdater::activeSlotMatches(const uint8_t* sha256, uint32_t size, uint8_t* buffer) {
+    const int slot = ModelSlots::activeSlot();
+    uint8_t recorded[SHA256_LEN];
+    uint32_t recordedSize = 0;
+    if (ModelSlots::getImage(slot, recorded, recordedSize) == ESP_OK) {
+        return recordedSize == size && std::memcmp(recorded, sha256, SHA256_LEN) == 0;
+    }
+
+    // Factory image: nothing recorded yet, hash what is in flash
+    const esp_partition_t* part = ModelSlots::partition(slot);
+    if (!part || size > part->size ||
+        hashPartition(part, size, buffer, recorded) != ESP_OK ||
+        std::memcmp(recorded, sha256, SHA256_LEN) != 0) {
+        return false;
+    }
+    ModelSlots::activate(slot, recorded, size);
+    return true;
+}
+
+void ModelUpdater::markAttempt() {
+    s_lastCheckTime = nowSec();
+}
+
+esp_err_t ModelUpdater::checkAndUpdate() {
+    if (!isEnabled()) {
+        return ESP_OK;
+    }
+    s_lastCheckTime = nowSec();
+    if (ModelSlots::isOnTrial()) {
+        // The inactive slot holds the model a failed trial reverts to
+        ESP_LOGI(TAG, "Model in %s still on trial, update deferred", ModelSlots::activeLabel());
+        return ESP_OK;
+    }
+
+    uint8_t sha256[SHA256_LEN];
+    uint32_t size = 0;
+    esp_err_t err = fetchManifest(sha256, size);
+    if (err != ESP_OK) {
+        m_session.close();
+        return err;
+    }
+    if (ModelSlots::isRejected(sha256)) {
+        // Failed its trial on this device; wait for a different image
+        ESP_LOGW(TAG, "Published model was rejected here, not installing");
+        m_session.close();
+        return ESP_OK;
+    }
+
+    uint8_t* buffer = static_cast<uint8_t*>(heap_caps_malloc(CHUNK_SIZE, MALLOC_CAP_DEFAULT));
+    if (!buffer) {
+        m_session.close();
+        return ESP_ERR_NO_MEM;
+    }
+    bool current = activeSlotMatches(sha256, size, buffer);
+    heap_caps_free(buffer);
+
+    if (current) {
+        ESP_LOGI(TAG, "Model in %s is current", ModelSlots::activeLabel());
+        err = ESP_OK;
+    } else {
+        err = install(config::model::MODEL_PATH, sha256, size);
+    }
+    m_session.close();
+    return err;
+}
+
+esp_err_t ModelUpdater::install(const char* path, const uint8_t* sha256, uint32_t size) {
+    if (ModelSlots::isOnTrial()) {
+        ESP_LOGE(TAG, "Active model on trial, not overwriting the fallback slot");
+        return ESP_ERR_INVALID_STATE;
+    }
+    const int slot = ModelSlots::inactiveSlot();
+    const esp_partition_t* part = ModelSlots::partition(slot);
+    if (!part) {
+        ESP_LOGE(TAG, "No %s partition in the table", ModelSlots::label(slot));
+        return ESP_FAIL;
+    }
+    if (size > part->size) {
+        ESP_LOGE(TAG, "Model (%lu bytes) exceeds slot %s (%lu bytes)",
+                 static_cast<unsigned long>(size), part->label,
+                 static_cast<unsigned long>(part->size));
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    int status = 0;
+    if (m_session.beginRequest("GET", path, nullptr, 0) != ESP_OK ||
+        m_session.finishRequest(status) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    if (status != 200) {
+        ESP_LOGE(TAG, "Model request failed: HTTP %d", status);
+        m_session.discardBody();
+        return ESP_FAIL;
+    }
+
+    uint8_t* buffer = static_cast<uint8_t*>(heap_caps_malloc(CHUNK_SIZE, MALLOC_CAP_DEFAULT));
+    if (!buffer) {
+        m_session.close();
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Downloading %lu byte model into %s", static_cast<unsigned long>(size),
+             part->label);
+
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+
+    // Fill one chunk from the stream, then erase its sector(s) and write it
+    esp_err_t err = ESP_OK;
+    uint32_t written = 0;
+    size_t fill = 0;
+    bool end = false;
+    while (err == ESP_OK && !end) {
+        int n = m_session.readBody(reinterpret_cast<char*>(buffer) + fill, CHUNK_SIZE - fill);
+        if (n < 0) {
+            ESP_LOGE(TAG, "Download interrupted at %lu bytes",
+                     static_cast<unsigned long>(written + fill));
+            err = ESP_FAIL;
+            break;
+        }
+        fill += static_cast<size_t>(n);
+        end = (n == 0);
+
+        if (fill == CHUNK_SIZE || (end && fill > 0)) {
+            if (written + fill > size) {
+                ESP_LOGE(TAG, "Server sent more than %lu bytes", static_cast<unsigned long>(size));
+                err = ESP_ERR_INVALID_SIZE;
+                break;
+            }
+            size_t eraseLen = (fill + SPI_FLASH_SEC_SIZE - 1) & ~(SPI_FLASH_SEC_SIZE - 1);
+            err = esp_partition_erase_range(part, written, eraseLen);
+            if (err == ESP_OK) {
+                err = esp_partition_write(part, written, buffer, fill);
+            }
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Flash write at %lu failed: %s",
+                         static_cast<unsigned long>(written), esp_err_to_name(err));
+                break;
+            }
+            mbedtls_sha256_update(&ctx, buffer, fill);
+            if ((written / PROGRESS_LOG_BYTES) != ((written + fill) / PROGRESS_LOG_BYTES)) {
+                ESP_LOGI(TAG, "  %lu / %lu bytes", static_cast<unsigned long>(written + fill),
+                         static_cast<unsigned long>(size));
+            }
+            written += fill;
+            fill = 0;
+        }
+    }
+
+    uint8_t received[SHA256_LEN];
+    mbedtls_sha256_finish(&ctx, received);
+    mbedtls_sha256_free(&ctx);
+
+    if (err != ESP_OK) {
+        m_session.close();
+    } else if (written != size) {
+        ESP_LOGE(TAG, "Model truncated: %lu of %lu bytes", static_cast<unsigned long>(written),
+                 static_cast<unsigned long>(size));
+        err = ESP_FAIL;
+    } else if (std::memcmp(received, sha256, SHA256_LEN) != 0) {
+        ESP_LOGE(TAG, "Downloaded model hash mismatch");
+        err = ESP_ERR_INVALID_CRC;
+    } else {
+        // Hash what actually landed in flash before trusting the slot
+        uint8_t stored[SHA256_LEN];
+        err = hashPartition(part, size, buffer, stored);
+        if (err == ESP_OK && std::memcmp(stored, sha256, SHA256_LEN) != 0) {
+            ESP_LOGE(TAG, "Flash readback hash mismatch");
+            err = ESP_ERR_INVALID_CRC;
+        }
+    }
+    heap_caps_free(buffer);
+
+    if (err == ESP_OK) {
+        err = ModelSlots::activate(slot, sha256, size);
+    }
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "✓ Model updated, %s active from the next model load", part->label);
+    }
+    return err;
+}
+
+} // namespace network
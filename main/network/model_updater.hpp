@@ -0,0 +1,113 @@
+#pragma once
+
+/**
+ * @file model_updater.hpp
+ * @brief Over-the-air detection model updates into the inactive A/B slot
+ *
+ * Provides:
+ * - Manifest check ("<sha256 hex> <size>") against the active slot
+ * - Streaming download straight into the inactive model partition in
+ *   CHUNK_SIZE pieces (the model is never buffered whole)
+ * - SHA-256 over the received stream and again over the written flash
+ * - Atomic slot switch through ModelSlots (NVS)
+ *
+ * The new model is used from the next model load (next PIR wake).
+ */
+
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "https_session.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace network {
+
+/**
+ * @brief Model update client for config::model::UPDATE_HOST
+ *
+ * @code
+ *   if (ModelUpdater::isCheckDue()) {
+ *       ModelUpdater updater;
+ *       updater.checkAndUpdate();      // WiFi must be connected
+ *   }
+ * @endcode
+ */
+class ModelUpdater {
+public:
+    ModelUpdater();
+    ~ModelUpdater() = default;
+
+    // Disable copy operations
+    ModelUpdater(const ModelUpdater&) = delete;
+    ModelUpdater& operator=(const ModelUpdater&) = delete;
+
+    /**
+     * @brief Check whether an update server is configured
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Check whether the periodic update check is due
+     */
+    static bool isCheckDue();
+
+    /**
+     * @brief Seconds until the next update check (-1 = updates disabled)
+     */
+    static int64_t secondsUntilCheck();
+
+    /**
+     * @brief Start the next check interval now
+     *
+     * Call before connecting for a due check: an uplink that never comes
+     * up then waits one interval instead of leaving the check due (and
+     * the timer wake at 0 s) until WiFi returns.
+     */
+    static void markAttempt();
+
+    /**
+     * @brief Fetch the manifest and install the model if it differs
+     *
+     * Counts as the periodic check whatever the outcome, so a broken
+     * server is retried at the next interval rather than every wake.
+     * Skipped while the active model is on trial: the inactive slot is
+     * then the one to revert to.
+     *
+     * @return esp_err_t ESP_OK if the active model is current (updated or not)
+     */
+    esp_err_t checkAndUpdate();
+
+    /**
+     * @brief Download a model into the inactive slot and switch to it
+     *
+     * @param path   Model path on the update server
+     * @param sha256 Expected SHA-256 (32 bytes)
+     * @param size   Expected size in bytes
+     *
+     * @return esp_err_t
+     *         - ESP_OK on success (slot switched)
+     *         - ESP_ERR_INVALID_STATE while the active model is on trial
+     *         - ESP_ERR_INVALID_SIZE if the model does not fit the slot
+     *         - ESP_ERR_INVALID_CRC on a hash mismatch (slot not switched)
+     *         - ESP_FAIL on a download or flash error
+     */
+    esp_err_t install(const char* path, const uint8_t* sha256, uint32_t size);
+
+private:
+    HttpsSession m_session;
+
+    esp_err_t fetchManifest(uint8_t* sha256, uint32_t& size);
+
+    /**
+     * @brief Check whether the active slot already holds this image
+     */
+    static bool activeSlotMatches(const uint8_t* sha256, uint32_t size, uint8_t* buffer);
+
+    /**
+     * @brief SHA-256 of the first size bytes of a partition
+     */
+    static esp_err_t hashPartition(const esp_partition_t* part, uint32_t size,
+                                   uint8_t* buffer, uint8_t* sha256);
+};
+
+} // namespace network
@@ -4,20 +4,219 @@
  */
 
 #include "telegram_client.hpp"
+#include "json_tokenizer.hpp"
 #include "credentials.hpp"
 #include "app_config.hpp"
+#include "runtime_config.hpp"
 
 #include "esp_log.h"
-#include "esp_http_client.h"
-#include "esp_crt_bundle.h"
 
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
 static const char* TAG = "TelegramClient";
 
+#if TELEGRAM_CA_PINNED
+// Embedded from main/certs/telegram_ca.pem (see main/CMakeLists.txt)
+extern const char telegram_ca_pem_start[] asm("_binary_telegram_ca_pem_start");
+static const char* const PINNED_CA = telegram_ca_pem_start;
+#else
+static const char* const PINNED_CA = nullptr;
+#endif
+
 namespace network {
 
+/**
+ * @brief Host, port and path prefix of credentials::telegram::API_BASE_URL
+ */
+struct ApiEndpoint {
+    char host[64];
+    uint16_t port;
+    const char* pathPrefix;     // Points into API_BASE_URL ("/bot")
+};
+
+/**
+ * @brief Split API_BASE_URL ("https://host[:port]/bot") once
+ */
+static const ApiEndpoint& apiEndpoint() {
+    static ApiEndpoint endpoint = {};
+    if (endpoint.port != 0) {
+        return endpoint;
+    }
+
+    const char* url = credentials::telegram::API_BASE_URL;
+    const char* scheme = std::strstr(url, "://");
+    if (!scheme) {
+        ESP_LOGE(TAG, "API_BASE_URL has no scheme: %s", url);
+    } else if (scheme - url != 5 || std::strncmp(url, "https", 5) != 0) {
+        ESP_LOGE(TAG, "API_BASE_URL must be https (TLS only): %s", url);
+    }
+    const char* host = scheme ? scheme + 3 : url;
+    const char* path = std::strchr(host, '/');
+    endpoint.pathPrefix = path ? path : "";
+
+    const size_t authorityLen = path ? static_cast<size_t>(path - host) : std::strlen(host);
+    const char* colon = static_cast<const char*>(std::memchr(host, ':', authorityLen));
+    const size_t hostLen = colon ? static_cast<size_t>(colon - host) : authorityLen;
+    if (hostLen >= sizeof(endpoint.host)) {
+        ESP_LOGE(TAG, "API_BASE_URL host too long");
+    }
+    std::snprintf(endpoint.host, sizeof(endpoint.host), "%.*s", static_cast<int>(hostLen), host);
+
+    const long port = colon ? std::strtol(colon + 1, nullptr, 10) : 443;
+    endpoint.port = (port > 0 && port <= 65535) ? static_cast<uint16_t>(port) : 443;
+    return endpoint;
+}
+
+/**
+ * @brief Append text as a JSON string literal (with quotes)
+ *
+ * @return size_t New length, or 0 if the buffer is too small
+ */
+static size_t appendJsonString(char* out, size_t cap, size_t pos, const char* text) {
+    auto put = [&](char c) {
+        if (pos + 1 >= cap) {
+            return false;
+        }
+        out[pos++] = c;
+        return true;
+    };
+
+    if (!put('"')) {
+        return 0;
+    }
+    for (const char* p = text; *p; p++) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        bool ok = true;
+        if (c == '"' || c == '\\') {
+            ok = put('\\') && put(static_cast<char>(c));
+        } else if (c == '\n') {
+            ok = put('\\') && put('n');
+        } else if (c < 0x20) {
+            char esc[8];
+            std::snprintf(esc, sizeof(esc), "\\u%04x", c);
+            for (const char* e = esc; *e && ok; e++) {
+                ok = put(*e);
+            }
+        } else {
+            ok = put(static_cast<char>(c));
+        }
+        if (!ok) {
+            return 0;
+        }
+    }
+    if (!put('"')) {
+        return 0;
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+/**
+ * @brief getUpdates parse state
+ *
+ * Document shape: {"ok":true,"result":[{"update_id":N,
+ * "message":{"chat":{"id":N,...},"text":"...",...}},...]}
+ */
+struct UpdateParser {
+    UpdateFn onUpdate;
+    void* context;
+    BotUpdate current;
+    bool inUpdate;
+    bool ok;
+    size_t count;
+};
+
+static void copyText(char* out, size_t cap, const char* text) {
+    std::snprintf(out, cap, "%s", text);
+}
+
+static void onUpdateToken(const JsonTokenizer& json, const JsonToken& token, void* context) {
+    UpdateParser& parser = *static_cast<UpdateParser*>(context);
+
+    if (token.depth == 1 && token.type == JsonTokenType::LITERAL &&
+        std::strcmp(token.key, "ok") == 0) {
+        parser.ok = (std::strcmp(token.text, "true") == 0);
+        return;
+    }
+
+    // Elements of "result" are the updates
+    if (token.depth == 2 && std::strcmp(json.keyAt(1), "result") == 0) {
+        if (token.type == JsonTokenType::OBJECT_BEGIN) {
+            parser.current = {};
+            parser.inUpdate = true;
+        } else if (token.type == JsonTokenType::OBJECT_END && parser.inUpdate) {
+            parser.inUpdate = false;
+            parser.count++;
+            if (parser.onUpdate) {
+                parser.onUpdate(parser.current, parser.context);
+            }
+        }
+        return;
+    }
+    if (!parser.inUpdate) {
+        return;
+    }
+
+    const bool inMessage = token.depth >= 4 && std::strcmp(json.keyAt(3), "message") == 0;
+    if (token.depth == 3 && token.type == JsonTokenType::NUMBER &&
+        std::strcmp(token.key, "update_id") == 0) {
+        parser.current.updateId = std::strtoll(token.text, nullptr, 10);
+    } else if (inMessage && token.depth == 4 && token.type == JsonTokenType::STRING &&
+               std::strcmp(token.key, "text") == 0) {
+        copyText(parser.current.text, sizeof(parser.current.text), token.text);
+    } else if (inMessage && token.depth == 5 && token.type == JsonTokenType::NUMBER &&
+               std::strcmp(json.keyAt(4), "chat") == 0 && std::strcmp(token.key, "id") == 0) {
+        copyText(parser.current.chatId, sizeof(parser.current.chatId), token.text);
+    }
+}
+
+TelegramClient::TelegramClient()
+    : m_session(apiEndpoint().host, apiEndpoint().port,
+                config::RuntimeConfig::get(config::Setting::HTTP_TIMEOUT_MS), PINNED_CA)
+{
+}
+
+TelegramClient::~TelegramClient() {
+    close();
+}
+
+void TelegramClient::close() {
+    m_session.close();
+}
+
+esp_err_t TelegramClient::buildPath(char* path, size_t len, const char* method) {
+    int n = std::snprintf(path, len, "%s%s/%s", apiEndpoint().pathPrefix,
+                          credentials::telegram::BOT_TOKEN, method);
+    if (n < 0 || static_cast<size_t>(n) >= len) {
+        ESP_LOGE(TAG, "Request path for %s too long", method);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t TelegramClient::finishRequest(const char* method) {
+    int statusCode = 0;
+    esp_err_t err = m_session.finishRequest(statusCode);
+    if (err == ESP_OK) {
+        // Drain so the connection can carry the next request
+        err = m_session.discardBody();
+    }
+
+    if (!config::network::TELEGRAM_KEEP_ALIVE) {
+        m_session.close();
+    }
+
+    ESP_LOGI(TAG, "%s: status=%d", method, statusCode);
+
+    if (err == ESP_OK && statusCode == 200) {
+        return ESP_OK;
+    }
+    ESP_LOGE(TAG, "Telegram API error, status: %d", statusCode);
+    return ESP_FAIL;
+}
+
 esp_err_t TelegramClient::sendDocument(const uint8_t* data, size_t dataLen,
                                         const char* caption,
                                         const char* filename) {
@@ -25,31 +224,16 @@ esp_err_t TelegramClient::sendDocument(const uint8_t* data, size_t dataLen,
         ESP_LOGE(TAG, "Invalid data pointer or length");
         return ESP_ERR_INVALID_ARG;
     }
-    
-    // Build URL
-    char url[256];
-    std::snprintf(url, sizeof(url), "%s%s/sendDocument",
-                  credentials::telegram::API_BASE_URL,
-                  credentials::telegram::BOT_TOKEN);
-    
-    // Configure HTTP client
-    esp_http_client_config_t config = {};
-    config.url = url;
-    config.method = HTTP_METHOD_POST;
-    config.transport_type = HTTP_TRANSPORT_OVER_SSL;
-    config.crt_bundle_attach = esp_crt_bundle_attach;
-    config.timeout_ms = config::timing::HTTP_TIMEOUT_MS;
-    
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (!client) {
-        ESP_LOGE(TAG, "Failed to initialize HTTP client");
-        return ESP_ERR_NO_MEM;
-    }
-    
+
+    char path[PATH_BUFFER_SIZE];
+    if (buildPath(path, sizeof(path), "sendDocument") != ESP_OK) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
     // Build multipart form data
     char header[HEADER_BUFFER_SIZE];
     char tail[TAIL_BUFFER_SIZE];
-    
+
     int headerLen = std::snprintf(header, sizeof(header),
         "--%s\r\n"
         "Content-Disposition: form-data; name=\"chat_id\"\r\n\r\n"
@@ -64,107 +248,277 @@ esp_err_t TelegramClient::sendDocument(const uint8_t* data, size_t dataLen,
         BOUNDARY, caption,
         BOUNDARY, filename
     );
-    
+
     int tailLen = std::snprintf(tail, sizeof(tail), "\r\n--%s--\r\n", BOUNDARY);
-    
-    // Set content type header
+
+    if (headerLen < 0 || static_cast<size_t>(headerLen) >= sizeof(header)) {
+        ESP_LOGE(TAG, "Multipart header too long");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
     char contentType[64];
-    std::snprintf(contentType, sizeof(contentType), 
+    std::snprintf(contentType, sizeof(contentType),
                   "multipart/form-data; boundary=%s", BOUNDARY);
-    esp_http_client_set_header(client, "Content-Type", contentType);
-    
+
     // Calculate total content length
-    int totalLen = headerLen + static_cast<int>(dataLen) + tailLen;
-    
-    // Open connection and send data
-    esp_err_t err = esp_http_client_open(client, totalLen);
+    size_t totalLen = static_cast<size_t>(headerLen) + dataLen + static_cast<size_t>(tailLen);
+
+    // Open (or reuse) connection and send data
+    esp_err_t err = m_session.beginRequest("POST", path, contentType, totalLen);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to open connection: %s", esp_err_to_name(err));
-        esp_http_client_cleanup(client);
         return err;
     }
-    
-    // Write header
-    int written = esp_http_client_write(client, header, headerLen);
-    if (written != headerLen) {
+
+    if (m_session.write(header, headerLen) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to write header");
-        esp_http_client_cleanup(client);
         return ESP_FAIL;
     }
-    
-    // Write image data
-    written = esp_http_client_write(client, reinterpret_cast<const char*>(data), 
-                                    static_cast<int>(dataLen));
-    if (written != static_cast<int>(dataLen)) {
+
+    if (m_session.write(data, dataLen) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to write image data");
-        esp_http_client_cleanup(client);
         return ESP_FAIL;
     }
-    
-    // Write tail
-    written = esp_http_client_write(client, tail, tailLen);
-    if (written != tailLen) {
+
+    if (m_session.write(tail, tailLen) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to write tail");
-        esp_http_client_cleanup(client);
         return ESP_FAIL;
     }
-    
-    // Get response
-    int contentLength = esp_http_client_fetch_headers(client);
-    int statusCode = esp_http_client_get_status_code(client);
-    
-    ESP_LOGI(TAG, "Response: status=%d, content_length=%d", statusCode, contentLength);
-    
-    esp_http_client_cleanup(client);
-    
-    if (statusCode == 200) {
+
+    err = finishRequest("sendDocument");
+    if (err == ESP_OK) {
         ESP_LOGI(TAG, "Document sent successfully!");
-        return ESP_OK;
+    }
+    return err;
+}
+
+esp_err_t TelegramClient::sendMediaGroup(const MediaItem* items, size_t count,
+                                          const char* caption,
+                                          MediaReleaseFn release, void* context) {
+    size_t released = 0;
+    auto releaseUpTo = [&](size_t end) {
+        for (; released < end; released++) {
+            if (release) {
+                release(released, context);
+            }
+        }
+    };
+
+    if (!items || count < MEDIA_GROUP_MIN || count > MEDIA_GROUP_MAX) {
+        ESP_LOGE(TAG, "Media group needs %u-%u items, got %u",
+                 static_cast<unsigned>(MEDIA_GROUP_MIN),
+                 static_cast<unsigned>(MEDIA_GROUP_MAX),
+                 static_cast<unsigned>(count));
+        releaseUpTo(items ? count : 0);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char path[PATH_BUFFER_SIZE];
+    if (buildPath(path, sizeof(path), "sendMediaGroup") != ESP_OK) {
+        releaseUpTo(count);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // media field: [{"type":"photo","media":"attach://photo0","caption":...},...]
+    char media[MEDIA_JSON_BUFFER_SIZE];
+    size_t mediaLen = 0;
+    bool mediaOk = true;
+    for (size_t i = 0; i < count && mediaOk; i++) {
+        int n = std::snprintf(media + mediaLen, sizeof(media) - mediaLen,
+                              "%s{\"type\":\"photo\",\"media\":\"attach://photo%u\"",
+                              (i == 0) ? "[" : ",", static_cast<unsigned>(i));
+        mediaOk = (n > 0 && mediaLen + n < sizeof(media));
+        if (!mediaOk) {
+            break;
+        }
+        mediaLen += n;
+
+        if (i == 0 && caption) {
+            n = std::snprintf(media + mediaLen, sizeof(media) - mediaLen, ",\"caption\":");
+            mediaOk = (n > 0 && mediaLen + n < sizeof(media));
+            if (mediaOk) {
+                mediaLen = appendJsonString(media, sizeof(media), mediaLen + n, caption);
+                mediaOk = (mediaLen > 0);
+            }
+        }
+
+        if (mediaOk) {
+            n = std::snprintf(media + mediaLen, sizeof(media) - mediaLen, "}");
+            mediaOk = (n > 0 && mediaLen + n < sizeof(media));
+            mediaLen += n;
+        }
+    }
+    if (mediaOk && mediaLen + 1 < sizeof(media)) {
+        media[mediaLen++] = ']';
+        media[mediaLen] = '\0';
     } else {
-        ESP_LOGE(TAG, "Telegram API error, status: %d", statusCode);
-        return ESP_FAIL;
+        ESP_LOGE(TAG, "Media group description too long");
+        releaseUpTo(count);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // Leading fields, then one part header per photo
+    char header[HEADER_BUFFER_SIZE];
+    int headerLen = std::snprintf(header, sizeof(header),
+        "--%s\r\n"
+        "Content-Disposition: form-data; name=\"chat_id\"\r\n\r\n"
+        "%s\r\n"
+        "--%s\r\n"
+        "Content-Disposition: form-data; name=\"media\"\r\n\r\n",
+        BOUNDARY, credentials::telegram::CHAT_ID, BOUNDARY);
+
+    auto formatPartHeader = [](char* buf, size_t len, size_t index) {
+        return std::snprintf(buf, len,
+            "\r\n--%s\r\n"
+            "Content-Disposition: form-data; name=\"photo%u\"; filename=\"photo%u.jpg\"\r\n"
+            "Content-Type: image/jpeg\r\n\r\n",
+            BOUNDARY, static_cast<unsigned>(index), static_cast<unsigned>(index));
+    };
+
+    char partHeader[TAIL_BUFFER_SIZE + 32];
+    char tail[TAIL_BUFFER_SIZE];
+    int tailLen = std::snprintf(tail, sizeof(tail), "\r\n--%s--\r\n", BOUNDARY);
+
+    // Content-Length must be known up front: sum the parts without building them
+    size_t totalLen = static_cast<size_t>(headerLen) + mediaLen + static_cast<size_t>(tailLen);
+    for (size_t i = 0; i < count; i++) {
+        totalLen += static_cast<size_t>(formatPartHeader(partHeader, sizeof(partHeader), i));
+        totalLen += items[i].len;
+    }
+
+    char contentType[64];
+    std::snprintf(contentType, sizeof(contentType),
+                  "multipart/form-data; boundary=%s", BOUNDARY);
+
+    esp_err_t err = m_session.beginRequest("POST", path, contentType, totalLen);
+    if (err == ESP_OK) {
+        err = m_session.write(header, headerLen);
+    }
+    if (err == ESP_OK) {
+        err = m_session.write(media, mediaLen);
+    }
+
+    for (size_t i = 0; i < count && err == ESP_OK; i++) {
+        int partLen = formatPartHeader(partHeader, sizeof(partHeader), i);
+        err = m_session.write(partHeader, partLen);
+        if (err == ESP_OK) {
+            err = m_session.write(items[i].data, items[i].len);
+        }
+        // Frame buffer goes back to the camera while the next one streams
+        releaseUpTo(i + 1);
     }
+    releaseUpTo(count);
+
+    if (err == ESP_OK) {
+        err = m_session.write(tail, tailLen);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to stream media group: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    err = finishRequest("sendMediaGroup");
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Media group of %u photos sent", static_cast<unsigned>(count));
+    }
+    return err;
 }
 
 esp_err_t TelegramClient::sendMessage(const char* message) {
-    // Build URL
-    char url[256];
-    std::snprintf(url, sizeof(url), "%s%s/sendMessage",
-                  credentials::telegram::API_BASE_URL,
-                  credentials::telegram::BOT_TOKEN);
-    
-    // Build JSON payload
-    char payload[512];
-    std::snprintf(payload, sizeof(payload),
-                  "{\"chat_id\":\"%s\",\"text\":\"%s\"}",
-                  credentials::telegram::CHAT_ID, message);
-    
-    // Configure HTTP client
-    esp_http_client_config_t config = {};
-    config.url = url;
-    config.method = HTTP_METHOD_POST;
-    config.transport_type = HTTP_TRANSPORT_OVER_SSL;
-    config.crt_bundle_attach = esp_crt_bundle_attach;
-    config.timeout_ms = config::timing::HTTP_TIMEOUT_MS;
-    
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (!client) {
-        return ESP_ERR_NO_MEM;
-    }
-    
-    esp_http_client_set_header(client, "Content-Type", "application/json");
-    esp_http_client_set_post_field(client, payload, std::strlen(payload));
-    
-    esp_err_t err = esp_http_client_perform(client);
-    int statusCode = esp_http_client_get_status_code(client);
-    
-    esp_http_client_cleanup(client);
-    
+    char path[PATH_BUFFER_SIZE];
+    if (buildPath(path, sizeof(path), "sendMessage") != ESP_OK) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // Build JSON payload (text escaped: reports and replies span lines)
+    char payload[MESSAGE_BUFFER_SIZE];
+    int prefixLen = std::snprintf(payload, sizeof(payload), "{\"chat_id\":\"%s\",\"text\":",
+                                  credentials::telegram::CHAT_ID);
+    size_t payloadLen = 0;
+    if (prefixLen > 0 && static_cast<size_t>(prefixLen) < sizeof(payload)) {
+        payloadLen = appendJsonString(payload, sizeof(payload), static_cast<size_t>(prefixLen),
+                                      message ? message : "");
+    }
+    if (payloadLen == 0 || payloadLen + 2 > sizeof(payload)) {
+        ESP_LOGE(TAG, "Message too long");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    payload[payloadLen++] = '}';
+    payload[payloadLen] = '\0';
+
+    esp_err_t err = m_session.beginRequest("POST", path, "application/json", payloadLen);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (m_session.write(payload, payloadLen) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    return finishRequest("sendMessage");
+}
+
+esp_err_t TelegramClient::getUpdates(int64_t offset, size_t limit, int timeoutSec,
+                                      UpdateFn onUpdate, void* context) {
+    char path[PATH_BUFFER_SIZE + QUERY_BUFFER_SIZE];
+    if (buildPath(path, sizeof(path), "getUpdates") != ESP_OK) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    size_t pathLen = std::strlen(path);
+    int queryLen = std::snprintf(path + pathLen, sizeof(path) - pathLen,
+                                 "?offset=%lld&limit=%u&timeout=%d"
+                                 "&allowed_updates=%%5B%%22message%%22%%5D",
+                                 static_cast<long long>(offset), static_cast<unsigned>(limit),
+                                 timeoutSec);
+    if (queryLen < 0 || pathLen + static_cast<size_t>(queryLen) >= sizeof(path)) {
+        ESP_LOGE(TAG, "getUpdates path too long");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // The server holds the response for up to timeoutSec when idle
+    m_session.setReadTimeout(timeoutSec * 1000 + config::commands::POLL_READ_MARGIN_MS);
+
+    int statusCode = 0;
+    esp_err_t err = m_session.beginRequest("GET", path, nullptr, 0);
+    if (err == ESP_OK) {
+        err = m_session.finishRequest(statusCode);
+    }
+
+    UpdateParser parser = {};
+    parser.onUpdate = onUpdate;
+    parser.context = context;
     if (err == ESP_OK && statusCode == 200) {
-        return ESP_OK;
+        JsonTokenizer json(&onUpdateToken, &parser);
+        char chunk[BODY_CHUNK_SIZE];
+        int n = 0;
+        while (err == ESP_OK && (n = m_session.readBody(chunk, sizeof(chunk))) > 0) {
+            err = json.feed(chunk, static_cast<size_t>(n));
+        }
+        if (err == ESP_OK && n < 0) {
+            err = ESP_FAIL;
+        } else if (err == ESP_OK && (!json.isComplete() || !parser.ok)) {
+            err = ESP_ERR_INVALID_RESPONSE;
+        }
+        if (err != ESP_OK) {
+            // Body may be partly unread; the stream is out of sync
+            m_session.close();
+        }
+    } else if (err == ESP_OK) {
+        m_session.discardBody();
+        err = ESP_FAIL;
     }
-    
-    return ESP_FAIL;
+
+    m_session.setReadTimeout(config::RuntimeConfig::get(config::Setting::HTTP_TIMEOUT_MS));
+    if (!config::network::TELEGRAM_KEEP_ALIVE) {
+        m_session.close();
+    }
+
+    ESP_LOGI(TAG, "getUpdates: status=%d, %u update(s)", statusCode,
+             static_cast<unsigned>(parser.count));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "getUpdates failed: %s", esp_err_to_name(err));
+    }
+    return err;
 }
 
 } // namespace network
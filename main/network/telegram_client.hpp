@@ -7,23 +7,64 @@
  * Provides methods for:
  * - Sending text messages
  * - Sending photos/documents with captions
+ * - Sending photo bursts as one media group request
+ * - Long-polling getUpdates, parsed as it streams in (JsonTokenizer)
+ * - Reusing one keep-alive connection for all requests of a wake
  * 
- * @note Uses ESP-TLS with certificate bundle for HTTPS
+ * @note Uses HttpsSession (mbedTLS) with session resumption across deep
+ *       sleep and an optional pinned CA (main/certs/telegram_ca.pem)
  */
 
 #include "esp_err.h"
+#include "https_session.hpp"
 #include <cstdint>
 #include <cstddef>
 
 namespace network {
 
+/**
+ * @brief One JPEG buffer of a media group upload
+ */
+struct MediaItem {
+    const uint8_t* data;
+    size_t len;
+};
+
+/**
+ * @brief Called once per item as soon as its bytes have been sent
+ *
+ * @param index   Index of the item in the array passed to sendMediaGroup()
+ * @param context User context
+ */
+using MediaReleaseFn = void (*)(size_t index, void* context);
+
+/**
+ * @brief One incoming update (message) from getUpdates
+ */
+struct BotUpdate {
+    static constexpr size_t TEXT_MAX = 64;
+    
+    int64_t updateId;
+    char chatId[24];            // message.chat.id as sent ("" if absent)
+    char text[TEXT_MAX];        // message.text, truncated ("" if absent)
+};
+
+/**
+ * @brief Called for each update as soon as it has been parsed
+ */
+using UpdateFn = void (*)(const BotUpdate& update, void* context);
+
 /**
  * @brief Telegram Bot client for sending alerts
  */
 class TelegramClient {
 public:
-    TelegramClient() = default;
-    ~TelegramClient() = default;
+    TelegramClient();
+    ~TelegramClient();
+    
+    // Disable copy operations
+    TelegramClient(const TelegramClient&) = delete;
+    TelegramClient& operator=(const TelegramClient&) = delete;
     
     /**
      * @brief Send a document (photo) with caption
@@ -50,11 +91,90 @@ public:
      * @return esp_err_t 
      */
     esp_err_t sendMessage(const char* message);
+    
+    /**
+     * @brief Send several photos as one album (sendMediaGroup)
+     * 
+     * All items are streamed into a single multipart request; no combined
+     * payload is built in RAM. Each item is handed to @p release right
+     * after its bytes are written, and every item is released exactly once
+     * even when the upload fails.
+     * 
+     * Streaming is from buffers that are complete when the call is made:
+     * the request does not start while frames are still being captured,
+     * so it saves RAM (frames freed during the upload), not latency. The
+     * caller must be done with a frame before it can be released here.
+     * 
+     * @param items    JPEG buffers (MEDIA_GROUP_MIN..MEDIA_GROUP_MAX)
+     * @param count    Number of items
+     * @param caption  Caption shown on the album (first item)
+     * @param release  Optional per-item release callback
+     * @param context  Argument passed to @p release
+     * 
+     * @return esp_err_t 
+     *         - ESP_OK on success
+     *         - ESP_ERR_INVALID_ARG if count is out of range
+     *         - ESP_FAIL on HTTP error
+     */
+    esp_err_t sendMediaGroup(const MediaItem* items, size_t count,
+                             const char* caption,
+                             MediaReleaseFn release = nullptr,
+                             void* context = nullptr);
+    
+    /**
+     * @brief Fetch pending updates (getUpdates, message updates only)
+     * 
+     * The body is tokenized as it is read; nothing beyond one update is
+     * buffered. The read timeout is lowered to the long-poll wait plus
+     * config::commands::POLL_READ_MARGIN_MS for this request.
+     * 
+     * @param offset     First update id to return (confirms older ones);
+     *                   -1 returns only the latest update
+     * @param limit      Maximum number of updates
+     * @param timeoutSec Long-poll wait when nothing is pending
+     * @param onUpdate   Called once per update
+     * @param context    Argument passed to @p onUpdate
+     * 
+     * @return esp_err_t 
+     *         - ESP_OK on success (possibly no updates)
+     *         - ESP_ERR_INVALID_RESPONSE on a malformed or "ok":false body
+     *         - ESP_FAIL on HTTP error
+     */
+    esp_err_t getUpdates(int64_t offset, size_t limit, int timeoutSec,
+                         UpdateFn onUpdate, void* context);
+    
+    // Telegram accepts 2-10 items per media group
+    static constexpr size_t MEDIA_GROUP_MIN = 2;
+    static constexpr size_t MEDIA_GROUP_MAX = 10;
+    
+    /**
+     * @brief Close the connection (call before WiFi is torn down)
+     */
+    void close();
 
 private:
     static constexpr const char* BOUNDARY = "X-ESPIDF-MULTIPART-BOUNDARY";
     static constexpr size_t HEADER_BUFFER_SIZE = 512;
     static constexpr size_t TAIL_BUFFER_SIZE = 128;
+    static constexpr size_t PATH_BUFFER_SIZE = 128;
+    static constexpr size_t MEDIA_JSON_BUFFER_SIZE = 1024;
+    static constexpr size_t MESSAGE_BUFFER_SIZE = 1024;
+    static constexpr size_t QUERY_BUFFER_SIZE = 96;
+    static constexpr size_t BODY_CHUNK_SIZE = 256;
+    
+    HttpsSession m_session;
+    
+    /**
+     * @brief Build the request path for a Bot API method
+     * 
+     * @return esp_err_t ESP_OK, or ESP_ERR_INVALID_SIZE if it does not fit
+     */
+    static esp_err_t buildPath(char* path, size_t len, const char* method);
+    
+    /**
+     * @brief Read the response, drain the body and map the status code
+     */
+    esp_err_t finishRequest(const char* method);
 };
 
 } // namespace network
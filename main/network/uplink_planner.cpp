@@ -0,0 +1,196 @@
+/**
+ * @file uplink_planner.cpp
+ * @brief Uplink estimator and alert planner implementation
+ */
+
+#include "uplink_planner.hpp"
+
+#include "esp_log.h"
+#include "esp_attr.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const char* TAG = "UplinkPlanner";
+
+namespace {
+
+/**
+ * @brief Link estimate carried across deep sleep
+ */
+struct UplinkState {
+    bool valid;
+    uint32_t throughputBps;         // 0 = not measured yet
+    float throughputRssi;           // RSSI the throughput was measured at (0 = unknown)
+    int8_t lastRssi;                // This or the last connected wake (0 = unknown)
+    float bytesPerPixel[config::uplink::LADDER_SIZE];
+};
+
+RTC_DATA_ATTR UplinkState s_state = {};
+
+UplinkState& state() {
+    if (!s_state.valid) {
+        s_state.throughputBps = 0;
+        s_state.throughputRssi = 0.0f;
+        s_state.lastRssi = 0;
+        for (size_t i = 0; i < config::uplink::LADDER_SIZE; i++) {
+            s_state.bytesPerPixel[i] = config::uplink::LADDER[i].bytesPerPixel;
+        }
+        s_state.valid = true;
+    }
+    return s_state;
+}
+
+float blend(float average, float sample) {
+    return average + config::uplink::SAMPLE_WEIGHT * (sample - average);
+}
+
+uint32_t framePixels(framesize_t frameSize) {
+    return static_cast<uint32_t>(resolution[frameSize].width) * resolution[frameSize].height;
+}
+
+} // namespace
+
+namespace network {
+
+uint32_t UplinkPlanner::expectedThroughput() {
+    const UplinkState& link = state();
+    if (link.throughputBps == 0) {
+        return config::uplink::DEFAULT_THROUGHPUT_BPS;
+    }
+
+    float throughput = static_cast<float>(link.throughputBps);
+    if (link.lastRssi != 0 && link.throughputRssi != 0.0f && link.lastRssi < link.throughputRssi) {
+        // Weaker signal than when measured: lower PHY rate, more retries
+        const float dropDb = link.throughputRssi - link.lastRssi;
+        throughput *= std::exp2(-dropDb / config::uplink::RSSI_HALVING_DB);
+    }
+    return std::max<uint32_t>(static_cast<uint32_t>(throughput), 1);
+}
+
+uint32_t UplinkPlanner::estimateUploadMs(size_t bytes) {
+    const uint64_t transferMs = static_cast<uint64_t>(bytes) * 1000 / expectedThroughput();
+    return config::uplink::REQUEST_OVERHEAD_MS + static_cast<uint32_t>(transferMs);
+}
+
+size_t UplinkPlanner::estimateBytes(size_t rung, uint32_t pixels) {
+    rung = std::min(rung, config::uplink::LADDER_SIZE - 1);
+    return static_cast<size_t>(pixels * state().bytesPerPixel[rung]);
+}
+
+AlertPlan UplinkPlanner::plan(float cropFraction) {
+    using config::uplink::LADDER;
+    using config::uplink::LADDER_SIZE;
+    const uint32_t budgetMs = config::uplink::FIRST_NOTIFICATION_BUDGET_MS;
+    const size_t burstFrames = config::camera::ALERT_BURST_FRAMES;
+
+    auto rungPlan = [](size_t rung, size_t frames, uint32_t estimatedMs) {
+        AlertPlan plan = {};
+        plan.rung = rung;
+        plan.frameSize = LADDER[rung].frameSize;
+        plan.jpegQuality = LADDER[rung].jpegQuality;
+        plan.frames = frames;
+        plan.estimatedMs = estimatedMs;
+        return plan;
+    };
+    auto photoMs = [](size_t rung) {
+        return estimateUploadMs(estimateBytes(rung, framePixels(LADDER[rung].frameSize)));
+    };
+
+    const size_t fullBytes = estimateBytes(0, framePixels(LADDER[0].frameSize));
+    const uint32_t burstMs = estimateUploadMs(fullBytes * burstFrames);
+    AlertPlan plan = rungPlan(0, burstFrames, burstMs);
+    const char* choice = "burst";
+
+    if (!config::uplink::ADAPTIVE || burstMs <= budgetMs) {
+        // Full-resolution album
+    } else if (photoMs(0) <= budgetMs) {
+        plan = rungPlan(0, 1, photoMs(0));
+        choice = "single";
+    } else {
+        bool planned = false;
+
+        // Full detail around the person beats a smaller whole frame
+        if (config::uplink::CROP_TO_DETECTION && cropFraction > 0.0f && cropFraction < 1.0f) {
+            const uint32_t cropMs = config::uplink::CROP_CPU_MS +
+                estimateUploadMs(static_cast<size_t>(fullBytes * cropFraction));
+            if (cropMs <= budgetMs) {
+                plan = rungPlan(0, 1, cropMs);
+                plan.crop = true;
+                choice = "crop";
+                planned = true;
+            }
+        }
+        for (size_t rung = 1; !planned && rung < LADDER_SIZE; rung++) {
+            if (photoMs(rung) <= budgetMs) {
+                plan = rungPlan(rung, 1, photoMs(rung));
+                choice = "reduced";
+                planned = true;
+            }
+        }
+
+        // Nothing arrives in time: the detection frame goes first, then the
+        // best photo the longer budget allows
+        if (!planned) {
+            size_t rung = 0;
+            while (rung + 1 < LADDER_SIZE &&
+                   photoMs(rung) > static_cast<uint32_t>(config::uplink::FULL_IMAGE_BUDGET_MS)) {
+                rung++;
+            }
+            plan = rungPlan(rung, 1, photoMs(rung));
+            plan.preview = true;
+            choice = "preview";
+        }
+    }
+
+    const UplinkState& link = state();
+    ESP_LOGI(TAG, "Alert plan: %s, %dx%d x%u, ~%lu ms (%lu B/s, RSSI %d dBm)", choice,
+             resolution[plan.frameSize].width, resolution[plan.frameSize].height,
+             static_cast<unsigned>(plan.frames), static_cast<unsigned long>(plan.estimatedMs),
+             static_cast<unsigned long>(expectedThroughput()), link.lastRssi);
+    return plan;
+}
+
+void UplinkPlanner::recordRssi(int8_t rssi) {
+    if (rssi != 0) {
+        state().lastRssi = rssi;
+    }
+}
+
+void UplinkPlanner::recordCapture(size_t rung, size_t bytes, uint32_t pixels) {
+    if (rung >= config::uplink::LADDER_SIZE || bytes == 0 || pixels == 0) {
+        return;
+    }
+    float& average = state().bytesPerPixel[rung];
+    average = blend(average, static_cast<float>(bytes) / pixels);
+}
+
+void UplinkPlanner::recordUpload(size_t bytes, int64_t elapsedUs) {
+    if (bytes == 0 || elapsedUs <= 0) {
+        return;
+    }
+    UplinkState& link = state();
+
+    // Transfer time net of the fixed per-request cost (never below a
+    // quarter of the total, for small payloads on a slow link)
+    const int64_t overheadUs = config::uplink::REQUEST_OVERHEAD_MS * 1000LL;
+    const int64_t transferUs = std::max(elapsedUs - overheadUs, elapsedUs / 4);
+    const float sample = static_cast<float>(bytes) * 1e6f / static_cast<float>(transferUs);
+
+    if (link.throughputBps == 0) {
+        link.throughputBps = static_cast<uint32_t>(sample);
+        link.throughputRssi = link.lastRssi;
+    } else {
+        link.throughputBps = static_cast<uint32_t>(blend(static_cast<float>(link.throughputBps),
+                                                         sample));
+        if (link.lastRssi != 0) {
+            link.throughputRssi = (link.throughputRssi != 0.0f)
+                ? blend(link.throughputRssi, link.lastRssi) : link.lastRssi;
+        }
+    }
+    ESP_LOGI(TAG, "Upload: %u bytes in %lld ms -> %lu B/s average",
+             static_cast<unsigned>(bytes), elapsedUs / 1000,
+             static_cast<unsigned long>(link.throughputBps));
+}
+
+} // namespace network
@@ -0,0 +1,104 @@
+#pragma once
+
+/**
+ * @file uplink_planner.hpp
+ * @brief Alert photo encoding chosen from the measured uplink
+ *
+ * Provides:
+ * - Upload throughput (bytes/s, net of REQUEST_OVERHEAD_MS) and the RSSI
+ *   it was measured at, averaged over earlier wakes in RTC memory
+ * - Learned JPEG bytes per pixel for each config::uplink::LADDER rung
+ * - A plan that keeps the first notification within
+ *   FIRST_NOTIFICATION_BUDGET_MS: the full-resolution burst, one photo,
+ *   a full-resolution crop around the detection, a smaller encoding, or
+ *   as a last resort the detection frame as a preview ahead of the photo
+ *
+ * The plan is made before WiFi is up (the alert photos are taken first),
+ * so it relies on the last wakes' link; with SPECULATIVE_WIFI the current
+ * RSSI is usually known already.
+ */
+
+#include "app_config.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace network {
+
+/**
+ * @brief How the alert photo(s) are encoded and sent
+ */
+struct AlertPlan {
+    size_t rung;                // Index into config::uplink::LADDER
+    framesize_t frameSize;      // Alert stream frame size
+    int jpegQuality;            // Alert stream JPEG quality
+    size_t frames;              // Photos to capture (>= 2 sends an album)
+    bool crop;                  // Send a full-resolution crop of the first photo
+    bool preview;               // Send the detection frame first
+    uint32_t estimatedMs;       // Expected upload time of the photo(s)
+};
+
+/**
+ * @brief Uplink estimator and alert planner (static, RTC resident)
+ *
+ * @code
+ *   UplinkPlanner::recordRssi(wifi.getRssi());             // After each connect
+ *   AlertPlan plan = UplinkPlanner::plan(cropFraction);    // Before the alert capture
+ *   camera.setAlertEncoding(plan.frameSize, plan.jpegQuality);
+ *   ...
+ *   UplinkPlanner::recordUpload(bytes, elapsedUs);         // After a successful send
+ * @endcode
+ */
+class UplinkPlanner {
+public:
+    /**
+     * @brief Plan the alert photos
+     *
+     * @param cropFraction Share of the alert frame's pixels the crop window
+     *                     around the best detection covers (0 = no crop)
+     */
+    static AlertPlan plan(float cropFraction);
+
+    /**
+     * @brief Record the signal strength of this wake's association
+     *
+     * @param rssi RSSI in dBm (0 = unknown, ignored)
+     */
+    static void recordRssi(int8_t rssi);
+
+    /**
+     * @brief Record the size of a captured alert photo
+     *
+     * @param rung   LADDER rung it was taken at
+     * @param bytes  JPEG length
+     * @param pixels Width x height
+     */
+    static void recordCapture(size_t rung, size_t bytes, uint32_t pixels);
+
+    /**
+     * @brief Record a successful upload
+     *
+     * @param bytes     Payload bytes sent (all photos of the request)
+     * @param elapsedUs Time from the start of the request to the reply
+     */
+    static void recordUpload(size_t bytes, int64_t elapsedUs);
+
+    /**
+     * @brief Expected throughput at the last RSSI (bytes/s)
+     */
+    static uint32_t expectedThroughput();
+
+    /**
+     * @brief Expected upload time of a payload (milliseconds)
+     */
+    static uint32_t estimateUploadMs(size_t bytes);
+
+    /**
+     * @brief Expected JPEG size of a photo at a LADDER rung
+     *
+     * @param rung   LADDER rung
+     * @param pixels Pixels encoded (the rung's frame, or a crop of it)
+     */
+    static size_t estimateBytes(size_t rung, uint32_t pixels);
+};
+
+} // namespace network
@@ -6,23 +6,40 @@
 #include "wifi_manager.hpp"
 #include "credentials.hpp"
 #include "app_config.hpp"
+#include "runtime_config.hpp"
 
 #include "esp_log.h"
 #include "esp_netif.h"
 #include "esp_event.h"
 #include "nvs_flash.h"
+#include "esp_attr.h"
 
 #include <cstring>
 
 static const char* TAG = "WiFiManager";
 
+// Last successful association (survives deep sleep)
+struct FastReconnectCache {
+    bool valid;
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t reuseCount;
+    esp_netif_ip_info_t ipInfo;
+    esp_ip4_addr_t dns;
+};
+RTC_DATA_ATTR static FastReconnectCache s_fastReconnect = {};
+
 namespace network {
 
 WifiManager::WifiManager()
     : m_eventGroup(nullptr)
+    , m_netif(nullptr)
     , m_wifiEventHandle(nullptr)
     , m_ipEventHandle(nullptr)
     , m_initialized(false)
+    , m_started(false)
+    , m_abortRequested(false)
+    , m_fastPath(false)
 {
 }
 
@@ -55,9 +72,17 @@ void WifiManager::eventHandler(void* arg, esp_event_base_t eventBase,
                 wifi_event_sta_disconnected_t* event = 
                     static_cast<wifi_event_sta_disconnected_t*>(eventData);
                 ESP_LOGW(TAG, "Disconnected, reason: %d", event->reason);
+                if (self->m_eventGroup) {
+                    xEventGroupClearBits(self->m_eventGroup, CONNECTED_BIT);
+                }
                 
-                // Attempt reconnection
-                esp_wifi_connect();
+                if (self->m_fastPath) {
+                    // Cached AP/lease no longer valid
+                    self->fallBackToFullScan();
+                } else {
+                    // Attempt reconnection
+                    esp_wifi_connect();
+                }
                 break;
             }
             
@@ -68,13 +93,21 @@ void WifiManager::eventHandler(void* arg, esp_event_base_t eventBase,
         ip_event_got_ip_t* event = static_cast<ip_event_got_ip_t*>(eventData);
         ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
         
+        if (config::network::FAST_RECONNECT) {
+            self->saveFastReconnect(event->ip_info);
+        }
+        
         if (self->m_eventGroup) {
             xEventGroupSetBits(self->m_eventGroup, CONNECTED_BIT);
         }
     }
 }
 
-esp_err_t WifiManager::connect() {
+esp_err_t WifiManager::init() {
+    if (m_initialized) {
+        return ESP_OK;
+    }
+    
     esp_err_t ret;
     
     // Initialize NVS
@@ -106,7 +139,7 @@ esp_err_t WifiManager::connect() {
     }
     
     // Create default WiFi station
-    esp_netif_create_default_wifi_sta();
+    m_netif = esp_netif_create_default_wifi_sta();
     
     // Initialize WiFi with default config
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
@@ -147,6 +180,11 @@ esp_err_t WifiManager::connect() {
                  sizeof(wifiConfig.sta.password) - 1);
     wifiConfig.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
     wifiConfig.sta.sae_pwe_h2e = WPA3_SAE_PWE_BOTH;
+    wifiConfig.sta.listen_interval = config::watch::WIFI_LISTEN_INTERVAL;
+    
+    if (config::network::FAST_RECONNECT) {
+        m_fastPath = applyFastReconnect(wifiConfig);
+    }
     
     ret = esp_wifi_set_mode(WIFI_MODE_STA);
     if (ret != ESP_OK) return ret;
@@ -154,33 +192,190 @@ esp_err_t WifiManager::connect() {
     ret = esp_wifi_set_config(WIFI_IF_STA, &wifiConfig);
     if (ret != ESP_OK) return ret;
     
+    m_initialized = true;
+    ESP_LOGI(TAG, "WiFi driver initialized");
+    
+    return ESP_OK;
+}
+
+esp_err_t WifiManager::connect() {
+    // Driver bring-up may already have run on a background job
+    esp_err_t ret = init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    if (m_abortRequested) {
+        ESP_LOGI(TAG, "Connect aborted before radio start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
     ret = esp_wifi_start();
     if (ret != ESP_OK) return ret;
     
-    m_initialized = true;
+    m_started = true;
+    
+    const int timeoutMs = config::RuntimeConfig::get(config::Setting::WIFI_TIMEOUT_MS);
+    ESP_LOGI(TAG, "Waiting for connection (timeout: %d ms)...", timeoutMs);
+    
+    int waitMs = timeoutMs;
+    EventBits_t bits = 0;
     
-    ESP_LOGI(TAG, "Waiting for connection (timeout: %d ms)...", 
-             config::timing::WIFI_TIMEOUT_MS);
+    // Directed connect gets a short window before scan + DHCP takes over
+    if (m_fastPath) {
+        bits = xEventGroupWaitBits(
+            m_eventGroup,
+            CONNECTED_BIT | FAIL_BIT,
+            pdFALSE,
+            pdFALSE,
+            pdMS_TO_TICKS(config::network::FAST_RECONNECT_TIMEOUT_MS)
+        );
+        waitMs -= config::network::FAST_RECONNECT_TIMEOUT_MS;
+        
+        if (!(bits & (CONNECTED_BIT | FAIL_BIT))) {
+            ESP_LOGW(TAG, "Fast reconnect timed out");
+            fallBackToFullScan();
+        }
+    }
     
     // Wait for connection
-    EventBits_t bits = xEventGroupWaitBits(
-        m_eventGroup,
-        CONNECTED_BIT | FAIL_BIT,
-        pdFALSE,
-        pdFALSE,
-        pdMS_TO_TICKS(config::timing::WIFI_TIMEOUT_MS)
-    );
+    if (!(bits & (CONNECTED_BIT | FAIL_BIT))) {
+        bits = xEventGroupWaitBits(
+            m_eventGroup,
+            CONNECTED_BIT | FAIL_BIT,
+            pdFALSE,
+            pdFALSE,
+            pdMS_TO_TICKS(waitMs)
+        );
+    }
     
     if (bits & CONNECTED_BIT) {
         ESP_LOGI(TAG, "Connected to %s", credentials::wifi::SSID);
         return ESP_OK;
+    } else if (bits & FAIL_BIT) {
+        ESP_LOGI(TAG, "Connect aborted");
+        return ESP_ERR_INVALID_STATE;
     } else {
         ESP_LOGE(TAG, "Connection timeout");
         return ESP_ERR_TIMEOUT;
     }
 }
 
+bool WifiManager::applyFastReconnect(wifi_config_t& wifiConfig) {
+    if (!s_fastReconnect.valid || !m_netif) {
+        return false;
+    }
+    
+    if (s_fastReconnect.reuseCount >= config::network::FAST_RECONNECT_MAX_REUSE) {
+        ESP_LOGI(TAG, "Cached lease reused %u times, refreshing via DHCP",
+                 s_fastReconnect.reuseCount);
+        s_fastReconnect.valid = false;
+        return false;
+    }
+    
+    // Directed connect: known BSSID on known channel, no full scan
+    wifiConfig.sta.bssid_set = true;
+    std::memcpy(wifiConfig.sta.bssid, s_fastReconnect.bssid, sizeof(wifiConfig.sta.bssid));
+    wifiConfig.sta.channel = s_fastReconnect.channel;
+    wifiConfig.sta.scan_method = WIFI_FAST_SCAN;
+    
+    // Static IP from the cached lease, skipping DHCP
+    esp_netif_dhcpc_stop(m_netif);
+    if (esp_netif_set_ip_info(m_netif, &s_fastReconnect.ipInfo) != ESP_OK) {
+        esp_netif_dhcpc_start(m_netif);
+        s_fastReconnect.valid = false;
+        return false;
+    }
+    
+    esp_netif_dns_info_t dnsInfo = {};
+    dnsInfo.ip.type = ESP_IPADDR_TYPE_V4;
+    dnsInfo.ip.u_addr.ip4 = s_fastReconnect.dns;
+    esp_netif_set_dns_info(m_netif, ESP_NETIF_DNS_MAIN, &dnsInfo);
+    
+    s_fastReconnect.reuseCount++;
+    
+    ESP_LOGI(TAG, "Fast reconnect: channel %u, static IP " IPSTR,
+             s_fastReconnect.channel, IP2STR(&s_fastReconnect.ipInfo.ip));
+    return true;
+}
+
+void WifiManager::fallBackToFullScan() {
+    // Only the first caller (event handler or connect timeout) falls back
+    bool expected = true;
+    if (!m_fastPath.compare_exchange_strong(expected, false)) {
+        return;
+    }
+    
+    ESP_LOGW(TAG, "Falling back to full scan + DHCP");
+    s_fastReconnect.valid = false;
+    
+    wifi_config_t wifiConfig = {};
+    esp_wifi_get_config(WIFI_IF_STA, &wifiConfig);
+    wifiConfig.sta.bssid_set = false;
+    wifiConfig.sta.channel = 0;
+    wifiConfig.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+    
+    esp_wifi_disconnect();
+    esp_wifi_set_config(WIFI_IF_STA, &wifiConfig);
+    
+    esp_netif_ip_info_t zero = {};
+    esp_netif_set_ip_info(m_netif, &zero);
+    esp_netif_dhcpc_start(m_netif);
+    
+    esp_wifi_connect();
+}
+
+void WifiManager::saveFastReconnect(const esp_netif_ip_info_t& ipInfo) {
+    wifi_ap_record_t ap = {};
+    if (esp_wifi_sta_get_ap_info(&ap) != ESP_OK) {
+        return;
+    }
+    
+    bool leaseReused = m_fastPath;
+    
+    std::memcpy(s_fastReconnect.bssid, ap.bssid, sizeof(s_fastReconnect.bssid));
+    s_fastReconnect.channel = ap.primary;
+    s_fastReconnect.ipInfo = ipInfo;
+    
+    esp_netif_dns_info_t dnsInfo = {};
+    if (esp_netif_get_dns_info(m_netif, ESP_NETIF_DNS_MAIN, &dnsInfo) == ESP_OK) {
+        s_fastReconnect.dns = dnsInfo.ip.u_addr.ip4;
+    }
+    
+    // Fresh DHCP lease restarts the reuse budget
+    if (!leaseReused) {
+        s_fastReconnect.reuseCount = 0;
+    }
+    s_fastReconnect.valid = true;
+}
+
+void WifiManager::abort() {
+    m_abortRequested = true;
+    
+    if (m_eventGroup) {
+        xEventGroupSetBits(m_eventGroup, FAIL_BIT);
+    }
+}
+
+esp_err_t WifiManager::setPowerSave(bool enable) {
+    if (!m_started) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    esp_err_t ret = esp_wifi_set_ps(enable ? WIFI_PS_MAX_MODEM : WIFI_PS_MIN_MODEM);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Power save change failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "Power save: %s", enable ? "DTIM (max modem)" : "min modem");
+    return ESP_OK;
+}
+
 void WifiManager::disconnect() {
+    // The request is over: an abort() only applies up to here, even one
+    // that came before init() or connect() ran
+    m_abortRequested = false;
+    
     if (!m_initialized) {
         return;
     }
@@ -201,9 +396,18 @@ void WifiManager::disconnect() {
     }
     
     // Stop and deinit WiFi
-    esp_wifi_stop();
+    if (m_started) {
+        esp_wifi_stop();
+        m_started = false;
+    }
     esp_wifi_deinit();
     
+    // The next init() creates a fresh default station interface
+    if (m_netif) {
+        esp_netif_destroy_default_wifi(m_netif);
+        m_netif = nullptr;
+    }
+    
     // Delete event group
     if (m_eventGroup) {
         vEventGroupDelete(m_eventGroup);
@@ -223,4 +427,12 @@ bool WifiManager::isConnected() const {
     return (bits & CONNECTED_BIT) != 0;
 }
 
+int8_t WifiManager::getRssi() const {
+    wifi_ap_record_t ap = {};
+    if (!m_started || esp_wifi_sta_get_ap_info(&ap) != ESP_OK) {
+        return 0;
+    }
+    return ap.rssi;
+}
+
 } // namespace network
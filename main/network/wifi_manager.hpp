@@ -5,8 +5,10 @@
  * @brief WiFi connection management for ESP32
  * 
  * Provides a clean interface for:
- * - Station mode initialization
+ * - Station mode initialization (separable from connect for early bring-up)
  * - Connection with timeout
+ * - Fast reconnect from RTC-cached BSSID/channel/IP lease
+ * - DTIM power save for staying associated in watch mode
  * - Graceful cleanup
  * 
  * @note Thread-safe through FreeRTOS event groups
@@ -14,8 +16,10 @@
 
 #include "esp_err.h"
 #include "esp_wifi.h"
+#include "esp_netif.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
+#include <atomic>
 
 namespace network {
 
@@ -48,7 +52,19 @@ public:
     WifiManager& operator=(const WifiManager&) = delete;
     
     /**
-     * @brief Initialize WiFi subsystem and connect to configured AP
+     * @brief Initialize NVS, netif, event loop and the WiFi driver
+     * 
+     * Does not start the radio. Can run on a background task ahead of
+     * connect(); does nothing if already initialized.
+     * 
+     * @return esp_err_t 
+     *         - ESP_OK on success
+     *         - Other ESP error codes on failure
+     */
+    esp_err_t init();
+    
+    /**
+     * @brief Initialize WiFi subsystem (if needed) and connect to configured AP
      * 
      * @return esp_err_t 
      *         - ESP_OK on successful connection
@@ -57,8 +73,33 @@ public:
      */
     esp_err_t connect();
     
+    /**
+     * @brief Abort a connect() in progress on another task
+     * 
+     * connect() returns ESP_ERR_INVALID_STATE as soon as possible, also
+     * when it has not started yet (init() does not clear the request).
+     * Call disconnect() after the connecting task has returned; it clears
+     * the request for the next connect().
+     */
+    void abort();
+    
+    /**
+     * @brief Switch between default modem sleep and DTIM power save
+     * 
+     * With power save on, the radio wakes only every WIFI_LISTEN_INTERVAL
+     * DTIM beacons, which keeps the association alive through automatic
+     * light sleep.
+     * 
+     * @param enable true for WIFI_PS_MAX_MODEM, false for WIFI_PS_MIN_MODEM
+     * @return esp_err_t ESP_OK, ESP_ERR_INVALID_STATE if the radio is off
+     */
+    esp_err_t setPowerSave(bool enable);
+    
     /**
      * @brief Disconnect and cleanup WiFi resources
+     * 
+     * connect() may be called again afterwards (a pending abort() is
+     * cleared).
      */
     void disconnect();
     
@@ -69,12 +110,23 @@ public:
      * @return false otherwise
      */
     bool isConnected() const;
+    
+    /**
+     * @brief Signal strength of the associated AP
+     * 
+     * @return int8_t RSSI in dBm, 0 if not associated
+     */
+    int8_t getRssi() const;
 
 private:
     EventGroupHandle_t m_eventGroup;
+    esp_netif_t* m_netif;
     esp_event_handler_instance_t m_wifiEventHandle;
     esp_event_handler_instance_t m_ipEventHandle;
-    bool m_initialized;
+    bool m_initialized;     // Driver initialized (init() done)
+    bool m_started;         // Radio started (esp_wifi_start() done)
+    std::atomic<bool> m_abortRequested;
+    std::atomic<bool> m_fastPath;   // Directed connect with static IP in use
     
     static constexpr int CONNECTED_BIT = BIT0;
     static constexpr int FAIL_BIT = BIT1;
@@ -89,6 +141,23 @@ private:
      * @brief Initialize NVS flash if needed
      */
     esp_err_t initNvs();
+    
+    /**
+     * @brief Apply cached BSSID/channel and static IP if available
+     * 
+     * @return true if the fast path is configured
+     */
+    bool applyFastReconnect(wifi_config_t& wifiConfig);
+    
+    /**
+     * @brief Drop the cache and reconnect with full scan + DHCP
+     */
+    void fallBackToFullScan();
+    
+    /**
+     * @brief Store current AP and IP lease in the RTC cache
+     */
+    void saveFastReconnect(const esp_netif_ip_info_t& ipInfo);
 };
 
 } // namespace network
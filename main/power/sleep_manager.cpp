@@ -4,22 +4,77 @@
  */
 
 #include "sleep_manager.hpp"
+#include "wake_stub.hpp"
 #include "board_config.hpp"
 #include "app_config.hpp"
+#include "runtime_config.hpp"
+#include "stage_profiler.hpp"
+#include "energy_meter.hpp"
 
 #include "esp_log.h"
+#include "esp_attr.h"
 #include "esp_timer.h"
+#include "driver/gpio.h"
+#include "driver/rtc_io.h"
+#include "soc/soc_caps.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <sys/time.h>
+
 static const char* TAG = "SleepManager";
 
 // RTC memory for persistent cooldown state (survives deep sleep)
 RTC_DATA_ATTR static int64_t s_nextPirAllowTime = 0;
 
+// RTC wake task queue: due time per task (0 = not scheduled); the
+// COOLDOWN_END slot is unused, s_nextPirAllowTime stands for it
+RTC_DATA_ATTR static int64_t s_taskDueTime[power::WAKE_TASK_COUNT] = {};
+
+// Consecutive failed runs per wake task (failure backoff)
+static constexpr uint8_t MAX_TASK_FAILURES = 16;
+RTC_DATA_ATTR static uint8_t s_taskFailures[power::WAKE_TASK_COUNT] = {};
+
+/**
+ * @brief What each wake task needs from its boot
+ */
+struct WakeTaskInfo {
+    const char* name;
+    bool wifi;
+    bool camera;
+};
+
+static constexpr WakeTaskInfo WAKE_TASK_INFO[power::WAKE_TASK_COUNT] = {
+    {"cooldown end", false, false},
+    {"outbox drain", true, false},
+    {"command poll", true, false},
+    {"health report", true, false},
+    {"model check", true, false},
+    {"crop photo", true, true},
+    {"soil sample", false, false},
+};
+
+// RTC ring of recent PIR trigger times (watch mode entry)
+static_assert(config::watch::ENTER_TRIGGERS >= 1, "Watch mode needs at least one trigger");
+RTC_DATA_ATTR static int64_t s_triggerTimes[config::watch::ENTER_TRIGGERS];
+RTC_DATA_ATTR static uint32_t s_triggerCount = 0;
+
+// RTC ring buffer of per-wake stage timings (survives deep sleep)
+RTC_DATA_ATTR static diagnostics::WakeRecord s_wakeHistory[config::profiling::HISTORY_DEPTH];
+RTC_DATA_ATTR static uint32_t s_wakeSequence = 0;
+
 namespace power {
 
-SleepManager::SleepManager() {
+SleepManager::SleepManager()
+    : m_wakeReason(WakeReason::UNKNOWN)
+    , m_watching(false)
+    , m_alerted(false)
+    , m_trigger(nullptr)
+    , m_noSleepLock(nullptr)
+    , m_cpuMaxLock(nullptr)
+{
     esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
     
     switch (cause) {
@@ -30,12 +85,26 @@ SleepManager::SleepManager() {
             m_wakeReason = WakeReason::PIR_TRIGGER;
             break;
         case ESP_SLEEP_WAKEUP_TIMER:
-            m_wakeReason = WakeReason::TIMER;
+            // The wake stub confirms PIR pulses at the end of a timer window
+            m_wakeReason = WakeStub::takeConfirmedTrigger()
+                ? WakeReason::PIR_TRIGGER : WakeReason::TIMER;
             break;
         default:
             m_wakeReason = WakeReason::UNKNOWN;
             break;
     }
+    
+    if (m_wakeReason == WakeReason::PIR_TRIGGER) {
+        noteTrigger();
+    }
+    
+    diagnostics::StageProfiler& profiler = diagnostics::StageProfiler::instance();
+    profiler.begin(++s_wakeSequence, static_cast<uint8_t>(m_wakeReason));
+    if (m_wakeReason != WakeReason::POWER_ON) {
+        const uint32_t absorbedWakes = WakeStub::takeAbsorbedWakes();
+        profiler.setBootInfo(WakeStub::takeBootTimeUs(), absorbedWakes);
+        diagnostics::EnergyMeter::endSleep(absorbedWakes);
+    }
 }
 
 WakeReason SleepManager::getWakeReason() const {
@@ -43,7 +112,11 @@ WakeReason SleepManager::getWakeReason() const {
 }
 
 int64_t SleepManager::getCurrentTimeSec() const {
-    return esp_timer_get_time() / 1000000;
+    // System time is kept by the RTC timer across deep sleep, unlike
+    // esp_timer which restarts from zero on every wake
+    struct timeval now = {};
+    gettimeofday(&now, nullptr);
+    return static_cast<int64_t>(now.tv_sec);
 }
 
 bool SleepManager::isInCooldown() const {
@@ -55,20 +128,421 @@ int64_t SleepManager::getCooldownRemaining() const {
     return (remaining > 0) ? remaining : 0;
 }
 
+size_t SleepManager::getWakeHistoryCount() const {
+    // Current wake is recorded only when entering deep sleep
+    uint32_t completed = s_wakeSequence - 1;
+    return (completed < config::profiling::HISTORY_DEPTH)
+        ? completed : config::profiling::HISTORY_DEPTH;
+}
+
+const diagnostics::WakeRecord* SleepManager::getWakeHistoryEntry(size_t age) const {
+    if (age >= getWakeHistoryCount()) {
+        return nullptr;
+    }
+    uint32_t sequence = s_wakeSequence - 1 - age;
+    return &s_wakeHistory[(sequence - 1) % config::profiling::HISTORY_DEPTH];
+}
+
+void SleepManager::dumpWakeHistory() const {
+    size_t count = getWakeHistoryCount();
+    ESP_LOGI(TAG, "Wake history (%zu records, newest first):", count);
+    
+    for (size_t age = 0; age < count; age++) {
+        diagnostics::StageProfiler::logRecord(*getWakeHistoryEntry(age));
+    }
+}
+
+void SleepManager::recordWake() {
+    const diagnostics::WakeRecord& record = diagnostics::StageProfiler::instance().finish();
+    s_wakeHistory[(record.sequence - 1) % config::profiling::HISTORY_DEPTH] = record;
+    diagnostics::EnergyMeter::recordActive(record, wakeClass());
+}
+
+diagnostics::WakeClass SleepManager::wakeClass() const {
+    switch (m_wakeReason) {
+        case WakeReason::POWER_ON:
+            return diagnostics::WakeClass::POWER_ON;
+        case WakeReason::PIR_TRIGGER:
+        case WakeReason::WATCH_TRIGGER:
+            return m_alerted ? diagnostics::WakeClass::PIR_TRUE : diagnostics::WakeClass::PIR_FALSE;
+        default:
+            return diagnostics::WakeClass::TIMER;
+    }
+}
+
 void SleepManager::startCooldown(int64_t seconds) {
     s_nextPirAllowTime = getCurrentTimeSec() + seconds;
+    m_alerted = true;
     ESP_LOGI(TAG, "Cooldown started: %lld seconds", seconds);
 }
 
+void SleepManager::clearCooldown() {
+    s_nextPirAllowTime = 0;
+}
+
+int64_t SleepManager::getCooldownDuration() const {
+    return config::RuntimeConfig::get(config::Setting::COOLDOWN_SECONDS);
+}
+
+bool SleepManager::isArmed() const {
+    return config::RuntimeConfig::getBool(config::Setting::ARMED);
+}
+
+/**
+ * @brief Shortest delay a wake task may be queued at
+ */
+static int64_t minimumTaskDelay(size_t slot) {
+    const uint8_t failures = s_taskFailures[slot];
+    if (failures == 0) {
+        return config::wake::MIN_TASK_DELAY_SECONDS;
+    }
+    const int64_t backoff = config::wake::FAILURE_BACKOFF_SECONDS << (failures - 1);
+    return std::max(std::min(backoff, config::wake::FAILURE_BACKOFF_MAX_SECONDS),
+                    config::wake::MIN_TASK_DELAY_SECONDS);
+}
+
+void SleepManager::scheduleTask(WakeTask task, int64_t seconds) {
+    if (task == WakeTask::COOLDOWN_END || task >= WakeTask::COUNT) {
+        return;
+    }
+    const size_t slot = static_cast<size_t>(task);
+    if (seconds < 0) {
+        s_taskDueTime[slot] = 0;
+        return;
+    }
+    s_taskDueTime[slot] = getCurrentTimeSec() + std::max(seconds, minimumTaskDelay(slot));
+}
+
+void SleepManager::recordUplinkResult(WakeTaskSet tasks, bool succeeded) {
+    for (size_t i = 0; i < WAKE_TASK_COUNT; i++) {
+        if (!(tasks & wakeTaskBit(static_cast<WakeTask>(i))) || !WAKE_TASK_INFO[i].wifi) {
+            continue;
+        }
+        if (succeeded) {
+            s_taskFailures[i] = 0;
+        } else if (s_taskFailures[i] < MAX_TASK_FAILURES) {
+            s_taskFailures[i]++;
+        }
+    }
+    if (!succeeded) {
+        ESP_LOGW(TAG, "Uplink failed; WiFi tasks back off");
+    }
+}
+
+void SleepManager::cancelTask(WakeTask task) {
+    scheduleTask(task, -1);
+}
+
+int64_t SleepManager::getTaskRemaining(WakeTask task) const {
+    if (task >= WakeTask::COUNT) {
+        return -1;
+    }
+    const int64_t due = (task == WakeTask::COOLDOWN_END)
+        ? s_nextPirAllowTime : s_taskDueTime[static_cast<size_t>(task)];
+    if (due == 0) {
+        return -1;
+    }
+    int64_t remaining = due - getCurrentTimeSec();
+    return (remaining > 0) ? remaining : 0;
+}
+
+WakeTask SleepManager::nextQueuedTask(int64_t& remaining) const {
+    WakeTask next = WakeTask::COUNT;
+    remaining = -1;
+    // Earliest due first; ties go to the lower slot
+    for (size_t i = 0; i < WAKE_TASK_COUNT; i++) {
+        const WakeTask task = static_cast<WakeTask>(i);
+        if (task == WakeTask::COOLDOWN_END) {
+            continue;
+        }
+        const int64_t taskRemaining = getTaskRemaining(task);
+        if (taskRemaining >= 0 && (remaining < 0 || taskRemaining < remaining)) {
+            next = task;
+            remaining = taskRemaining;
+        }
+    }
+    return next;
+}
+
+int64_t SleepManager::getNextBootRemaining() const {
+    int64_t remaining = -1;
+    nextQueuedTask(remaining);
+    if (isArmed() && isInCooldown() && !WakeStub::isEnabled()) {
+        // The cooldown end boots anyway: tasks due shortly before wait for it
+        const int64_t cooldown = getCooldownRemaining();
+        if (remaining < 0 || cooldown <= remaining + config::wake::COALESCE_WINDOW_SECONDS) {
+            remaining = cooldown;
+        }
+    }
+    return remaining;
+}
+
+WakeTaskSet SleepManager::takeDueTasks() {
+    const int64_t horizon = getCurrentTimeSec() + config::wake::COALESCE_WINDOW_SECONDS;
+    WakeTaskSet due = 0;
+    for (size_t i = 0; i < WAKE_TASK_COUNT; i++) {
+        if (s_taskDueTime[i] != 0 && s_taskDueTime[i] <= horizon) {
+            due |= wakeTaskBit(static_cast<WakeTask>(i));
+            s_taskDueTime[i] = 0;
+        }
+    }
+    
+    // A running cooldown is kept; getNextBootRemaining() lines the tasks
+    // up with its end instead
+    if (s_nextPirAllowTime != 0 && !isInCooldown()) {
+        due |= wakeTaskBit(WakeTask::COOLDOWN_END);
+        clearCooldown();
+    }
+    
+    char names[160];
+    size_t len = 0;
+    names[0] = '\0';
+    for (size_t i = 0; i < WAKE_TASK_COUNT; i++) {
+        if ((due & wakeTaskBit(static_cast<WakeTask>(i))) && len < sizeof(names)) {
+            int n = snprintf(names + len, sizeof(names) - len, "%s%s",
+                             (len > 0) ? ", " : "", WAKE_TASK_INFO[i].name);
+            if (n > 0) {
+                len += static_cast<size_t>(n);
+            }
+        }
+    }
+    ESP_LOGI(TAG, "Due wake tasks: %s", (due != 0) ? names : "none");
+    return due;
+}
+
+bool SleepManager::needsWifi(WakeTaskSet tasks) {
+    for (size_t i = 0; i < WAKE_TASK_COUNT; i++) {
+        if ((tasks & wakeTaskBit(static_cast<WakeTask>(i))) && WAKE_TASK_INFO[i].wifi) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SleepManager::needsCamera(WakeTaskSet tasks) {
+    for (size_t i = 0; i < WAKE_TASK_COUNT; i++) {
+        if ((tasks & wakeTaskBit(static_cast<WakeTask>(i))) && WAKE_TASK_INFO[i].camera) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SleepManager::noteTrigger() {
+    s_triggerTimes[s_triggerCount % config::watch::ENTER_TRIGGERS] = getCurrentTimeSec();
+    s_triggerCount++;
+}
+
+bool SleepManager::shouldWatch() const {
+    if (!config::watch::ENABLED || s_triggerCount < config::watch::ENTER_TRIGGERS) {
+        return false;
+    }
+    // Oldest of the last ENTER_TRIGGERS triggers sits in the next write slot
+    int64_t oldest = s_triggerTimes[s_triggerCount % config::watch::ENTER_TRIGGERS];
+    return getCurrentTimeSec() - oldest <= config::watch::ENTER_WINDOW_SECONDS;
+}
+
+void IRAM_ATTR SleepManager::pirIsr(void* arg) {
+    SleepManager* self = static_cast<SleepManager*>(arg);
+    
+    // Level interrupt: masked until the next waitForTrigger()
+    gpio_intr_disable(config::pir::PIN);
+    
+    BaseType_t higherPriorityWoken = pdFALSE;
+    xSemaphoreGiveFromISR(self->m_trigger, &higherPriorityWoken);
+    portYIELD_FROM_ISR(higherPriorityWoken);
+}
+
+esp_err_t SleepManager::beginWatch() {
+    if (m_watching) {
+        return ESP_OK;
+    }
+    
+#if !CONFIG_PM_ENABLE || !CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    ESP_LOGW(TAG, "Watch mode needs CONFIG_PM_ENABLE and CONFIG_FREERTOS_USE_TICKLESS_IDLE");
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    const gpio_num_t pin = config::pir::PIN;
+    
+    if (!m_trigger) {
+        m_trigger = xSemaphoreCreateBinary();
+        if (!m_trigger) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    
+    // From here on endWatch() undoes whatever was set up
+    m_watching = true;
+    
+    // Stay awake at full speed until the caller starts waiting
+    esp_err_t err = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "watch", &m_noSleepLock);
+    if (err == ESP_OK) {
+        esp_pm_lock_acquire(m_noSleepLock);
+        err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "watch_cpu", &m_cpuMaxLock);
+    }
+    if (err == ESP_OK) {
+        esp_pm_lock_acquire(m_cpuMaxLock);
+        
+#if SOC_RTCIO_INPUT_OUTPUT_SUPPORTED
+        // EXT1 wake-up left the pin routed to RTC IO
+        if (rtc_gpio_is_valid_gpio(pin)) {
+            rtc_gpio_deinit(pin);
+        }
+#endif
+        gpio_config_t io = {};
+        io.pin_bit_mask = 1ULL << pin;
+        io.mode = GPIO_MODE_INPUT;
+        io.intr_type = GPIO_INTR_DISABLE;
+        err = gpio_config(&io);
+    }
+    if (err == ESP_OK) {
+        // The camera driver may have installed the service already
+        err = gpio_install_isr_service(0);
+        if (err == ESP_ERR_INVALID_STATE) {
+            err = ESP_OK;
+        }
+    }
+    if (err == ESP_OK) {
+        err = gpio_isr_handler_add(pin, &SleepManager::pirIsr, this);
+    }
+    if (err == ESP_OK) {
+        // Also sets the high-level interrupt type; unmasked while waiting
+        err = gpio_wakeup_enable(pin, GPIO_INTR_HIGH_LEVEL);
+        gpio_intr_disable(pin);
+    }
+    if (err == ESP_OK) {
+        err = esp_sleep_enable_gpio_wakeup();
+    }
+    if (err == ESP_OK) {
+        esp_pm_config_t pmConfig = {};
+        pmConfig.max_freq_mhz = config::watch::MAX_CPU_FREQ_MHZ;
+        pmConfig.min_freq_mhz = config::watch::MIN_CPU_FREQ_MHZ;
+        pmConfig.light_sleep_enable = true;
+        err = esp_pm_configure(&pmConfig);
+    }
+    
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Watch mode setup failed: %s", esp_err_to_name(err));
+        endWatch();
+        return err;
+    }
+    
+    ESP_LOGI(TAG, "Watch mode: light sleep with PIR GPIO wake");
+    return ESP_OK;
+#endif
+}
+
+bool SleepManager::waitForTrigger(int64_t timeoutMs) {
+    if (!m_watching) {
+        return false;
+    }
+    
+    const gpio_num_t pin = config::pir::PIN;
+    const int64_t deadlineUs = esp_timer_get_time() + timeoutMs * 1000;
+    
+    recordWake();
+    diagnostics::EnergyMeter::beginSleep(diagnostics::SleepKind::WATCH);
+    esp_pm_lock_release(m_cpuMaxLock);
+    esp_pm_lock_release(m_noSleepLock);
+    
+    // Output still high from the last trigger is the same motion
+    while (gpio_get_level(pin) && esp_timer_get_time() < deadlineUs) {
+        vTaskDelay(pdMS_TO_TICKS(config::watch::PIR_RELEASE_POLL_MS));
+    }
+    
+    bool triggered = false;
+    int64_t remainingUs = deadlineUs - esp_timer_get_time();
+    if (remainingUs > 0) {
+        xSemaphoreTake(m_trigger, 0);
+        gpio_intr_enable(pin);
+        triggered = xSemaphoreTake(m_trigger, pdMS_TO_TICKS(remainingUs / 1000)) == pdTRUE;
+        gpio_intr_disable(pin);
+    }
+    
+    esp_pm_lock_acquire(m_noSleepLock);
+    esp_pm_lock_acquire(m_cpuMaxLock);
+    diagnostics::EnergyMeter::endSleep(0);
+    
+    m_alerted = false;
+    m_wakeReason = triggered ? WakeReason::WATCH_TRIGGER : WakeReason::TIMER;
+    if (triggered) {
+        noteTrigger();
+    }
+    diagnostics::StageProfiler::instance().begin(
+        ++s_wakeSequence, static_cast<uint8_t>(m_wakeReason));
+    return triggered;
+}
+
+void SleepManager::endWatch() {
+    if (!m_watching) {
+        return;
+    }
+    
+#if CONFIG_PM_ENABLE
+    const gpio_num_t pin = config::pir::PIN;
+    
+    esp_pm_config_t pmConfig = {};
+    pmConfig.max_freq_mhz = config::watch::MAX_CPU_FREQ_MHZ;
+    pmConfig.min_freq_mhz = config::watch::MAX_CPU_FREQ_MHZ;
+    pmConfig.light_sleep_enable = false;
+    esp_pm_configure(&pmConfig);
+    
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+    gpio_wakeup_disable(pin);
+    gpio_isr_handler_remove(pin);
+    
+    if (m_cpuMaxLock) {
+        esp_pm_lock_release(m_cpuMaxLock);
+        esp_pm_lock_delete(m_cpuMaxLock);
+        m_cpuMaxLock = nullptr;
+    }
+    if (m_noSleepLock) {
+        esp_pm_lock_release(m_noSleepLock);
+        esp_pm_lock_delete(m_noSleepLock);
+        m_noSleepLock = nullptr;
+    }
+#endif
+    
+    m_watching = false;
+    ESP_LOGI(TAG, "Watch mode ended");
+}
+
 [[noreturn]] void SleepManager::enterDeepSleep() {
-    int64_t sleepDuration = -1;
+    endWatch();
+    
+    int64_t taskRemaining = -1;
+    const WakeTask nextTask = nextQueuedTask(taskRemaining);
+    const bool wakeStub = WakeStub::isEnabled();
+    if (taskRemaining >= 0) {
+        ESP_LOGI(TAG, "Next wake task: %s in %lld seconds",
+                 WAKE_TASK_INFO[static_cast<size_t>(nextTask)].name, taskRemaining);
+    }
     
-    if (isInCooldown()) {
-        sleepDuration = getCooldownRemaining();
+    if (!isArmed()) {
+        ESP_LOGI(TAG, "System disarmed. PIR wake-up off");
+        
+        if (taskRemaining >= 0) {
+            esp_sleep_enable_timer_wakeup(taskRemaining * 1000000ULL);
+        }
+    } else if (isInCooldown()) {
+        int64_t sleepDuration = getCooldownRemaining();
         ESP_LOGW(TAG, "In cooldown. PIR disabled for %lld seconds", sleepDuration);
         
-        // Set timer wake-up
+        // Timer wake-up at cooldown end, or earlier for the next task. The
+        // stub re-arms at the cooldown end itself; without it, tasks due
+        // just before the end wait for that boot.
+        if (!wakeStub) {
+            sleepDuration = getNextBootRemaining();
+        } else if (taskRemaining >= 0 && taskRemaining < sleepDuration) {
+            sleepDuration = taskRemaining;
+        }
         esp_sleep_enable_timer_wakeup(sleepDuration * 1000000ULL);
+        
+        if (wakeStub) {
+            // The stub drops PIR wakes until the cooldown ends and re-arms
+            // at its timer wake without booting
+            esp_sleep_enable_ext1_wakeup(1ULL << config::pir::PIN, ESP_EXT1_WAKEUP_ANY_HIGH);
+        }
     } else {
         ESP_LOGI(TAG, "System armed. Enabling PIR wake-up");
         
@@ -77,12 +551,33 @@ void SleepManager::startCooldown(int64_t seconds) {
             1ULL << config::pir::PIN,
             ESP_EXT1_WAKEUP_ANY_HIGH
         );
+        
+        if (taskRemaining >= 0) {
+            esp_sleep_enable_timer_wakeup(taskRemaining * 1000000ULL);
+        } else if (wakeStub && config::wake_stub::PIR_MIN_PULSE_MS > 0) {
+            // The pulse filter ends a PIR pulse on a timer the stub sets
+            esp_sleep_enable_timer_wakeup(WakeStub::NO_TIMER_US);
+        }
+    }
+    
+    if (wakeStub) {
+        WakeStub::install(isArmed() ? getCooldownRemaining() * 1000000LL : 0,
+                          (taskRemaining >= 0) ? taskRemaining * 1000000LL : -1);
     }
     
     ESP_LOGI(TAG, "Entering deep sleep...");
     
-    // Give logs time to flush
-    vTaskDelay(pdMS_TO_TICKS(100));
+    recordWake();
+    // PIR wake armed unless a cooldown runs without the stub filtering it
+    const bool pirArmed = isArmed() && (!isInCooldown() || wakeStub);
+    diagnostics::EnergyMeter::beginSleep(pirArmed ? diagnostics::SleepKind::ARMED
+                                                  : diagnostics::SleepKind::COOLDOWN);
+    
+    // Verbose builds: let the console drain. Buffered logging leaves
+    // nothing queued, and deep sleep entry waits for the UART FIFO anyway.
+    if (config::debug::VERBOSE_LOGGING) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
     
     esp_deep_sleep_start();
     
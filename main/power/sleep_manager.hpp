@@ -7,11 +7,23 @@
  * Handles:
  * - PIR sensor wake-up configuration
  * - Timer-based wake-up for cooldown
+ * - Wake task queue: one timer wake for the nearest due task, with tasks
+ *   due close together batched into the same boot
+ * - Watch mode: automatic light sleep with PIR GPIO wake at busy sites
+ * - RTC wake stub for cooldown wakes that need no firmware
  * - RTC memory for persistent state
+ * - Per-wake stage timing history (RTC ring buffer)
+ * - Wake and sleep energy accounting (diagnostics::EnergyMeter)
  */
 
 #include "esp_sleep.h"
+#include "esp_pm.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "stage_profiler.hpp"
+#include "energy_meter.hpp"
 #include <cstdint>
+#include <cstddef>
 
 namespace power {
 
@@ -22,9 +34,35 @@ enum class WakeReason {
     POWER_ON,           // Initial power on
     PIR_TRIGGER,        // EXT1 wake-up from PIR
     TIMER,              // Timer wake-up (cooldown ended)
+    WATCH_TRIGGER,      // GPIO wake-up from watch-mode light sleep
     UNKNOWN             // Other/undefined
 };
 
+/**
+ * @brief Work that needs a timer wake (one queue slot each)
+ */
+enum class WakeTask : uint8_t {
+    COOLDOWN_END,       // PIR re-armed (boots only without the wake stub)
+    OUTBOX_DRAIN,       // Deliver queued alerts (WiFi, SD card)
+    COMMAND_POLL,       // Fetch Telegram bot commands (WiFi)
+    HEALTH_REPORT,      // Energy report (WiFi)
+    MODEL_CHECK,        // Model update check (WiFi)
+    CROP_PHOTO,         // Scheduled crop photo (camera, WiFi)
+    SOIL_SAMPLE,        // Soil-moisture reading (ADC)
+    COUNT
+};
+
+constexpr size_t WAKE_TASK_COUNT = static_cast<size_t>(WakeTask::COUNT);
+
+/**
+ * @brief Set of wake tasks (bit n = WakeTask n)
+ */
+using WakeTaskSet = uint32_t;
+
+constexpr WakeTaskSet wakeTaskBit(WakeTask task) {
+    return WakeTaskSet(1) << static_cast<unsigned>(task);
+}
+
 /**
  * @brief Sleep manager class
  */
@@ -33,6 +71,10 @@ public:
     SleepManager();
     ~SleepManager() = default;
     
+    // Disable copy operations
+    SleepManager(const SleepManager&) = delete;
+    SleepManager& operator=(const SleepManager&) = delete;
+    
     /**
      * @brief Get the reason for wake-up
      */
@@ -55,29 +97,226 @@ public:
     /**
      * @brief Start cooldown period
      * 
+     * Also marks the current wake as an alert for energy accounting.
+     * 
      * @param seconds Duration of cooldown in seconds
      */
     void startCooldown(int64_t seconds);
     
+    /**
+     * @brief End a running cooldown (PIR accepted again)
+     */
+    void clearCooldown();
+    
+    /**
+     * @brief Get the cooldown used after an alert in seconds
+     *        (runtime setting "cooldown_s")
+     */
+    int64_t getCooldownDuration() const;
+    
+    /**
+     * @brief Check whether the PIR wake-up is enabled (runtime setting "armed")
+     * 
+     * Disarmed, deep sleep keeps only the timer wake-ups (maintenance,
+     * command polls).
+     */
+    bool isArmed() const;
+    
+    /**
+     * @brief Schedule a wake task, replacing its earlier due time
+     * 
+     * The queue lives in RTC memory; deep sleep sets one timer wake for
+     * the nearest task. The delay is raised to at least
+     * config::wake::MIN_TASK_DELAY_SECONDS, or to the task's failure
+     * backoff (recordUplinkResult()). COOLDOWN_END follows startCooldown()
+     * and clearCooldown() and is not scheduled here.
+     * 
+     * @param task    Task to schedule
+     * @param seconds Delay from now in seconds (negative = cancel)
+     */
+    void scheduleTask(WakeTask task, int64_t seconds);
+    
+    /**
+     * @brief Record whether this boot's uplink served its WiFi tasks
+     * 
+     * A failure backs each WiFi task in the set off (FAILURE_BACKOFF_SECONDS,
+     * doubling up to FAILURE_BACKOFF_MAX_SECONDS) at its next scheduleTask();
+     * a success resets the backoff. Tasks without WiFi are not affected.
+     * 
+     * @param tasks     Tasks this boot ran
+     * @param succeeded false if WiFi or the upload failed
+     */
+    void recordUplinkResult(WakeTaskSet tasks, bool succeeded);
+    
+    /**
+     * @brief Remove a wake task from the queue
+     */
+    void cancelTask(WakeTask task);
+    
+    /**
+     * @brief Get seconds until a wake task is due
+     * 
+     * @return Seconds remaining (0 if due), or -1 if not scheduled
+     */
+    int64_t getTaskRemaining(WakeTask task) const;
+    
+    /**
+     * @brief Get seconds until the next timer wake that needs a boot
+     * 
+     * The nearest queued task; the cooldown end only counts when armed
+     * without the wake stub (the stub re-arms the PIR without booting).
+     * Tasks due within COALESCE_WINDOW_SECONDS before that cooldown end
+     * wait for its boot.
+     * 
+     * @return Seconds remaining (0 if due), or -1 if none
+     */
+    int64_t getNextBootRemaining() const;
+    
+    /**
+     * @brief Take the tasks this boot should run
+     * 
+     * Every task due within config::wake::COALESCE_WINDOW_SECONDS is
+     * removed from the queue and returned, so tasks due close together
+     * share one boot (and one WiFi session or camera init). COOLDOWN_END
+     * is included once the cooldown has run out; a running cooldown is
+     * left alone. Run each returned task, then schedule its next occurrence.
+     * 
+     * @return Set of due tasks
+     */
+    WakeTaskSet takeDueTasks();
+    
+    /**
+     * @brief Check whether any task in a set uploads over WiFi
+     */
+    static bool needsWifi(WakeTaskSet tasks);
+    
+    /**
+     * @brief Check whether any task in a set takes a photo
+     */
+    static bool needsCamera(WakeTaskSet tasks);
+    
+    /**
+     * @brief Check whether recent PIR traffic calls for watch mode
+     * 
+     * True once config::watch::ENTER_TRIGGERS triggers (kept in RTC
+     * memory across deep sleep) fall within ENTER_WINDOW_SECONDS.
+     */
+    bool shouldWatch() const;
+    
+    /**
+     * @brief Enter watch mode: automatic light sleep with PIR GPIO wake
+     * 
+     * Enables DFS with light sleep, moves the PIR pin from RTC IO to a
+     * GPIO level interrupt and holds a no-sleep lock while the caller
+     * works. enterDeepSleep() leaves watch mode itself.
+     * 
+     * @return esp_err_t
+     *         - ESP_OK on success
+     *         - ESP_ERR_NOT_SUPPORTED without CONFIG_PM_ENABLE and
+     *           CONFIG_FREERTOS_USE_TICKLESS_IDLE
+     *         - Other ESP error codes on failure
+     */
+    esp_err_t beginWatch();
+    
+    /**
+     * @brief Light-sleep until the next PIR trigger
+     * 
+     * Waits for the PIR output to drop after the last trigger, then blocks
+     * with the locks released so the idle task light-sleeps. The finished
+     * cycle goes to the wake history first; a new record begins on return.
+     * 
+     * @param timeoutMs Longest wait in milliseconds
+     * @return true on a PIR trigger, false on timeout
+     */
+    bool waitForTrigger(int64_t timeoutMs);
+    
+    /**
+     * @brief Leave watch mode (no-op if not watching)
+     */
+    void endWatch();
+    
+    /**
+     * @brief Check if watch mode is active
+     */
+    bool isWatching() const { return m_watching; }
+    
     /**
      * @brief Enter deep sleep with appropriate wake sources
      * 
-     * If in cooldown: Sets timer wake-up
+     * If disarmed: No PIR wake-up
+     * If in cooldown: Sets timer wake-up (plus the PIR wake-up, filtered by
+     * the wake stub, when config::wake_stub::ENABLED); without the stub,
+     * tasks due shortly before the cooldown end wait for it
      * If not: Sets PIR (EXT1) wake-up
+     * Either way, the nearest queued wake task adds an earlier timer wake-up
      * 
      * @note This function does not return
      */
     [[noreturn]] void enterDeepSleep();
     
     /**
-     * @brief Get current time in seconds since boot
+     * @brief Get current RTC system time in seconds
+     * 
+     * Keeps counting through deep sleep (seconds since first power-on
+     * unless the clock has been set).
      * 
      * @return Current time in seconds
      */
     int64_t getCurrentTimeSec() const;
+    
+    /**
+     * @brief Get number of completed wake records in RTC history
+     */
+    size_t getWakeHistoryCount() const;
+    
+    /**
+     * @brief Get a wake record from RTC history
+     * 
+     * @param age 0 = previous wake, 1 = the one before, ...
+     * @return const diagnostics::WakeRecord* Record, or nullptr if not available
+     */
+    const diagnostics::WakeRecord* getWakeHistoryEntry(size_t age) const;
+    
+    /**
+     * @brief Log all wake records in RTC history to serial
+     */
+    void dumpWakeHistory() const;
 
 private:
     WakeReason m_wakeReason;
+    bool m_watching;
+    bool m_alerted;                         // Current wake started a cooldown
+    SemaphoreHandle_t m_trigger;            // Given by the PIR interrupt
+    esp_pm_lock_handle_t m_noSleepLock;     // Held outside waitForTrigger()
+    esp_pm_lock_handle_t m_cpuMaxLock;      // Full speed for inference
+    
+    /**
+     * @brief Nearest queued task other than the cooldown end
+     * 
+     * @param remaining Seconds until it is due, or -1 if the queue is empty
+     * @return WakeTask The task, or WakeTask::COUNT if none
+     */
+    WakeTask nextQueuedTask(int64_t& remaining) const;
+    
+    /**
+     * @brief Append a PIR trigger to the RTC trigger history
+     */
+    void noteTrigger();
+    
+    /**
+     * @brief PIR level interrupt: mask itself and wake the waiting task
+     */
+    static void pirIsr(void* arg);
+    
+    /**
+     * @brief Store the current wake's profile in the RTC ring buffer
+     */
+    void recordWake();
+    
+    /**
+     * @brief Energy-accounting class of the current wake
+     */
+    diagnostics::WakeClass wakeClass() const;
 };
 
 } // namespace power
@@ -0,0 +1,247 @@
+/**
+ * @file wake_stub.cpp
+ * @brief Deep-sleep wake stub implementation
+ *
+ * Everything the stub touches lives in RTC memory: it runs before the
+ * flash cache is enabled, so it may only call RTC_IRAM_ATTR code and the
+ * FORCE_INLINE_ATTR register helpers.
+ */
+
+#include "wake_stub.hpp"
+#include "app_config.hpp"
+
+#include "esp_attr.h"
+#include "esp_sleep.h"
+#include "sdkconfig.h"
+
+#if CONFIG_IDF_TARGET_ESP32S3
+#define WAKE_STUB_SUPPORTED 1
+#include "esp_wake_stub.h"
+#include "esp_private/esp_clk.h"
+#include "soc/rtc.h"
+#include "soc/rtc_cntl_reg.h"
+#include "hal/rtc_cntl_ll.h"
+#else
+#define WAKE_STUB_SUPPORTED 0
+#endif
+
+namespace power {
+
+#if WAKE_STUB_SUPPORTED
+
+namespace {
+
+/**
+ * @brief What the EXT1 (PIR) wake is currently set up to catch
+ */
+enum class PirWait : uint8_t {
+    RISE,           // High level: next trigger
+    RELEASE,        // Low level: ignored trigger, wait for the output to drop
+    PULSE,          // Low level plus timer: trigger must outlast the minimum pulse
+};
+
+/**
+ * @brief Decisions precomputed by the firmware before deep sleep
+ */
+struct StubPlan {
+    bool pirBlocked;                // Cooldown: PIR wakes go back to sleep
+    PirWait pirWait;
+    bool confirmedTrigger;          // Booting on a PIR pulse confirmed by the filter
+    uint64_t cooldownEndTicks;      // RTC tick the cooldown ends
+    uint64_t bootTimerTicks;        // RTC tick of a maintenance wake (0 = none)
+    uint64_t pulseEndTicks;         // RTC tick a PULSE wait confirms the trigger
+    uint64_t lastShortPulseTicks;   // RTC tick the last rejected pulse ended (0 = none)
+    uint64_t minPulseTicks;         // config::wake_stub::PIR_MIN_PULSE_MS
+    uint64_t pairWindowTicks;       // config::wake_stub::PIR_PULSE_PAIR_WINDOW_MS
+    uint64_t entryTicks;            // RTC tick of the wake that booted (0 = none)
+    uint32_t absorbed;              // Wakes sent back to sleep since the last boot
+};
+
+// Timer target when nothing is scheduled (~90 days of slow clock)
+constexpr uint64_t NO_TIMER_TICKS = 1ULL << 40;
+
+// Shortest timer the stub sets, so an overdue target still lies ahead
+constexpr uint64_t MIN_TIMER_TICKS = 256;       // ~2 ms of slow clock
+
+} // namespace
+
+RTC_DATA_ATTR static StubPlan s_plan = {};
+
+static void RTC_IRAM_ATTR setPirWakeLevel(bool high) {
+    // Single pin: "any high" / "all low" is just its level
+    if (high) {
+        REG_SET_BIT(RTC_CNTL_EXT_WAKEUP_CONF_REG, RTC_CNTL_EXT_WAKEUP1_LV);
+    } else {
+        REG_CLR_BIT(RTC_CNTL_EXT_WAKEUP_CONF_REG, RTC_CNTL_EXT_WAKEUP1_LV);
+    }
+    REG_SET_BIT(RTC_CNTL_EXT_WAKEUP1_REG, RTC_CNTL_EXT_WAKEUP1_STATUS_CLR);
+}
+
+/**
+ * @brief PIR output went high: decide whether this trigger boots
+ */
+static bool RTC_IRAM_ATTR onPirRise(uint64_t now) {
+    if (s_plan.pirBlocked) {
+        // Trigger during cooldown: sleep until the output drops
+        s_plan.pirWait = PirWait::RELEASE;
+        setPirWakeLevel(false);
+        return false;
+    }
+    if (s_plan.minPulseTicks == 0 ||
+        (s_plan.lastShortPulseTicks != 0 &&
+         now - s_plan.lastShortPulseTicks <= s_plan.pairWindowTicks)) {
+        // Filter off, or the second pulse of a pair
+        s_plan.lastShortPulseTicks = 0;
+        return true;
+    }
+    // Boot only if the output is still high after the minimum pulse
+    s_plan.pirWait = PirWait::PULSE;
+    s_plan.pulseEndTicks = now + s_plan.minPulseTicks;
+    setPirWakeLevel(false);
+    return false;
+}
+
+static void RTC_IRAM_ATTR sentinelWakeStub() {
+    const uint64_t now = rtc_cntl_ll_get_rtc_time();
+    const uint32_t cause = esp_wake_stub_get_wakeup_cause();
+    bool boot = false;
+
+    if (cause & RTC_TIMER_TRIG_EN) {
+        if (s_plan.pirBlocked && now >= s_plan.cooldownEndTicks) {
+            // Cooldown over: the PIR wake is already armed
+            s_plan.pirBlocked = false;
+        }
+        if (s_plan.pirWait == PirWait::PULSE) {
+            // A maintenance wake due during the pulse waits for its outcome:
+            // booting now would drop the trigger being filtered
+            if (now >= s_plan.pulseEndTicks) {
+                // Output stayed high for the whole minimum pulse
+                s_plan.pirWait = PirWait::RISE;
+                s_plan.lastShortPulseTicks = 0;
+                s_plan.confirmedTrigger = true;
+                setPirWakeLevel(true);
+                boot = true;
+            }
+        } else {
+            boot = s_plan.bootTimerTicks != 0 && now >= s_plan.bootTimerTicks;
+        }
+    } else if (cause & RTC_EXT1_TRIG_EN) {
+        switch (s_plan.pirWait) {
+            case PirWait::PULSE:
+                // Dropped before the minimum pulse: noise unless another follows
+                s_plan.lastShortPulseTicks = now;
+                s_plan.pirWait = PirWait::RISE;
+                setPirWakeLevel(true);
+                break;
+            case PirWait::RELEASE:
+                // Output dropped: wake on the next rising level again
+                s_plan.pirWait = PirWait::RISE;
+                setPirWakeLevel(true);
+                break;
+            case PirWait::RISE:
+            default:
+                boot = onPirRise(now);
+                break;
+        }
+    } else {
+        boot = true;
+    }
+
+    if (boot) {
+        s_plan.entryTicks = now;
+        esp_default_wake_deep_sleep();
+        return;
+    }
+
+    s_plan.absorbed++;
+
+    // While a pulse is filtered only its end matters (a pulse is never
+    // blocked, and a maintenance wake waits for it). One deferred by a
+    // pulse that dropped is overdue: it boots from the next timer wake,
+    // so the firmware sees a timer cause rather than the PIR pin.
+    uint64_t target = 0;
+    if (s_plan.pirWait == PirWait::PULSE) {
+        target = s_plan.pulseEndTicks;
+    } else {
+        target = s_plan.pirBlocked ? s_plan.cooldownEndTicks : 0;
+        if (s_plan.bootTimerTicks != 0 && (target == 0 || s_plan.bootTimerTicks < target)) {
+            target = s_plan.bootTimerTicks;
+        }
+    }
+    if (target == 0) {
+        target = now + NO_TIMER_TICKS;
+    } else if (target < now + MIN_TIMER_TICKS) {
+        target = now + MIN_TIMER_TICKS;
+    }
+    rtc_cntl_ll_set_wakeup_timer(target);
+    esp_wake_stub_sleep(&sentinelWakeStub);
+}
+
+bool WakeStub::isEnabled() {
+    return config::wake_stub::ENABLED;
+}
+
+void WakeStub::install(int64_t cooldownUs, int64_t bootTimerUs) {
+    const uint32_t cal = esp_clk_slowclk_cal_get();
+    const uint64_t now = rtc_time_get();
+
+    s_plan.pirBlocked = cooldownUs > 0;
+    s_plan.pirWait = PirWait::RISE;
+    s_plan.confirmedTrigger = false;
+    s_plan.minPulseTicks = rtc_time_us_to_slowclk(
+        config::wake_stub::PIR_MIN_PULSE_MS * 1000ULL, cal);
+    s_plan.pairWindowTicks = rtc_time_us_to_slowclk(
+        config::wake_stub::PIR_PULSE_PAIR_WINDOW_MS * 1000ULL, cal);
+    s_plan.cooldownEndTicks = now + rtc_time_us_to_slowclk(cooldownUs > 0 ? cooldownUs : 0, cal);
+    s_plan.bootTimerTicks = (bootTimerUs >= 0)
+        ? now + rtc_time_us_to_slowclk(bootTimerUs, cal) : 0;
+    s_plan.entryTicks = 0;
+
+    esp_set_deep_sleep_wake_stub(&sentinelWakeStub);
+}
+
+uint32_t WakeStub::takeBootTimeUs() {
+    if (s_plan.entryTicks == 0) {
+        return 0;
+    }
+    uint64_t elapsed = rtc_time_get() - s_plan.entryTicks;
+    s_plan.entryTicks = 0;
+    return static_cast<uint32_t>(rtc_time_slowclk_to_us(elapsed, esp_clk_slowclk_cal_get()));
+}
+
+uint32_t WakeStub::takeAbsorbedWakes() {
+    uint32_t absorbed = s_plan.absorbed;
+    s_plan.absorbed = 0;
+    return absorbed;
+}
+
+bool WakeStub::takeConfirmedTrigger() {
+    bool confirmed = s_plan.confirmedTrigger;
+    s_plan.confirmedTrigger = false;
+    return confirmed;
+}
+
+#else // !WAKE_STUB_SUPPORTED
+
+bool WakeStub::isEnabled() {
+    return false;
+}
+
+void WakeStub::install(int64_t, int64_t) {
+}
+
+uint32_t WakeStub::takeBootTimeUs() {
+    return 0;
+}
+
+uint32_t WakeStub::takeAbsorbedWakes() {
+    return 0;
+}
+
+bool WakeStub::takeConfirmedTrigger() {
+    return false;
+}
+
+#endif // WAKE_STUB_SUPPORTED
+
+} // namespace power
@@ -0,0 +1,85 @@
+#pragma once
+
+/**
+ * @file wake_stub.hpp
+ * @brief Deep-sleep wake stub for wakes that need no firmware
+ *
+ * Runs from RTC memory before the bootloader on every deep-sleep wake:
+ * - Cooldown end: clears the PIR block and sleeps again (no boot)
+ * - PIR wake during cooldown: ignored; the stub sleeps until the PIR
+ *   output drops, then re-arms the high-level wake
+ * - Armed PIR trigger: boots only if the output stays high for
+ *   PIR_MIN_PULSE_MS, or a second pulse starts within
+ *   PIR_PULSE_PAIR_WINDOW_MS of a short one
+ * - Maintenance timer: boots normally; one due while a pulse is being
+ *   filtered waits for the pulse to confirm (PIR boot, the maintenance
+ *   tasks run on the next wake) or to drop (timer boot right after)
+ *
+ * It also timestamps the booting wake on the RTC clock so the time to
+ * app_main() is measured including ROM and bootloader.
+ *
+ * @note ESP32-S3 only (RTC_CNTL registers); on other targets install()
+ *       does nothing and the cooldown keeps the PIR wake disabled.
+ */
+
+#include <cstdint>
+
+namespace power {
+
+/**
+ * @brief Wake stub plan shared with SleepManager (static, RTC resident)
+ *
+ * @code
+ *   if (WakeStub::isEnabled()) {
+ *       WakeStub::install(cooldownUs, maintenanceUs);
+ *   }
+ *   esp_deep_sleep_start();
+ * @endcode
+ */
+class WakeStub {
+public:
+    /**
+     * @brief Check whether the stub is configured and supported on this target
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Install the stub with the plan for the coming deep sleep
+     *
+     * @param cooldownUs  Time until PIR wakes are accepted (0 = accepted now)
+     * @param bootTimerUs Time until a timer wake that needs the firmware
+     *                    (-1 = none)
+     */
+    static void install(int64_t cooldownUs, int64_t bootTimerUs);
+
+    /**
+     * @brief Wake-to-now time measured from the stub's RTC timestamp
+     *
+     * @return Microseconds, or 0 if this boot did not pass through the stub
+     *         (the timestamp is consumed)
+     */
+    static uint32_t takeBootTimeUs();
+
+    /**
+     * @brief Wakes the stub sent back to sleep since the last boot (reset on read)
+     */
+    static uint32_t takeAbsorbedWakes();
+
+    /**
+     * @brief Check whether this boot is a PIR trigger confirmed by the pulse filter
+     *
+     * Such boots report a timer wake-up cause (the end of the pulse
+     * window); SleepManager treats them as PIR triggers. Reset on read.
+     */
+    static bool takeConfirmedTrigger();
+
+    /**
+     * @brief Timer wake to enable when nothing is due (~90 days)
+     *
+     * The stub can only retarget a timer wake source that was enabled
+     * before sleep; the PIR pulse filter relies on that.
+     */
+    static constexpr uint64_t NO_TIMER_US = 90ULL * 24 * 3600 * 1000000;
+};
+
+} // namespace power
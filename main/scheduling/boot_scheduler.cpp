@@ -0,0 +1,122 @@
+/**
+ * @file boot_scheduler.cpp
+ * @brief Boot scheduler implementation
+ */
+
+#include "boot_scheduler.hpp"
+#include "app_config.hpp"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "BootScheduler";
+
+namespace scheduling {
+
+BootScheduler::BootScheduler()
+    : m_jobs{}
+    , m_jobCount(0)
+    , m_doneBits(xEventGroupCreate())
+{
+}
+
+BootScheduler::~BootScheduler() {
+    // Jobs reference this object; never tear down underneath them
+    if (joinAll(config::scheduling::JOIN_TIMEOUT_MS) == ESP_ERR_TIMEOUT) {
+        ESP_LOGE(TAG, "Jobs still running at destruction");
+        return;
+    }
+
+    if (m_doneBits) {
+        vEventGroupDelete(m_doneBits);
+    }
+}
+
+void BootScheduler::jobTask(void* arg) {
+    Job* job = static_cast<Job*>(arg);
+    BootScheduler* self = job->owner;
+
+    job->startUs = esp_timer_get_time();
+    job->result = job->function(job->context);
+    job->endUs = esp_timer_get_time();
+
+    xEventGroupSetBits(self->m_doneBits, BIT0 << (job - self->m_jobs));
+    vTaskDelete(nullptr);
+}
+
+JobId BootScheduler::submit(const char* name, JobFunction function, void* context,
+                            int core) {
+    if (!m_doneBits || !function) {
+        return INVALID_JOB;
+    }
+    if (m_jobCount >= MAX_JOBS) {
+        ESP_LOGE(TAG, "Job table full, cannot start %s", name);
+        return INVALID_JOB;
+    }
+
+    JobId id = static_cast<JobId>(m_jobCount);
+    Job& job = m_jobs[id];
+    job = {this, name, function, context, ESP_ERR_INVALID_STATE, 0, 0};
+
+    BaseType_t ret = xTaskCreatePinnedToCore(
+        &BootScheduler::jobTask, name,
+        config::scheduling::WORKER_STACK_SIZE, &job,
+        config::scheduling::WORKER_PRIORITY, nullptr, core);
+
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start job %s", name);
+        return INVALID_JOB;
+    }
+
+    m_jobCount++;
+    ESP_LOGD(TAG, "Job %s started on core %d", name, core);
+    return id;
+}
+
+esp_err_t BootScheduler::join(JobId job, int timeoutMs) {
+    if (job < 0 || static_cast<size_t>(job) >= m_jobCount) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    EventBits_t bit = BIT0 << job;
+    EventBits_t bits = xEventGroupWaitBits(m_doneBits, bit, pdFALSE, pdTRUE,
+                                           pdMS_TO_TICKS(timeoutMs));
+    if (!(bits & bit)) {
+        ESP_LOGE(TAG, "Job %s timed out", m_jobs[job].name);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    const Job& j = m_jobs[job];
+    ESP_LOGI(TAG, "Job %s: %s in %lld ms", j.name, esp_err_to_name(j.result),
+             (j.endUs - j.startUs) / 1000);
+    return j.result;
+}
+
+esp_err_t BootScheduler::joinAll(int timeoutMs) {
+    if (m_jobCount == 0) {
+        return ESP_OK;
+    }
+
+    EventBits_t all = (BIT0 << m_jobCount) - 1;
+    EventBits_t bits = xEventGroupWaitBits(m_doneBits, all, pdFALSE, pdTRUE,
+                                           pdMS_TO_TICKS(timeoutMs));
+    if ((bits & all) != all) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    for (size_t i = 0; i < m_jobCount; i++) {
+        if (m_jobs[i].result != ESP_OK) {
+            return m_jobs[i].result;
+        }
+    }
+    return ESP_OK;
+}
+
+bool BootScheduler::isDone(JobId job) const {
+    if (job < 0 || static_cast<size_t>(job) >= m_jobCount) {
+        return false;
+    }
+    return (xEventGroupGetBits(m_doneBits) & (BIT0 << job)) != 0;
+}
+
+} // namespace scheduling
@@ -0,0 +1,115 @@
+#pragma once
+
+/**
+ * @file boot_scheduler.hpp
+ * @brief Pipelined start-up jobs on the second core
+ *
+ * Provides:
+ * - Fire-and-join background jobs pinned to a chosen core
+ * - Per-job result codes
+ * - Bounded joins so a stuck job cannot block deep sleep
+ *
+ * Typical use on a PIR wake: construct the model and bring up
+ * NVS/WiFi driver on core 1 while core 0 runs the camera warmup.
+ */
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+#include <cstddef>
+
+namespace scheduling {
+
+/**
+ * @brief Background job entry point
+ */
+using JobFunction = esp_err_t (*)(void* context);
+
+/**
+ * @brief Handle returned by BootScheduler::submit()
+ */
+using JobId = int;
+
+constexpr JobId INVALID_JOB = -1;
+
+/**
+ * @brief Boot-time job scheduler
+ *
+ * @code
+ *   scheduling::BootScheduler scheduler;
+ *   JobId model = scheduler.submit("model", loadModelJob, &detector);
+ *   camera.warmup();
+ *   if (scheduler.join(model, timeout) == ESP_OK) { ... }
+ * @endcode
+ */
+class BootScheduler {
+public:
+    BootScheduler();
+    ~BootScheduler();
+
+    // Disable copy operations
+    BootScheduler(const BootScheduler&) = delete;
+    BootScheduler& operator=(const BootScheduler&) = delete;
+
+    /**
+     * @brief Start a job on its own task
+     *
+     * @param name     Task name (for debugging)
+     * @param function Job entry point
+     * @param context  Argument passed to the job
+     * @param core     Core to pin the task to
+     *
+     * @return JobId Job handle, or INVALID_JOB if it could not be started
+     */
+    JobId submit(const char* name, JobFunction function, void* context,
+                 int core);
+
+    /**
+     * @brief Wait for a job to finish
+     *
+     * @param job       Job handle
+     * @param timeoutMs Maximum wait in milliseconds
+     *
+     * @return esp_err_t Job result, ESP_ERR_TIMEOUT, or ESP_ERR_INVALID_ARG
+     */
+    esp_err_t join(JobId job, int timeoutMs);
+
+    /**
+     * @brief Wait for all submitted jobs
+     *
+     * @param timeoutMs Maximum total wait in milliseconds
+     *
+     * @return esp_err_t ESP_OK if every job succeeded, else first failure
+     */
+    esp_err_t joinAll(int timeoutMs);
+
+    /**
+     * @brief Check whether a job has finished (non-blocking)
+     */
+    bool isDone(JobId job) const;
+
+    static constexpr size_t MAX_JOBS = 4;
+
+private:
+    struct Job {
+        BootScheduler* owner;
+        const char* name;
+        JobFunction function;
+        void* context;
+        esp_err_t result;
+        int64_t startUs;
+        int64_t endUs;
+    };
+
+    Job m_jobs[MAX_JOBS];
+    size_t m_jobCount;
+    EventGroupHandle_t m_doneBits;
+
+    /**
+     * @brief FreeRTOS task trampoline
+     */
+    static void jobTask(void* arg);
+};
+
+} // namespace scheduling